@@ -0,0 +1,346 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "components/color.h"
+#include "components/particle.h"
+#include "components/trace_recorder.h"
+#include "display/gas_container.h"
+
+// Steps a GasContainer with no window so long runs aren't capped at vsync,
+// then reports how fast the simulation went.
+
+namespace {
+
+/**
+ * A kind of particle that can be mixed into the batch container. These match
+ * the species the rendered app spawns.
+ */
+struct Species {
+  const char* name;
+  idealgas::Color color;
+  float radius;
+  float mass;
+};
+
+const Species kSpecies[] = {
+    {"blue", idealgas::Color(0, 0, 1), 3, 5},
+    {"orange", idealgas::Color(1, 0.647f, 0), 6, 8},
+    {"white", idealgas::Color(1, 1, 1), 9, 11},
+};
+const size_t kNumSpecies = sizeof(kSpecies) / sizeof(kSpecies[0]);
+
+/**
+ * Everything the batch run can be configured with from the command line
+ */
+struct BatchOptions {
+  size_t num_particles = 1000;
+  size_t num_steps = 1000;
+  float box_width = 500;
+  float box_height = 500;
+  unsigned int seed = 1;
+  size_t num_threads = 1;
+  idealgas::SteppingMode stepping_mode = idealgas::SteppingMode::kFixedStep;
+  idealgas::BroadPhase broad_phase = idealgas::BroadPhase::kAutomatic;
+  float neighbour_skin = idealgas::VerletNeighbourList::kDefaultSkin;
+  size_t reorder_interval = 0;
+  std::vector<float> species_weights = std::vector<float>(kNumSpecies, 1);
+  std::string trace_file_name;
+  size_t num_trace_frames = 100;
+};
+
+void PrintUsage(const char* program) {
+  std::cerr << "Usage: " << program << " [options]\n"
+            << "  --particles N        particles to place (default 1000)\n"
+            << "  --steps N            frames to advance (default 1000)\n"
+            << "  --width W            container width (default 500)\n"
+            << "  --height H           container height (default 500)\n"
+            << "  --seed S             random seed (default 1)\n"
+            << "  --threads T          simulation threads (default 1)\n"
+            << "  --mode fixed|event   fixed frame steps or event-driven"
+            << " collisions\n"
+            << "                       (default fixed)\n"
+            << "  --broad-phase grid|verlet|sweep|tree|auto\n"
+            << "                       rebuild a grid every frame, keep"
+            << " Verlet neighbour\n"
+            << "                       lists, sweep and prune along x, refit"
+            << " a bounding box\n"
+            << "                       tree, or pick the grid or tree from"
+            << " the radii\n"
+            << "                       (default auto)\n"
+            << "  --skin D             Verlet list skin distance (default 2)\n"
+            << "  --reorder N          sort the particles along a Z-order"
+            << " curve at least\n"
+            << "                       every N frames, 0 for never"
+            << " (default 0)\n"
+            << "  --mix blue:W,...     relative weight of each species out of"
+            << " blue, orange\n"
+            << "                       and white (default 1 each)\n"
+            << "  --trace FILE         write a Chrome trace of the first"
+            << " frames to FILE\n"
+            << "  --trace-frames N     frames to trace (default 100)\n";
+}
+
+bool ParseSize(const char* text, size_t* value) {
+  char* end;
+  unsigned long parsed = std::strtoul(text, &end, 10);
+  if (*text == '\0' || *end != '\0') {
+    return false;
+  }
+
+  *value = size_t(parsed);
+  return true;
+}
+
+bool ParsePositiveFloat(const char* text, float* value) {
+  char* end;
+  float parsed = std::strtof(text, &end);
+  if (*text == '\0' || *end != '\0' || parsed <= 0) {
+    return false;
+  }
+
+  *value = parsed;
+  return true;
+}
+
+bool ParseSteppingMode(const char* text, idealgas::SteppingMode* mode) {
+  if (std::strcmp(text, "fixed") == 0) {
+    *mode = idealgas::SteppingMode::kFixedStep;
+  } else if (std::strcmp(text, "event") == 0) {
+    *mode = idealgas::SteppingMode::kEventDriven;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+bool ParseBroadPhase(const char* text, idealgas::BroadPhase* broad_phase) {
+  if (std::strcmp(text, "grid") == 0) {
+    *broad_phase = idealgas::BroadPhase::kUniformGrid;
+  } else if (std::strcmp(text, "verlet") == 0) {
+    *broad_phase = idealgas::BroadPhase::kVerletList;
+  } else if (std::strcmp(text, "sweep") == 0) {
+    *broad_phase = idealgas::BroadPhase::kSweepAndPrune;
+  } else if (std::strcmp(text, "tree") == 0) {
+    *broad_phase = idealgas::BroadPhase::kAabbTree;
+  } else if (std::strcmp(text, "auto") == 0) {
+    *broad_phase = idealgas::BroadPhase::kAutomatic;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Parses a species mix such as "blue:2,white:1". Species left out of the mix
+ * get a weight of zero.
+ */
+bool ParseMix(const std::string& text, std::vector<float>* weights) {
+  weights->assign(kNumSpecies, 0);
+
+  size_t entry_start = 0;
+  while (entry_start <= text.size()) {
+    size_t entry_end = text.find(',', entry_start);
+    if (entry_end == std::string::npos) {
+      entry_end = text.size();
+    }
+
+    std::string entry = text.substr(entry_start, entry_end - entry_start);
+    size_t separator = entry.find(':');
+    if (separator == std::string::npos) {
+      return false;
+    }
+
+    std::string name = entry.substr(0, separator);
+    char* end;
+    const char* weight_text = entry.c_str() + separator + 1;
+    float weight = std::strtof(weight_text, &end);
+    if (*weight_text == '\0' || *end != '\0' || weight < 0) {
+      return false;
+    }
+
+    bool found = false;
+    for (size_t species = 0; species < kNumSpecies; ++species) {
+      if (name == kSpecies[species].name) {
+        (*weights)[species] = weight;
+        found = true;
+      }
+    }
+    if (!found) {
+      return false;
+    }
+
+    entry_start = entry_end + 1;
+  }
+
+  for (float weight : *weights) {
+    if (weight > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ParseOptions(int argc, char** argv, BatchOptions* options) {
+  for (int arg = 1; arg < argc; ++arg) {
+    if (arg + 1 >= argc) {
+      return false;
+    }
+
+    const char* flag = argv[arg];
+    const char* value = argv[++arg];
+    bool parsed;
+    if (std::strcmp(flag, "--particles") == 0) {
+      parsed = ParseSize(value, &options->num_particles);
+    } else if (std::strcmp(flag, "--steps") == 0) {
+      parsed = ParseSize(value, &options->num_steps);
+    } else if (std::strcmp(flag, "--width") == 0) {
+      parsed = ParsePositiveFloat(value, &options->box_width);
+    } else if (std::strcmp(flag, "--height") == 0) {
+      parsed = ParsePositiveFloat(value, &options->box_height);
+    } else if (std::strcmp(flag, "--seed") == 0) {
+      size_t seed;
+      parsed = ParseSize(value, &seed);
+      options->seed = (unsigned int)seed;
+    } else if (std::strcmp(flag, "--threads") == 0) {
+      parsed = ParseSize(value, &options->num_threads) &&
+               options->num_threads > 0;
+    } else if (std::strcmp(flag, "--mode") == 0) {
+      parsed = ParseSteppingMode(value, &options->stepping_mode);
+    } else if (std::strcmp(flag, "--broad-phase") == 0) {
+      parsed = ParseBroadPhase(value, &options->broad_phase);
+    } else if (std::strcmp(flag, "--skin") == 0) {
+      parsed = ParsePositiveFloat(value, &options->neighbour_skin);
+    } else if (std::strcmp(flag, "--reorder") == 0) {
+      parsed = ParseSize(value, &options->reorder_interval);
+    } else if (std::strcmp(flag, "--mix") == 0) {
+      parsed = ParseMix(value, &options->species_weights);
+    } else if (std::strcmp(flag, "--trace") == 0) {
+      options->trace_file_name = value;
+      parsed = !options->trace_file_name.empty();
+    } else if (std::strcmp(flag, "--trace-frames") == 0) {
+      parsed = ParseSize(value, &options->num_trace_frames);
+    } else {
+      parsed = false;
+    }
+
+    if (!parsed) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Generates the particles for a batch run, picking each one's species by the
+ * weights in the mix and placing it somewhere inside the box
+ */
+std::vector<idealgas::Particle> GenerateParticles(
+    const BatchOptions& options, const glm::vec2& top_left_corner,
+    const glm::vec2& bottom_right_corner) {
+  std::mt19937 generator(options.seed);
+  std::discrete_distribution<size_t> pick_species(
+      options.species_weights.begin(), options.species_weights.end());
+  std::uniform_real_distribution<float> pick_x(top_left_corner.x,
+                                               bottom_right_corner.x);
+  std::uniform_real_distribution<float> pick_y(top_left_corner.y,
+                                               bottom_right_corner.y);
+
+  std::vector<idealgas::Particle> particles;
+  particles.reserve(options.num_particles);
+  for (size_t particle = 0; particle < options.num_particles; ++particle) {
+    const Species& species = kSpecies[pick_species(generator)];
+
+    // Same speed range the container gives its own random particles
+    float velocity_range = 0.7f * species.radius;
+    std::uniform_real_distribution<float> pick_velocity(-velocity_range,
+                                                        velocity_range);
+    glm::vec2 position(pick_x(generator), pick_y(generator));
+    glm::vec2 velocity(pick_velocity(generator), pick_velocity(generator));
+
+    particles.push_back(idealgas::Particle(position, velocity, species.color,
+                                           species.radius, species.mass));
+  }
+
+  return particles;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BatchOptions options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  const glm::vec2 top_left_corner(0, 0);
+  const glm::vec2 bottom_right_corner(options.box_width, options.box_height);
+
+  std::vector<idealgas::Particle> particles =
+      GenerateParticles(options, top_left_corner, bottom_right_corner);
+  std::vector<idealgas::Particle*> initial_particles;
+  initial_particles.reserve(particles.size());
+  for (idealgas::Particle& particle : particles) {
+    initial_particles.push_back(&particle);
+  }
+
+  const Species& default_species = kSpecies[0];
+  idealgas::GasContainer container(
+      initial_particles, 0, top_left_corner, bottom_right_corner,
+      default_species.radius, default_species.mass, default_species.color);
+  container.SetNumThreads(options.num_threads);
+  container.SetSteppingMode(options.stepping_mode);
+  container.SetBroadPhase(options.broad_phase);
+  container.SetNeighbourSkin(options.neighbour_skin);
+  container.SetReorderInterval(options.reorder_interval);
+
+  idealgas::TraceRecorder& recorder = idealgas::TraceRecorder::GetInstance();
+  if (!options.trace_file_name.empty()) {
+#ifdef IDEALGAS_PROFILING
+    IDEALGAS_TRACE_THREAD_NAME("batch");
+    recorder.Start(options.num_trace_frames);
+#else
+    std::cerr << "Tracing needs a build with IDEALGAS_PROFILING on"
+              << std::endl;
+    return 1;
+#endif
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t step = 0; step < options.num_steps; ++step) {
+    container.AdvanceOneFrame();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  double seconds = elapsed.count();
+  double steps_per_second = seconds > 0 ? options.num_steps / seconds : 0;
+  std::cout << "particles:          " << options.num_particles << "\n"
+            << "threads:            " << options.num_threads << "\n"
+            << "steps:              " << options.num_steps << "\n"
+            << "wall time (s):      " << seconds << "\n"
+            << "steps/s:            " << steps_per_second << "\n"
+            << "particle-updates/s: "
+            << steps_per_second * options.num_particles << std::endl;
+
+  if (!options.trace_file_name.empty()) {
+    // Covers fewer frames than asked for if the run was shorter
+    recorder.Stop();
+    std::ofstream trace_file(options.trace_file_name);
+    recorder.WriteJson(trace_file);
+    std::cout << "trace events:       " << recorder.GetNumEvents() << " ("
+              << recorder.GetNumDroppedEvents() << " dropped) written to "
+              << options.trace_file_name << std::endl;
+  }
+
+  return 0;
+}
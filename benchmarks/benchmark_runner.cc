@@ -0,0 +1,140 @@
+#include "benchmark_runner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+
+namespace idealgas {
+
+namespace {
+
+// Written by KeepResult so the compiler has to compute the values it is given
+volatile size_t kept_result = 0;
+
+/**
+ * Times a number of calls of a benchmark body
+ * @return the seconds the calls took
+ */
+double TimeIterations(const std::function<void()>& body, size_t iterations) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  for (size_t iteration = 0; iteration < iterations; ++iteration) {
+    body();
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+}  // namespace
+
+BenchmarkRunner::BenchmarkRunner(size_t repetitions, double min_seconds,
+                                 const std::string& filter)
+    : repetitions_(std::max(repetitions, size_t(1))),
+      min_seconds_(min_seconds),
+      filter_(filter) {
+}
+
+void BenchmarkRunner::Run(const std::string& name, size_t items_per_iteration,
+                          const std::function<void()>& body) {
+  if (name.find(filter_) == std::string::npos) {
+    return;
+  }
+
+  // Doubles the iterations until one repetition takes long enough to time,
+  // which also warms up the caches and the branch predictor
+  size_t iterations = 1;
+  while (TimeIterations(body, iterations) < min_seconds_) {
+    iterations *= 2;
+  }
+
+  std::vector<double> nanoseconds(repetitions_);
+  for (double& repetition_nanoseconds : nanoseconds) {
+    repetition_nanoseconds = TimeIterations(body, iterations) * 1e9 /
+                             double(iterations);
+  }
+  std::sort(nanoseconds.begin(), nanoseconds.end());
+
+  BenchmarkResult result;
+  result.name = name;
+  result.iterations = iterations;
+  result.repetitions = repetitions_;
+  result.items_per_iteration = items_per_iteration;
+  result.min_nanoseconds = nanoseconds.front();
+  result.median_nanoseconds = nanoseconds[nanoseconds.size() / 2];
+  result.max_nanoseconds = nanoseconds.back();
+  results_.push_back(result);
+}
+
+void BenchmarkRunner::KeepResult(size_t value) {
+  kept_result = kept_result + value;
+}
+
+const std::vector<BenchmarkResult>& BenchmarkRunner::GetResults() const {
+  return results_;
+}
+
+void BenchmarkRunner::WriteTable(std::ostream& output) const {
+  size_t name_width = 9;
+  for (const BenchmarkResult& result : results_) {
+    name_width = std::max(name_width, result.name.size());
+  }
+
+  output << std::left << std::setw(int(name_width)) << "benchmark"
+         << std::right << std::setw(14) << "median (ns)" << std::setw(14)
+         << "min (ns)" << std::setw(14) << "max (ns)" << std::setw(16)
+         << "items/s" << "\n";
+  output << std::fixed << std::setprecision(1);
+  for (const BenchmarkResult& result : results_) {
+    double items_per_second = result.items_per_iteration * 1e9 /
+                              result.median_nanoseconds;
+    output << std::left << std::setw(int(name_width)) << result.name
+           << std::right << std::setw(14) << result.median_nanoseconds
+           << std::setw(14) << result.min_nanoseconds << std::setw(14)
+           << result.max_nanoseconds << std::setw(16)
+           << std::setprecision(0) << items_per_second
+           << std::setprecision(1) << "\n";
+  }
+}
+
+void BenchmarkRunner::WriteJson(std::ostream& output) const {
+  // The context says which builds are comparable with each other
+  output << "{\n  \"context\": {\n"
+         << "    \"num_cpus\": " << std::thread::hardware_concurrency()
+         << ",\n"
+#ifdef NDEBUG
+         << "    \"assertions\": false,\n"
+#else
+         << "    \"assertions\": true,\n"
+#endif
+#ifdef IDEALGAS_PROFILING
+         << "    \"profiling\": true,\n"
+#else
+         << "    \"profiling\": false,\n"
+#endif
+         << "    \"repetitions\": " << repetitions_ << "\n  },\n"
+         << "  \"benchmarks\": [";
+
+  // Names are built from identifiers and numbers, so they need no escaping
+  output << std::setprecision(3) << std::fixed;
+  for (size_t index = 0; index < results_.size(); ++index) {
+    const BenchmarkResult& result = results_[index];
+    double items_per_second = result.items_per_iteration * 1e9 /
+                              result.median_nanoseconds;
+    output << (index == 0 ? "\n" : ",\n") << "    {\"name\": \""
+           << result.name << "\", \"iterations\": " << result.iterations
+           << ", \"repetitions\": " << result.repetitions
+           << ", \"items_per_iteration\": " << result.items_per_iteration
+           << ", \"time_unit\": \"ns\", \"real_time\": "
+           << result.median_nanoseconds
+           << ", \"min_time\": " << result.min_nanoseconds
+           << ", \"max_time\": " << result.max_nanoseconds
+           << ", \"items_per_second\": " << items_per_second << "}";
+  }
+
+  output << "\n  ]\n}\n";
+}
+
+}  // namespace idealgas
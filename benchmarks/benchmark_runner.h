@@ -0,0 +1,78 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * The timings of one benchmark, per call of its body
+ */
+struct BenchmarkResult {
+  std::string name;
+  // Calls of the body timed in each repetition
+  size_t iterations;
+  size_t repetitions;
+  // Work items, such as particles or pairs, handled by each call
+  size_t items_per_iteration;
+  double min_nanoseconds;
+  double median_nanoseconds;
+  double max_nanoseconds;
+};
+
+/**
+ * Times small pieces of the simulation and reports the results as a table or
+ * as JSON for comparing two versions of the code. Each benchmark is first
+ * calibrated to run long enough to time reliably, then timed over several
+ * repetitions so the median and spread can be reported.
+ */
+class BenchmarkRunner {
+ public:
+  /**
+   * Creates a runner with no results
+   * @param repetitions how many times each benchmark is timed
+   * @param min_seconds the shortest time a single repetition may take
+   * @param filter only benchmarks whose name contains this are run
+   */
+  BenchmarkRunner(size_t repetitions, double min_seconds,
+                  const std::string& filter);
+
+  /**
+   * Times a benchmark, unless the filter skips it
+   * @param name the name to report the benchmark under
+   * @param items_per_iteration the number of work items each call handles
+   * @param body the code to time, called many times in a row
+   */
+  void Run(const std::string& name, size_t items_per_iteration,
+           const std::function<void()>& body);
+
+  /**
+   * Keeps a value computed by a benchmark body from being optimized away
+   * @param value the value to keep
+   */
+  static void KeepResult(size_t value);
+
+  const std::vector<BenchmarkResult>& GetResults() const;
+
+  /**
+   * Writes the results as an aligned table meant for people
+   * @param output the stream to write to
+   */
+  void WriteTable(std::ostream& output) const;
+
+  /**
+   * Writes the results and the build they came from as JSON
+   * @param output the stream to write to
+   */
+  void WriteJson(std::ostream& output) const;
+
+ private:
+  size_t repetitions_;
+  double min_seconds_;
+  std::string filter_;
+  std::vector<BenchmarkResult> results_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,95 @@
+#include "benchmark_scene.h"
+
+#include <cmath>
+#include <random>
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * The species of the rendered app, as radius and mass
+ */
+struct SceneSpecies {
+  Color color;
+  float radius;
+  float mass;
+};
+
+const SceneSpecies kSceneSpecies[] = {
+    {Color(0, 0, 1), 3, 5},
+    {Color(1, 0.647f, 0), 6, 8},
+    {Color(1, 1, 1), 9, 11},
+};
+const size_t kNumSceneSpecies =
+    sizeof(kSceneSpecies) / sizeof(kSceneSpecies[0]);
+
+const float kPi = 3.14159265f;
+
+}  // namespace
+
+BenchmarkScene::BenchmarkScene(size_t num_particles, float packing_fraction,
+                               unsigned int seed) {
+  float mean_area = 0;
+  for (const SceneSpecies& species : kSceneSpecies) {
+    mean_area += kPi * species.radius * species.radius / kNumSceneSpecies;
+  }
+  float box_side =
+      std::sqrt(float(num_particles) * mean_area / packing_fraction);
+  bottom_right_corner_ = glm::vec2(box_side, box_side);
+
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<size_t> pick_species(0, kNumSceneSpecies - 1);
+  std::uniform_real_distribution<float> pick_coordinate(0, box_side);
+
+  particles_.reserve(num_particles);
+  for (size_t particle = 0; particle < num_particles; ++particle) {
+    const SceneSpecies& species = kSceneSpecies[pick_species(generator)];
+
+    // Same speed range the container gives its own random particles
+    float velocity_range = 0.7f * species.radius;
+    std::uniform_real_distribution<float> pick_velocity(-velocity_range,
+                                                        velocity_range);
+    glm::vec2 position(pick_coordinate(generator), pick_coordinate(generator));
+    glm::vec2 velocity(pick_velocity(generator), pick_velocity(generator));
+
+    particles_.push_back(Particle(position, velocity, species.color,
+                                  species.radius, species.mass));
+  }
+}
+
+GasContainer BenchmarkScene::MakeContainer(size_t num_threads,
+                                           SteppingMode mode) const {
+  const SceneSpecies& default_species = kSceneSpecies[0];
+  GasContainer container(std::vector<Particle*>(), 0, glm::vec2(0, 0),
+                         bottom_right_corner_, default_species.radius,
+                         default_species.mass, default_species.color);
+  for (const Particle& particle : particles_) {
+    container.AddParticleToContainer(particle);
+  }
+
+  container.SetNumThreads(num_threads);
+  container.SetSteppingMode(mode);
+  return container;
+}
+
+ParticleStore BenchmarkScene::MakeStore() const {
+  ParticleStore store;
+  store.Reserve(particles_.size());
+  for (const Particle& particle : particles_) {
+    store.Add(particle.GetPosition(), particle.GetVelocity(),
+              particle.GetColor(), particle.GetRadius(), particle.GetMass());
+  }
+
+  return store;
+}
+
+const std::vector<Particle>& BenchmarkScene::GetParticles() const {
+  return particles_;
+}
+
+const glm::vec2& BenchmarkScene::GetBottomRightCorner() const {
+  return bottom_right_corner_;
+}
+
+}  // namespace idealgas
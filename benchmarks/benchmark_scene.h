@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "components/particle.h"
+#include "components/particle_store.h"
+#include "display/gas_container.h"
+
+namespace idealgas {
+
+/**
+ * A reproducible square box of particles for the benchmarks. The particles are
+ * an even mix of the three species the rendered app spawns, scattered
+ * uniformly at random, and the box is sized so they cover a chosen fraction
+ * of its area.
+ */
+class BenchmarkScene {
+ public:
+  /**
+   * Generates the particles and sizes the box around them
+   * @param num_particles the number of particles to generate
+   * @param packing_fraction the fraction of the box's area the particles
+   * cover, between zero and one
+   * @param seed the random seed, so the same arguments give the same scene
+   */
+  BenchmarkScene(size_t num_particles, float packing_fraction,
+                 unsigned int seed);
+
+  /**
+   * Builds a container holding every particle of the scene
+   * @param num_threads the number of threads to resolve collisions with
+   * @param mode how the container moves the particles each frame
+   * @return the new container
+   */
+  GasContainer MakeContainer(size_t num_threads, SteppingMode mode) const;
+
+  /**
+   * Builds a store holding every particle of the scene
+   * @return the new store
+   */
+  ParticleStore MakeStore() const;
+
+  const std::vector<Particle>& GetParticles() const;
+
+  const glm::vec2& GetBottomRightCorner() const;
+
+ private:
+  std::vector<Particle> particles_;
+  // The top left corner is always at the origin
+  glm::vec2 bottom_right_corner_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,309 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark_runner.h"
+#include "benchmark_scene.h"
+#include "components/species_speed_bins.h"
+#include "components/speed_bins.h"
+#include "components/work_stealing_pool.h"
+#include "physics/collision_physics.h"
+#include "physics/uniform_grid.h"
+
+// Times the collision checks, the wall checks, the grid rebuild, whole
+// container frames and the speed binning behind the histograms, printing a
+// table and optionally writing JSON that two versions of the code can be
+// compared with.
+
+namespace {
+
+// Enough particles for the pair kernels to be timed over a loop rather than a
+// single call, while still fitting in the L1 cache
+const size_t kKernelParticles = 1024;
+const unsigned int kSeed = 1;
+
+/**
+ * Everything the benchmarks can be configured with from the command line
+ */
+struct MicroBenchmarkOptions {
+  size_t repetitions = 5;
+  double min_seconds = 0.05;
+  std::string filter;
+  std::string json_file_name;
+};
+
+void PrintUsage(const char* program) {
+  std::cerr << "Usage: " << program << " [options]\n"
+            << "  --filter TEXT        only run benchmarks whose name contains"
+            << " TEXT\n"
+            << "  --repetitions N      times to time each benchmark"
+            << " (default 5)\n"
+            << "  --min-time S         shortest time of one repetition in"
+            << " seconds\n"
+            << "                       (default 0.05)\n"
+            << "  --json FILE          also write the results to FILE as"
+            << " JSON\n";
+}
+
+bool ParseOptions(int argc, char** argv, MicroBenchmarkOptions* options) {
+  for (int arg = 1; arg < argc; ++arg) {
+    if (arg + 1 >= argc) {
+      return false;
+    }
+
+    const char* flag = argv[arg];
+    const char* value = argv[++arg];
+    char* end;
+    if (std::strcmp(flag, "--filter") == 0) {
+      options->filter = value;
+    } else if (std::strcmp(flag, "--repetitions") == 0) {
+      options->repetitions = size_t(std::strtoul(value, &end, 10));
+      if (*value == '\0' || *end != '\0' || options->repetitions == 0) {
+        return false;
+      }
+    } else if (std::strcmp(flag, "--min-time") == 0) {
+      options->min_seconds = std::strtod(value, &end);
+      if (*value == '\0' || *end != '\0' || options->min_seconds < 0) {
+        return false;
+      }
+    } else if (std::strcmp(flag, "--json") == 0) {
+      options->json_file_name = value;
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Names a benchmark that runs over a scene, such as
+ * "GasContainer/AdvanceOneFrame/fixed/particles:1000/packing:0.05"
+ */
+std::string SceneBenchmarkName(const std::string& prefix,
+                               size_t num_particles, float packing_fraction) {
+  std::ostringstream name;
+  name << prefix << "/particles:" << num_particles;
+  if (packing_fraction > 0) {
+    name << "/packing:" << packing_fraction;
+  }
+
+  return name.str();
+}
+
+void RunCollisionBenchmarks(idealgas::BenchmarkRunner* runner) {
+  // Dense enough that a good share of neighbouring pairs overlap
+  idealgas::BenchmarkScene scene(kKernelParticles, 0.3f, kSeed);
+  idealgas::CollisionPhysics physics(glm::vec2(0, 0),
+                                     scene.GetBottomRightCorner());
+  std::vector<idealgas::Particle> particles = scene.GetParticles();
+  idealgas::ParticleStore store = scene.MakeStore();
+
+  runner->Run("CollisionPhysics/DidParticlesCollide/Particle",
+              kKernelParticles - 1, [&]() {
+                size_t num_collisions = 0;
+                for (size_t index = 0; index + 1 < particles.size(); ++index) {
+                  num_collisions += physics.DidParticlesCollide(
+                      particles[index], particles[index + 1]);
+                }
+                idealgas::BenchmarkRunner::KeepResult(num_collisions);
+              });
+
+  runner->Run("CollisionPhysics/DidParticlesCollide/ParticleStore",
+              kKernelParticles - 1, [&]() {
+                size_t num_collisions = 0;
+                for (size_t slot = 0; slot + 1 < store.Size(); ++slot) {
+                  num_collisions +=
+                      physics.DidParticlesCollide(store, slot, slot + 1);
+                }
+                idealgas::BenchmarkRunner::KeepResult(num_collisions);
+              });
+
+  // Colliding the same pairs over and over swaps their velocities back and
+  // forth, so the inputs stay the same from call to call
+  runner->Run("CollisionPhysics/UpdateCollidedParticleVelocities/Particle",
+              kKernelParticles / 2, [&]() {
+                for (size_t index = 0; index + 1 < particles.size();
+                     index += 2) {
+                  physics.UpdateCollidedParticleVelocities(
+                      &particles[index], &particles[index + 1]);
+                }
+              });
+
+  runner->Run(
+      "CollisionPhysics/UpdateCollidedParticleVelocities/ParticleStore",
+      kKernelParticles / 2, [&]() {
+        for (size_t slot = 0; slot + 1 < store.Size(); slot += 2) {
+          physics.UpdateCollidedParticleVelocities(&store, slot, slot + 1);
+        }
+      });
+}
+
+void RunWallBenchmarks(idealgas::BenchmarkRunner* runner) {
+  // Sparse, so most particles are close to some wall in a small box
+  idealgas::BenchmarkScene kernel_scene(kKernelParticles, 0.05f, kSeed);
+  idealgas::CollisionPhysics physics(glm::vec2(0, 0),
+                                     kernel_scene.GetBottomRightCorner());
+  const std::vector<idealgas::Particle>& particles =
+      kernel_scene.GetParticles();
+
+  runner->Run("CollisionPhysics/IsParticleCollidingWithWalls/Particle",
+              kKernelParticles, [&]() {
+                size_t num_bounces = 0;
+                for (const idealgas::Particle& particle : particles) {
+                  num_bounces +=
+                      physics.IsParticleCollidingWithTopWall(particle) +
+                      physics.IsParticleCollidingWithBottomWall(particle) +
+                      physics.IsParticleCollidingWithLeftWall(particle) +
+                      physics.IsParticleCollidingWithRightWall(particle);
+                }
+                idealgas::BenchmarkRunner::KeepResult(num_bounces);
+              });
+
+  const size_t kStoreSizes[] = {1000, 100000};
+  for (size_t num_particles : kStoreSizes) {
+    idealgas::BenchmarkScene scene(num_particles, 0.05f, kSeed);
+    idealgas::CollisionPhysics scene_physics(glm::vec2(0, 0),
+                                             scene.GetBottomRightCorner());
+    idealgas::ParticleStore store = scene.MakeStore();
+    runner->Run(SceneBenchmarkName("CollisionPhysics/ReflectWallCollisions",
+                                   num_particles, 0),
+                num_particles, [&]() {
+                  idealgas::BenchmarkRunner::KeepResult(
+                      scene_physics.ReflectWallCollisions(&store));
+                });
+  }
+}
+
+void RunGridBenchmarks(idealgas::BenchmarkRunner* runner) {
+  const size_t kParticleCounts[] = {10000, 1000000};
+  const size_t kThreadCounts[] = {1, 4};
+  for (size_t num_particles : kParticleCounts) {
+    idealgas::BenchmarkScene scene(num_particles, 0.3f, kSeed);
+    idealgas::ParticleStore store = scene.MakeStore();
+    for (size_t num_threads : kThreadCounts) {
+      idealgas::WorkStealingPool pool(num_threads);
+      idealgas::UniformGrid grid;
+      grid.SetTaskPool(&pool);
+      std::ostringstream prefix;
+      prefix << "UniformGrid/Rebuild/threads:" << num_threads;
+      runner->Run(
+          SceneBenchmarkName(prefix.str(), num_particles, 0.3f), num_particles,
+          [&]() {
+            grid.Rebuild(store, glm::vec2(0, 0), scene.GetBottomRightCorner());
+          });
+    }
+  }
+}
+
+void RunContainerBenchmarks(idealgas::BenchmarkRunner* runner) {
+  const size_t kParticleCounts[] = {100, 1000, 10000};
+  const float kPackingFractions[] = {0.05f, 0.3f};
+  for (size_t num_particles : kParticleCounts) {
+    for (float packing_fraction : kPackingFractions) {
+      idealgas::BenchmarkScene scene(num_particles, packing_fraction, kSeed);
+      idealgas::GasContainer container =
+          scene.MakeContainer(1, idealgas::SteppingMode::kFixedStep);
+      runner->Run(SceneBenchmarkName("GasContainer/AdvanceOneFrame/fixed",
+                                     num_particles, packing_fraction),
+                  num_particles, [&]() { container.AdvanceOneFrame(); });
+
+      idealgas::GasContainer verlet_container = container;
+      verlet_container.SetBroadPhase(idealgas::BroadPhase::kVerletList);
+      runner->Run(SceneBenchmarkName("GasContainer/AdvanceOneFrame/verlet",
+                                     num_particles, packing_fraction),
+                  num_particles,
+                  [&]() { verlet_container.AdvanceOneFrame(); });
+
+      idealgas::GasContainer sweep_container = container;
+      sweep_container.SetBroadPhase(idealgas::BroadPhase::kSweepAndPrune);
+      runner->Run(SceneBenchmarkName("GasContainer/AdvanceOneFrame/sweep",
+                                     num_particles, packing_fraction),
+                  num_particles,
+                  [&]() { sweep_container.AdvanceOneFrame(); });
+
+      idealgas::GasContainer tree_container = container;
+      tree_container.SetBroadPhase(idealgas::BroadPhase::kAabbTree);
+      runner->Run(SceneBenchmarkName("GasContainer/AdvanceOneFrame/tree",
+                                     num_particles, packing_fraction),
+                  num_particles,
+                  [&]() { tree_container.AdvanceOneFrame(); });
+    }
+  }
+
+  // Event-driven stepping predicts every collision, so it is only timed at
+  // the smaller sizes
+  const size_t kEventParticleCounts[] = {100, 1000};
+  for (size_t num_particles : kEventParticleCounts) {
+    idealgas::BenchmarkScene scene(num_particles, 0.05f, kSeed);
+    idealgas::GasContainer container =
+        scene.MakeContainer(1, idealgas::SteppingMode::kEventDriven);
+    runner->Run(SceneBenchmarkName("GasContainer/AdvanceOneFrame/event",
+                                   num_particles, 0.05f),
+                num_particles, [&]() { container.AdvanceOneFrame(); });
+  }
+}
+
+void RunBinningBenchmarks(idealgas::BenchmarkRunner* runner) {
+  const size_t kParticleCounts[] = {1000, 100000};
+  for (size_t num_particles : kParticleCounts) {
+    idealgas::BenchmarkScene scene(num_particles, 0.05f, kSeed);
+    idealgas::ParticleStore store = scene.MakeStore();
+    idealgas::Color blue(0, 0, 1);
+
+    // What Histogram::UpdateParticleBins does for one histogram
+    idealgas::SpeedBins speed_bins(1);
+    runner->Run(SceneBenchmarkName("SpeedBins/Update", num_particles, 0),
+                num_particles, [&]() {
+                  idealgas::BenchmarkRunner::KeepResult(
+                      speed_bins.Update(store, blue).size());
+                });
+
+    // What the app does for all three histograms in one pass
+    idealgas::SpeciesSpeedBins species_bins;
+    species_bins.Register(blue, 1);
+    species_bins.Register(idealgas::Color(1, 0.647f, 0), 1);
+    species_bins.Register(idealgas::Color(1, 1, 1), 1);
+    runner->Run(
+        SceneBenchmarkName("SpeciesSpeedBins/Update", num_particles, 0),
+        num_particles, [&]() {
+          species_bins.Update(store);
+          idealgas::BenchmarkRunner::KeepResult(
+              species_bins.GetSpeedBins(0).GetBins().size());
+        });
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  MicroBenchmarkOptions options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  idealgas::BenchmarkRunner runner(options.repetitions, options.min_seconds,
+                                   options.filter);
+  RunCollisionBenchmarks(&runner);
+  RunWallBenchmarks(&runner);
+  RunGridBenchmarks(&runner);
+  RunContainerBenchmarks(&runner);
+  RunBinningBenchmarks(&runner);
+
+  runner.WriteTable(std::cout);
+  if (!options.json_file_name.empty()) {
+    std::ofstream json_file(options.json_file_name);
+    if (!json_file) {
+      std::cerr << "Could not write " << options.json_file_name << std::endl;
+      return 1;
+    }
+    runner.WriteJson(json_file);
+  }
+
+  return 0;
+}
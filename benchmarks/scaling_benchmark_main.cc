@@ -0,0 +1,436 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark_scene.h"
+#include "components/work_stealing_pool.h"
+#include "physics/uniform_grid.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// Steps GasContainers from a hundred up to a million particles at fixed
+// packing fractions and thread counts, reporting the time per step, the
+// memory each container takes and how well the extra threads pay off. The
+// uniform grid's rebuild is also timed on its own at each thread count, since
+// it is the stage every step has to finish before collisions can start, both
+// for the scene as is and with half its particles crowded into one corner.
+
+namespace {
+
+/**
+ * Everything the sweep can be configured with from the command line
+ */
+struct ScalingOptions {
+  size_t min_particles = 100;
+  size_t max_particles = 1000000;
+  std::vector<float> packing_fractions = {0.05f, 0.3f};
+  std::vector<size_t> thread_counts;
+  idealgas::SteppingMode stepping_mode = idealgas::SteppingMode::kFixedStep;
+  double min_seconds = 0.5;
+  size_t min_steps = 3;
+  unsigned int seed = 1;
+  std::string csv_file_name;
+};
+
+/**
+ * The measurements of one container size, density and thread count
+ */
+struct ScalingResult {
+  size_t num_particles;
+  float packing_fraction;
+  size_t num_threads;
+  size_t num_steps;
+  double seconds_per_step;
+  // Growth of the resident set while building the container, zero where it
+  // can't be read
+  size_t memory_bytes;
+  // The single thread time over num_threads times this time
+  double parallel_efficiency;
+  double seconds_per_grid_rebuild;
+  // parallel_efficiency for the grid rebuild alone
+  double grid_parallel_efficiency;
+  // The same for the scene with half of its particles in one corner
+  double seconds_per_crowded_grid_rebuild;
+  double crowded_grid_parallel_efficiency;
+};
+
+void PrintUsage(const char* program) {
+  std::cerr << "Usage: " << program << " [options]\n"
+            << "  --min-particles N    smallest container, stepped up by"
+            << " tens (default 100)\n"
+            << "  --max-particles N    largest container (default 1000000)\n"
+            << "  --packing F,...      packing fractions to sweep"
+            << " (default 0.05,0.3)\n"
+            << "  --threads T,...      thread counts to sweep (default 1,"
+            << " 2, 4, ... up to\n"
+            << "                       the number of cores)\n"
+            << "  --mode fixed|event   fixed frame steps or event-driven"
+            << " collisions\n"
+            << "                       (default fixed, event runs on one"
+            << " thread)\n"
+            << "  --min-time S         shortest time to step each container"
+            << " (default 0.5)\n"
+            << "  --seed S             random seed (default 1)\n"
+            << "  --csv FILE           also write the results to FILE as"
+            << " CSV\n";
+}
+
+bool ParseSize(const char* text, size_t* value) {
+  char* end;
+  unsigned long parsed = std::strtoul(text, &end, 10);
+  if (*text == '\0' || *end != '\0') {
+    return false;
+  }
+
+  *value = size_t(parsed);
+  return true;
+}
+
+/**
+ * Parses a comma separated list such as "0.05,0.3" with a parser for each
+ * entry
+ */
+template <typename Value, typename Parser>
+bool ParseList(const std::string& text, Parser parse_entry,
+               std::vector<Value>* values) {
+  values->clear();
+  size_t entry_start = 0;
+  while (entry_start <= text.size()) {
+    size_t entry_end = text.find(',', entry_start);
+    if (entry_end == std::string::npos) {
+      entry_end = text.size();
+    }
+
+    Value value;
+    std::string entry = text.substr(entry_start, entry_end - entry_start);
+    if (!parse_entry(entry.c_str(), &value)) {
+      return false;
+    }
+    values->push_back(value);
+    entry_start = entry_end + 1;
+  }
+
+  return !values->empty();
+}
+
+bool ParsePackingFraction(const char* text, float* value) {
+  char* end;
+  float parsed = std::strtof(text, &end);
+  if (*text == '\0' || *end != '\0' || parsed <= 0 || parsed >= 1) {
+    return false;
+  }
+
+  *value = parsed;
+  return true;
+}
+
+bool ParseThreadCount(const char* text, size_t* value) {
+  return ParseSize(text, value) && *value > 0;
+}
+
+bool ParseOptions(int argc, char** argv, ScalingOptions* options) {
+  for (int arg = 1; arg < argc; ++arg) {
+    if (arg + 1 >= argc) {
+      return false;
+    }
+
+    const char* flag = argv[arg];
+    const char* value = argv[++arg];
+    bool parsed;
+    if (std::strcmp(flag, "--min-particles") == 0) {
+      parsed = ParseSize(value, &options->min_particles) &&
+               options->min_particles > 0;
+    } else if (std::strcmp(flag, "--max-particles") == 0) {
+      parsed = ParseSize(value, &options->max_particles);
+    } else if (std::strcmp(flag, "--packing") == 0) {
+      parsed = ParseList(value, ParsePackingFraction,
+                         &options->packing_fractions);
+    } else if (std::strcmp(flag, "--threads") == 0) {
+      parsed = ParseList(value, ParseThreadCount, &options->thread_counts);
+    } else if (std::strcmp(flag, "--mode") == 0) {
+      if (std::strcmp(value, "fixed") == 0) {
+        options->stepping_mode = idealgas::SteppingMode::kFixedStep;
+        parsed = true;
+      } else if (std::strcmp(value, "event") == 0) {
+        options->stepping_mode = idealgas::SteppingMode::kEventDriven;
+        parsed = true;
+      } else {
+        parsed = false;
+      }
+    } else if (std::strcmp(flag, "--min-time") == 0) {
+      char* end;
+      options->min_seconds = std::strtod(value, &end);
+      parsed = *value != '\0' && *end == '\0' && options->min_seconds >= 0;
+    } else if (std::strcmp(flag, "--seed") == 0) {
+      size_t seed = 0;
+      parsed = ParseSize(value, &seed);
+      options->seed = (unsigned int)seed;
+    } else if (std::strcmp(flag, "--csv") == 0) {
+      options->csv_file_name = value;
+      parsed = true;
+    } else {
+      parsed = false;
+    }
+
+    if (!parsed) {
+      return false;
+    }
+  }
+
+  return options->min_particles <= options->max_particles;
+}
+
+/**
+ * Powers of two up to the number of cores, plus the core count itself
+ */
+std::vector<size_t> DefaultThreadCounts() {
+  size_t num_cores = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<size_t> thread_counts;
+  for (size_t num_threads = 1; num_threads < num_cores; num_threads *= 2) {
+    thread_counts.push_back(num_threads);
+  }
+  thread_counts.push_back(num_cores);
+  return thread_counts;
+}
+
+/**
+ * Reads how much memory the process has resident
+ * @return the resident bytes, or zero where they can't be read
+ */
+size_t ReadResidentBytes() {
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  if (statm >> total_pages >> resident_pages) {
+    return resident_pages * size_t(sysconf(_SC_PAGESIZE));
+  }
+#endif
+  return 0;
+}
+
+/**
+ * Steps a container until both the minimum time and number of steps have
+ * passed, after one untimed step that lets it allocate its scratch space
+ */
+ScalingResult MeasureContainer(const idealgas::BenchmarkScene& scene,
+                               float packing_fraction, size_t num_threads,
+                               const ScalingOptions& options) {
+  size_t resident_bytes_before = ReadResidentBytes();
+  idealgas::GasContainer container =
+      scene.MakeContainer(num_threads, options.stepping_mode);
+  container.AdvanceOneFrame();
+  size_t resident_bytes_after = ReadResidentBytes();
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  std::chrono::duration<double> elapsed(0);
+  size_t num_steps = 0;
+  while (num_steps < options.min_steps ||
+         elapsed.count() < options.min_seconds) {
+    container.AdvanceOneFrame();
+    ++num_steps;
+    elapsed = Clock::now() - start;
+  }
+
+  ScalingResult result;
+  result.num_particles = scene.GetParticles().size();
+  result.packing_fraction = packing_fraction;
+  result.num_threads = num_threads;
+  result.num_steps = num_steps;
+  result.seconds_per_step = elapsed.count() / num_steps;
+  result.memory_bytes = resident_bytes_after > resident_bytes_before
+                            ? resident_bytes_after - resident_bytes_before
+                            : 0;
+  result.parallel_efficiency = 0;
+  result.seconds_per_grid_rebuild = 0;
+  result.grid_parallel_efficiency = 0;
+  result.seconds_per_crowded_grid_rebuild = 0;
+  result.crowded_grid_parallel_efficiency = 0;
+  return result;
+}
+
+/**
+ * Makes a store of the scene's particles with every other one moved into the
+ * sixteenth of the box at its top left corner, so the density is far from
+ * even
+ */
+idealgas::ParticleStore MakeCrowdedStore(
+    const idealgas::BenchmarkScene& scene) {
+  idealgas::ParticleStore store = scene.MakeStore();
+  for (size_t slot = 0; slot < store.Size(); slot += 2) {
+    store.SetPosition(slot, store.GetPosition(slot) / 4.0f);
+  }
+
+  return store;
+}
+
+/**
+ * Rebuilds a uniform grid over a store until both the minimum time and number
+ * of rebuilds have passed, after one untimed rebuild that lets it allocate its
+ * scratch space
+ * @return the seconds per rebuild
+ */
+double MeasureGridRebuild(const idealgas::BenchmarkScene& scene,
+                          const idealgas::ParticleStore& store,
+                          size_t num_threads, const ScalingOptions& options) {
+  idealgas::WorkStealingPool pool(num_threads);
+  idealgas::UniformGrid grid;
+  grid.SetTaskPool(&pool);
+  glm::vec2 top_left_corner(0, 0);
+  grid.Rebuild(store, top_left_corner, scene.GetBottomRightCorner());
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point start = Clock::now();
+  std::chrono::duration<double> elapsed(0);
+  size_t num_rebuilds = 0;
+  while (num_rebuilds < options.min_steps ||
+         elapsed.count() < options.min_seconds) {
+    grid.Rebuild(store, top_left_corner, scene.GetBottomRightCorner());
+    ++num_rebuilds;
+    elapsed = Clock::now() - start;
+  }
+
+  return elapsed.count() / num_rebuilds;
+}
+
+void PrintTableHeader() {
+  std::cout << std::setw(10) << "particles" << std::setw(9) << "packing"
+            << std::setw(9) << "threads" << std::setw(8) << "steps"
+            << std::setw(14) << "ms/step" << std::setw(16) << "updates/s"
+            << std::setw(12) << "memory MiB" << std::setw(12) << "B/particle"
+            << std::setw(12) << "efficiency" << std::setw(12) << "grid ms"
+            << std::setw(12) << "grid eff" << std::setw(12) << "crowded ms"
+            << std::setw(12) << "crowded eff" << std::endl;
+}
+
+void PrintTableRow(const ScalingResult& result) {
+  double updates_per_second = result.num_particles / result.seconds_per_step;
+  std::cout << std::fixed << std::setw(10) << result.num_particles
+            << std::setprecision(2) << std::setw(9) << result.packing_fraction
+            << std::setw(9) << result.num_threads << std::setw(8)
+            << result.num_steps << std::setprecision(3) << std::setw(14)
+            << result.seconds_per_step * 1000 << std::setprecision(0)
+            << std::setw(16) << updates_per_second << std::setprecision(1)
+            << std::setw(12) << result.memory_bytes / (1024.0 * 1024.0)
+            << std::setw(12)
+            << double(result.memory_bytes) / result.num_particles
+            << std::setprecision(2) << std::setw(12)
+            << result.parallel_efficiency << std::setprecision(3)
+            << std::setw(12) << result.seconds_per_grid_rebuild * 1000
+            << std::setprecision(2) << std::setw(12)
+            << result.grid_parallel_efficiency << std::setprecision(3)
+            << std::setw(12) << result.seconds_per_crowded_grid_rebuild * 1000
+            << std::setprecision(2) << std::setw(12)
+            << result.crowded_grid_parallel_efficiency << std::endl;
+}
+
+void WriteCsv(std::ostream& output, const std::vector<ScalingResult>& results) {
+  output << "particles,packing_fraction,threads,steps,seconds_per_step,"
+         << "particle_updates_per_second,memory_bytes,bytes_per_particle,"
+         << "parallel_efficiency,seconds_per_grid_rebuild,"
+         << "grid_parallel_efficiency,seconds_per_crowded_grid_rebuild,"
+         << "crowded_grid_parallel_efficiency\n";
+  for (const ScalingResult& result : results) {
+    // The packing fraction is printed at float precision so 0.05 stays 0.05
+    output << result.num_particles << "," << std::setprecision(6)
+           << result.packing_fraction << std::setprecision(9) << ","
+           << result.num_threads << "," << result.num_steps << ","
+           << result.seconds_per_step << ","
+           << result.num_particles / result.seconds_per_step << ","
+           << result.memory_bytes << ","
+           << double(result.memory_bytes) / result.num_particles << ","
+           << result.parallel_efficiency << ","
+           << result.seconds_per_grid_rebuild << ","
+           << result.grid_parallel_efficiency << ","
+           << result.seconds_per_crowded_grid_rebuild << ","
+           << result.crowded_grid_parallel_efficiency << "\n";
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  ScalingOptions options;
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  // Only fixed stepping resolves collisions on several threads
+  if (options.stepping_mode == idealgas::SteppingMode::kEventDriven) {
+    options.thread_counts.assign(1, 1);
+  } else if (options.thread_counts.empty()) {
+    options.thread_counts = DefaultThreadCounts();
+  }
+
+  // Every efficiency is measured against a single thread run, so one is
+  // always swept first
+  std::vector<size_t>& thread_counts = options.thread_counts;
+  thread_counts.push_back(1);
+  std::sort(thread_counts.begin(), thread_counts.end());
+  thread_counts.erase(std::unique(thread_counts.begin(), thread_counts.end()),
+                      thread_counts.end());
+
+  std::vector<ScalingResult> results;
+  PrintTableHeader();
+  for (size_t num_particles = options.min_particles;
+       num_particles <= options.max_particles; num_particles *= 10) {
+    for (float packing_fraction : options.packing_fractions) {
+      idealgas::BenchmarkScene scene(num_particles, packing_fraction,
+                                     options.seed);
+      idealgas::ParticleStore store = scene.MakeStore();
+      idealgas::ParticleStore crowded_store = MakeCrowdedStore(scene);
+
+      double single_thread_seconds = 0;
+      double single_thread_grid_seconds = 0;
+      double single_thread_crowded_grid_seconds = 0;
+      for (size_t num_threads : options.thread_counts) {
+        ScalingResult result =
+            MeasureContainer(scene, packing_fraction, num_threads, options);
+        result.seconds_per_grid_rebuild =
+            MeasureGridRebuild(scene, store, num_threads, options);
+        result.seconds_per_crowded_grid_rebuild =
+            MeasureGridRebuild(scene, crowded_store, num_threads, options);
+        if (num_threads == 1) {
+          single_thread_seconds = result.seconds_per_step;
+          single_thread_grid_seconds = result.seconds_per_grid_rebuild;
+          single_thread_crowded_grid_seconds =
+              result.seconds_per_crowded_grid_rebuild;
+        }
+        result.parallel_efficiency =
+            single_thread_seconds /
+            (double(num_threads) * result.seconds_per_step);
+        result.grid_parallel_efficiency =
+            single_thread_grid_seconds /
+            (double(num_threads) * result.seconds_per_grid_rebuild);
+        result.crowded_grid_parallel_efficiency =
+            single_thread_crowded_grid_seconds /
+            (double(num_threads) * result.seconds_per_crowded_grid_rebuild);
+
+        PrintTableRow(result);
+        results.push_back(result);
+      }
+    }
+  }
+
+  if (!options.csv_file_name.empty()) {
+    std::ofstream csv_file(options.csv_file_name);
+    if (!csv_file) {
+      std::cerr << "Could not write " << options.csv_file_name << std::endl;
+      return 1;
+    }
+    WriteCsv(csv_file, results);
+  }
+
+  return 0;
+}
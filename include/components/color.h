@@ -0,0 +1,35 @@
+#pragma once
+
+namespace idealgas {
+
+/**
+ * A plain RGB color used by the simulation core so that it doesn't depend on
+ * Cinder. Any color type with r, g and b members, such as ci::Color, converts
+ * to it implicitly.
+ */
+struct Color {
+  /**
+   * Creates a black color
+   */
+  Color();
+
+  Color(float red, float green, float blue);
+
+  /**
+   * Converts from any color type that exposes r, g and b members
+   * @param color the color to convert
+   */
+  template <typename ColorType>
+  Color(const ColorType& color) : r(color.r), g(color.g), b(color.b) {
+  }
+
+  bool operator==(const Color& other) const;
+
+  bool operator!=(const Color& other) const;
+
+  float r;
+  float g;
+  float b;
+};
+
+}  // namespace idealgas
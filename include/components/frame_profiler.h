@@ -0,0 +1,181 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * The timed parts of a frame
+ */
+enum class ProfilePhase {
+  kWallCollisions,
+  kParticleCollisions,
+  kPositionUpdate,
+  kEventDriven,
+  kReorder,
+  kHistograms,
+  kNumPhases
+};
+
+/**
+ * The events counted during a frame
+ */
+enum class ProfileCounter {
+  kPairTests,
+  kCollisions,
+  kWallBounces,
+  kNeighbourRebuilds,
+  kReorders,
+  kNumCounters
+};
+
+/**
+ * The time spent in each phase and the counts of each event during one frame
+ */
+struct FrameProfile {
+  double phase_seconds[size_t(ProfilePhase::kNumPhases)];
+  size_t counts[size_t(ProfileCounter::kNumCounters)];
+};
+
+/**
+ * Records how long each phase of a frame takes along with a few event counts,
+ * keeping the last kHistorySize frames so rolling percentiles can be read
+ * back. All of its memory is allocated up front, so recording never allocates.
+ *
+ * The simulation only records through the IDEALGAS_PROFILE_* macros below,
+ * which compile to nothing unless IDEALGAS_PROFILING is defined.
+ */
+class FrameProfiler {
+ public:
+  static const size_t kHistorySize = 240;
+
+  /**
+   * Times a phase from construction until the end of the enclosing scope
+   */
+  class ScopedPhase {
+   public:
+    /**
+     * Starts timing a phase
+     * @param profiler the profiler to add the time to
+     * @param phase the phase being timed
+     */
+    ScopedPhase(FrameProfiler* profiler, ProfilePhase phase);
+
+    /**
+     * Adds the time since construction to the phase
+     */
+    ~ScopedPhase();
+
+   private:
+    FrameProfiler* profiler_;
+    ProfilePhase phase_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  /**
+   * Creates a profiler with no recorded frames
+   */
+  FrameProfiler();
+
+  /**
+   * Starts a new frame with every phase time and count at zero
+   */
+  void BeginFrame();
+
+  /**
+   * Adds the current frame to the history of recorded frames
+   */
+  void EndFrame();
+
+  /**
+   * Adds time to a phase of the current frame
+   * @param phase the phase the time was spent in
+   * @param seconds the time spent
+   */
+  void AddPhaseTime(ProfilePhase phase, double seconds);
+
+  /**
+   * Adds to an event count of the current frame
+   * @param counter the event that happened
+   * @param amount the number of times it happened
+   */
+  void AddCount(ProfileCounter counter, size_t amount);
+
+  /**
+   * Adds every phase time and count of a frame recorded elsewhere, such as on
+   * the simulation thread, into the current frame
+   * @param frame the frame to add
+   */
+  void AddFrame(const FrameProfile& frame);
+
+  /**
+   * Gets the most recently finished frame
+   * @return the phase times and counts of that frame, all zero if no frame has
+   * finished yet
+   */
+  const FrameProfile& GetLastFrame() const;
+
+  /**
+   * Gets the number of finished frames the percentiles are taken over
+   * @return the number of frames, at most kHistorySize
+   */
+  size_t GetNumFrames() const;
+
+  /**
+   * Calculates a percentile of a phase's time over the recorded frames
+   * @param phase the phase to look at
+   * @param percentile the percentile from 0 to 100
+   * @return the phase time in seconds, or zero if no frames are recorded
+   */
+  double CalculatePhasePercentile(ProfilePhase phase, float percentile) const;
+
+  /**
+   * Calculates a percentile of an event count over the recorded frames
+   * @param counter the event to look at
+   * @param percentile the percentile from 0 to 100
+   * @return the count, or zero if no frames are recorded
+   */
+  double CalculateCounterPercentile(ProfileCounter counter,
+                                    float percentile) const;
+
+  static const char* GetPhaseName(ProfilePhase phase);
+
+  static const char* GetCounterName(ProfileCounter counter);
+
+ private:
+  /**
+   * Picks a percentile out of the values gathered into the scratch buffer
+   */
+  double CalculateScratchPercentile(float percentile) const;
+
+  FrameProfile current_frame_;
+  std::vector<FrameProfile> history_;
+  size_t next_history_slot_;
+  size_t num_frames_;
+
+  // Reused by the percentile queries so they don't allocate
+  mutable std::vector<double> scratch_;
+};
+
+}  // namespace idealgas
+
+#define IDEALGAS_PROFILE_CONCAT_INNER(a, b) a##b
+#define IDEALGAS_PROFILE_CONCAT(a, b) IDEALGAS_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef IDEALGAS_PROFILING
+#define IDEALGAS_PROFILE_BEGIN_FRAME(profiler) (profiler)->BeginFrame()
+#define IDEALGAS_PROFILE_END_FRAME(profiler) (profiler)->EndFrame()
+#define IDEALGAS_PROFILE_PHASE(profiler, phase)                  \
+  ::idealgas::FrameProfiler::ScopedPhase IDEALGAS_PROFILE_CONCAT( \
+      idealgas_profile_phase_, __LINE__)(profiler, phase)
+#define IDEALGAS_PROFILE_COUNT(profiler, counter, amount) \
+  (profiler)->AddCount(counter, amount)
+#else
+#define IDEALGAS_PROFILE_BEGIN_FRAME(profiler) ((void)0)
+#define IDEALGAS_PROFILE_END_FRAME(profiler) ((void)0)
+#define IDEALGAS_PROFILE_PHASE(profiler, phase) ((void)0)
+// The amount is still evaluated in case it has side effects
+#define IDEALGAS_PROFILE_COUNT(profiler, counter, amount) ((void)(amount))
+#endif
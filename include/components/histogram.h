@@ -1,12 +1,16 @@
 #pragma once
 
 #include "cinder/gl/gl.h"
-#include "particle.h"
+#include "components/color.h"
+#include "components/particle.h"
+#include "components/particle_store.h"
+#include "components/speed_bins.h"
 
 namespace idealgas {
 /**
  * This class represents a singular Histogram on the simulation that will
- * properly model and render the particle speeds of a set of particles
+ * properly model and render the particle speeds of a set of particles. The
+ * binning itself is done by SpeedBins in the simulation core.
  */
 class Histogram {
  public:
@@ -27,7 +31,7 @@ class Histogram {
   Histogram(const std::vector<Particle*>& particles,
             const glm::vec2& top_left_corner,
             const glm::vec2& bottom_right_corner, float bin_width,
-            const ci::Color& bin_color, size_t num_y_axis_marks);
+            const Color& bin_color, size_t num_y_axis_marks);
 
   /**
    * Draws the Histogram on the screen of cinder according to configuration
@@ -40,30 +44,26 @@ class Histogram {
    * @param particles the particles to be placed into this histogram
    * @return a vector representing the number of particles in each bin
    */
-  std::vector<size_t> UpdateParticleBins(
+  const std::vector<size_t>& UpdateParticleBins(
       const std::vector<Particle*>& particles);
 
- private:
-  /**
-   * Calculates the number of bins that will be displayed based on bin width
-   * @param particles the particles to be placed into the histogram
-   * @return the number of bins in the histogram
-   */
-  size_t CalculateNumOfBins(const std::vector<Particle*>& particles);
-
   /**
-   * Determines the fastest particle in the incoming set of particles
-   * @param particles the incoming set of particles
-   * @return the fastest particle speed
+   * Updates each of the bins from the particles in a store whose color
+   * matches this histogram's bin color, reading the velocity arrays directly
+   * @param store the store holding every particle in the container
+   * @return a vector representing the number of particles in each bin
    */
-  float CalculateFastestParticle(const std::vector<Particle*>& particles);
+  const std::vector<size_t>& UpdateParticleBins(const ParticleStore& store);
 
   /**
-   * Determines which bin of particles has the most particles
-   * @return the number of particles in that bin
+   * Takes over bins that were already counted elsewhere, such as by a
+   * SpeciesSpeedBins pass shared between several histograms
+   * @param speed_bins the bins of this histogram's species
+   * @return a vector representing the number of particles in each bin
    */
-  size_t CalculateMostParticlesInSingleBin();
+  const std::vector<size_t>& UpdateParticleBins(const SpeedBins& speed_bins);
 
+ private:
   /**
    * Draws the x axis label on the histogram
    */
@@ -85,10 +85,8 @@ class Histogram {
   glm::vec2 bottom_right_corner_;
   float histogram_height_;
   float histogram_width_;
-  float bin_width_;
-  std::vector<size_t> particle_bins_;
-  ci::Color bin_color_;
-  size_t num_bins_;
+  SpeedBins speed_bins_;
+  Color bin_color_;
   size_t num_y_axis_marks_;
 };
 }  // namespace idealgas
@@ -1,12 +1,17 @@
 #pragma once
 
-#include "cinder/gl/gl.h"
+#include <glm/glm.hpp>
+
+#include "components/color.h"
 
 namespace idealgas {
 
 /**
  * This class represents a singular particle that will exist within a container
- * with a specific attributes the replicate an ideal gas particle
+ * with a specific attributes the replicate an ideal gas particle.
+ *
+ * A particle owns its own state; particles already in a container are reached
+ * through ParticleView instead.
  */
 class Particle {
  public:
@@ -19,13 +24,13 @@ class Particle {
    * @param mass the mass of the particle
    */
   Particle(const glm::vec2& position, const glm::vec2& velocity,
-           const ci::Color& color, float radius, float mass);
+           const Color& color, float radius, float mass);
 
   glm::vec2 GetPosition() const;
 
   glm::vec2 GetVelocity() const;
 
-  ci::Color GetColor() const;
+  Color GetColor() const;
 
   float GetRadius() const;
 
@@ -51,11 +56,22 @@ class Particle {
   void UpdateVelocity(const glm::vec2& delta_velocity,
                       bool should_increase_speed);
 
+  /**
+   * Adjusts a single velocity component away from or towards zero, leaving a
+   * component that is already zero untouched
+   * @param component the current velocity component
+   * @param delta the amount to adjust the component by
+   * @param should_increase_speed whether the magnitude should grow or shrink
+   * @return the adjusted velocity component
+   */
+  static float AdjustVelocityComponent(float component, float delta,
+                                       bool should_increase_speed);
+
  private:
   glm::vec2 position_;
   glm::vec2 velocity_;
-  ci::Color color_;
+  Color color_;
   float radius_;
   float mass_;
 };
-}  // namespace idealgas
\ No newline at end of file
+}  // namespace idealgas
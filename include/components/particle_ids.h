@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * Gives each particle in a ParticleStore an id that stays the same while the
+ * particle moves between slots, whether because another particle was removed
+ * or because the store was reordered. Like SlotIndex it mirrors the store's
+ * own bookkeeping, so each add or remove only touches the slots involved. The
+ * id of a removed particle is handed to the next particle added.
+ */
+class ParticleIds {
+ public:
+  // The slot of an id that no particle currently holds
+  static const size_t kNoSlot;
+
+  /**
+   * Creates a mapping with no particles
+   */
+  ParticleIds();
+
+  /**
+   * Appends the next slot, as ParticleStore::Add does
+   * @return the id of the particle in the new slot
+   */
+  size_t Add();
+
+  /**
+   * Removes a slot by moving the last slot into it, as ParticleStore::Remove
+   * does, and frees the removed particle's id
+   * @param slot the slot to remove
+   */
+  void Remove(size_t slot);
+
+  /**
+   * Frees every id, keeping the memory the mapping used
+   */
+  void Clear();
+
+  /**
+   * Moves the ids along with a reordering of the store
+   * @param order the old slot of the particle now in each slot
+   */
+  void Reorder(const std::vector<size_t>& order);
+
+  size_t Size() const;
+
+  /**
+   * Gets the id of the particle in a slot
+   * @param slot the slot of the particle
+   * @return the particle's id
+   */
+  size_t GetId(size_t slot) const;
+
+  /**
+   * Gets the slot a particle is currently stored in
+   * @param id the id of the particle
+   * @return the particle's slot, or kNoSlot if no particle holds the id
+   */
+  size_t GetSlot(size_t id) const;
+
+ private:
+  std::vector<size_t> slot_ids_;
+  std::vector<size_t> id_slots_;
+  std::vector<size_t> free_ids_;
+
+  // Where Reorder gathers the ids before swapping them in
+  std::vector<size_t> reordered_ids_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+
+#include "components/particle.h"
+#include "components/particle_view.h"
+
+namespace idealgas {
+
+/**
+ * A view of some or all of a container's particles that doesn't copy them,
+ * used like a std::vector<ParticleView*>. Loops written against the older
+ * std::vector<Particle*> still work, through a copy of each particle that is
+ * written back as the loop moves on. It only stays valid until particles are
+ * added to or removed from the container.
+ */
+class ParticleRange {
+ public:
+  class Iterator;
+
+  /**
+   * The particle an iterator is on. It converts to the particle's view, or
+   * for code written against Particle pointers to a copy of the particle that
+   * the iterator writes back to the store once it moves on.
+   */
+  class Element {
+   public:
+    explicit Element(const Iterator* iterator) : iterator_(iterator) {
+    }
+
+    operator ParticleView*() const {
+      return iterator_->GetView();
+    }
+
+    operator Particle*() const {
+      return iterator_->CopyParticle();
+    }
+
+    ParticleView* operator->() const {
+      return iterator_->GetView();
+    }
+
+   private:
+    const Iterator* iterator_;
+  };
+
+  /**
+   * Steps through the particles of a range
+   */
+  class Iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef ParticleView* value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef ParticleView* const* pointer;
+    typedef Element reference;
+
+    Iterator(const ParticleRange* range, size_t index);
+
+    ~Iterator();
+
+    Element operator*() const {
+      return Element(this);
+    }
+
+    Iterator& operator++() {
+      WriteBackParticle();
+      ++index_;
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return index_ != other.index_;
+    }
+
+    ParticleView* GetView() const {
+      return (*range_)[index_];
+    }
+
+    /**
+     * Copies the current particle out of the store
+     * @return the copy, which stays valid until the iterator moves on
+     */
+    Particle* CopyParticle() const;
+
+   private:
+    /**
+     * Writes the position and velocity of the current particle's copy, if
+     * one was made, back to the store
+     */
+    void WriteBackParticle();
+
+    const ParticleRange* range_;
+    size_t index_;
+    mutable Particle particle_copy_;
+    mutable bool has_particle_copy_;
+  };
+
+  /**
+   * Creates an empty range
+   */
+  ParticleRange();
+
+  /**
+   * Creates a range over every particle in an array
+   * @param particles the first particle
+   * @param size the number of particles
+   */
+  ParticleRange(ParticleView* particles, size_t size);
+
+  /**
+   * Creates a range over chosen particles of an array
+   * @param particles the particles the slots index into
+   * @param slots the slots of the particles in the range
+   * @param size the number of slots
+   */
+  ParticleRange(ParticleView* particles, const size_t* slots, size_t size);
+
+  ParticleView* operator[](size_t index) const {
+    return &particles_[slots_ == nullptr ? index : slots_[index]];
+  }
+
+  /**
+   * Gets a particle, checking that it is inside the range
+   * @param index the position of the particle in the range
+   * @return the particle
+   * @throws std::out_of_range if the index is past the end of the range
+   */
+  ParticleView* at(size_t index) const;
+
+  size_t size() const;
+
+  bool empty() const;
+
+  Iterator begin() const;
+
+  Iterator end() const;
+
+ private:
+  ParticleView* particles_;
+  // Null when the range covers every particle in order
+  const size_t* slots_;
+  size_t size_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "components/color.h"
+#include "components/species_table.h"
+
+namespace idealgas {
+
+/**
+ * Contiguous structure-of-arrays storage for every particle in a container.
+ * Positions and velocities are kept in their own arrays so the per-frame
+ * passes stream through exactly the data they need. Each particle only stores
+ * its radius, which every overlap test reads, and a compact species id; the
+ * color and mass are kept once per species in a SpeciesTable.
+ */
+class ParticleStore {
+ public:
+  /**
+   * Creates an empty store
+   */
+  ParticleStore();
+
+  /**
+   * Appends a particle to the end of the store, registering its species if no
+   * particle with the same color, radius and mass has been added before
+   * @param position the starting position of the particle
+   * @param velocity the starting velocity of the particle
+   * @param color the color of the particle
+   * @param radius the radius of the particle
+   * @param mass the mass of the particle
+   * @return the slot that the particle was stored in
+   */
+  size_t Add(const glm::vec2& position, const glm::vec2& velocity,
+             const Color& color, float radius, float mass);
+
+  /**
+   * Appends a particle of an already registered species to the end of the
+   * store
+   * @param position the starting position of the particle
+   * @param velocity the starting velocity of the particle
+   * @param species the id of the particle's species
+   * @return the slot that the particle was stored in
+   */
+  size_t Add(const glm::vec2& position, const glm::vec2& velocity,
+             SpeciesId species);
+
+  /**
+   * Reserves room for a number of particles so adding them won't reallocate
+   * @param capacity the number of particles to make room for
+   */
+  void Reserve(size_t capacity);
+
+  /**
+   * Removes a particle by moving the last particle into its slot, so the
+   * arrays stay packed and the freed slot is reused by the next Add
+   * @param slot the slot of the particle to remove
+   */
+  void Remove(size_t slot);
+
+  /**
+   * Removes every particle from the store, keeping the registered species and
+   * the memory already reserved for the arrays
+   */
+  void Clear();
+
+  /**
+   * Replaces this store's particles with another store's in a new order. The
+   * arrays are filled in place, so once this store has held as many particles
+   * as the other it gathers them without allocating.
+   * @param source the store to copy the particles and species from
+   * @param order the slot in source of the particle to put in each slot
+   */
+  void GatherFrom(const ParticleStore& source,
+                  const std::vector<size_t>& order);
+
+  size_t Size() const;
+
+  /**
+   * Gets how many particles fit in the store before it has to grow
+   * @return the number of particles the arrays have room for
+   */
+  size_t Capacity() const;
+
+  bool IsEmpty() const;
+
+  glm::vec2 GetPosition(size_t slot) const;
+
+  glm::vec2 GetVelocity(size_t slot) const;
+
+  const Color& GetColor(size_t slot) const;
+
+  float GetRadius(size_t slot) const;
+
+  float GetMass(size_t slot) const;
+
+  SpeciesId GetSpecies(size_t slot) const;
+
+  float GetSpeed(size_t slot) const;
+
+  void SetPosition(size_t slot, const glm::vec2& new_position);
+
+  void SetVelocity(size_t slot, const glm::vec2& new_velocity);
+
+  float* GetXPositions();
+
+  float* GetYPositions();
+
+  float* GetXVelocities();
+
+  float* GetYVelocities();
+
+  const float* GetXPositions() const;
+
+  const float* GetYPositions() const;
+
+  const float* GetXVelocities() const;
+
+  const float* GetYVelocities() const;
+
+  const float* GetRadii() const;
+
+  const SpeciesId* GetSpeciesIds() const;
+
+  const SpeciesTable& GetSpeciesTable() const;
+
+  /**
+   * Registers a species without adding any particles of it
+   * @param color the color of the species
+   * @param radius the radius of every particle in the species
+   * @param mass the mass of every particle in the species
+   * @return the id of the species
+   */
+  SpeciesId RegisterSpecies(const Color& color, float radius, float mass);
+
+  /**
+   * Calculates the magnitude of a velocity, shared by every speed query so
+   * the store and standalone particles always agree
+   * @param x_velocity the horizontal component of the velocity
+   * @param y_velocity the vertical component of the velocity
+   * @return the speed
+   */
+  static float CalculateSpeed(float x_velocity, float y_velocity);
+
+ private:
+  // Hot data touched by every pass
+  std::vector<float> x_positions_;
+  std::vector<float> y_positions_;
+  std::vector<float> x_velocities_;
+  std::vector<float> y_velocities_;
+
+  // Per-particle attributes, with everything else looked up by species
+  std::vector<float> radii_;
+  std::vector<SpeciesId> species_;
+  SpeciesTable species_table_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "components/color.h"
+#include "components/particle_store.h"
+
+namespace idealgas {
+
+/**
+ * A lightweight view onto one slot of a ParticleStore, holding nothing but the
+ * store and the slot. Every read and write goes straight to the store, and
+ * copying a view gives another view of the same slot.
+ */
+class ParticleView {
+ public:
+  /**
+   * Creates a view of a particle that lives in a particle store
+   * @param store the store holding the particle's state
+   * @param slot the slot of the particle within the store
+   */
+  ParticleView(ParticleStore* store, size_t slot);
+
+  glm::vec2 GetPosition() const;
+
+  glm::vec2 GetVelocity() const;
+
+  Color GetColor() const;
+
+  float GetRadius() const;
+
+  float GetMass() const;
+
+  float GetSpeed() const;
+
+  size_t GetSlot() const;
+
+  void SetPosition(const glm::vec2& new_position);
+
+  void SetVelocity(const glm::vec2& new_velocity);
+
+  /**
+   * Moves the particle by its velocity, as if one unit of time had passed
+   */
+  void UpdatePosition();
+
+  /**
+   * Adjusts the particle's velocity as Particle::UpdateVelocity does
+   * @param delta_velocity the amount to adjust the current velocity by
+   * @param should_increase_speed whether the magnitude should grow or shrink
+   */
+  void UpdateVelocity(const glm::vec2& delta_velocity,
+                      bool should_increase_speed);
+
+ private:
+  ParticleStore* store_;
+  size_t slot_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * Sorts the slots of a ParticleStore into numbered buckets, such as one per
+ * species, so the slots in a bucket can be read without scanning the store.
+ * It mirrors the store's own bookkeeping: new slots are appended, and removing
+ * a slot moves the last slot into it. Each change only touches the two slots
+ * involved.
+ */
+class SlotIndex {
+ public:
+  /**
+   * Creates an index with no slots
+   */
+  SlotIndex();
+
+  /**
+   * Appends the next slot, as ParticleStore::Add does
+   * @param bucket the bucket the slot belongs to
+   * @return the slot that was added
+   */
+  size_t Add(size_t bucket);
+
+  /**
+   * Removes a slot by moving the last slot into it, as ParticleStore::Remove
+   * does
+   * @param slot the slot to remove
+   */
+  void Remove(size_t slot);
+
+  /**
+   * Removes every slot, keeping the buckets' memory
+   */
+  void Clear();
+
+  size_t Size() const;
+
+  /**
+   * Gets the slots in a bucket, in the order they were added except that a
+   * removal moves the bucket's last slot into the removed one's place
+   * @param bucket the bucket to look up
+   * @return the slots in that bucket, empty if none were ever added to it
+   */
+  const std::vector<size_t>& GetSlots(size_t bucket) const;
+
+ private:
+  std::vector<std::vector<size_t>> bucket_slots_;
+
+  // Per slot, which bucket it is in and where it sits in that bucket's list
+  std::vector<size_t> slot_buckets_;
+  std::vector<size_t> slot_positions_;
+
+  // Returned for buckets that nothing was added to
+  std::vector<size_t> no_slots_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include "components/color.h"
+#include "components/particle_store.h"
+#include "components/speed_bins.h"
+
+namespace idealgas {
+
+/**
+ * Bins the speeds of several species of particles at once. Every registered
+ * species is filled in by the same walk over the particle store, so each speed
+ * is calculated once no matter how many histograms read from it, and the bins
+ * reuse their memory from frame to frame.
+ */
+class SpeciesSpeedBins {
+ public:
+  /**
+   * Starts tracking the speeds of every particle with a specific color. Each
+   * color should only be registered once.
+   * @param color the color of the particles in the species
+   * @param bin_width the range of speeds covered by each bin
+   * @return the index the species' bins can be looked up by
+   */
+  size_t Register(const Color& color, float bin_width);
+
+  /**
+   * Re-bins every registered species in a single pass over the store. The
+   * bins are only reserved again when the number of particles changes.
+   * @param store the store holding every particle in the container
+   */
+  void Update(const ParticleStore& store);
+
+  const SpeedBins& GetSpeedBins(size_t index) const;
+
+  /**
+   * Gets the fastest speed seen in a species during the last update
+   * @param index the index returned when the species was registered
+   * @return the fastest speed, or zero if the species has no particles
+   */
+  float GetMaxSpeed(size_t index) const;
+
+  size_t GetNumSpecies() const;
+
+ private:
+  static const size_t kUnregistered = size_t(-1);
+  // Keeps a tiny bin width or a huge energy from reserving absurd amounts
+  static const size_t kMaxReservedBins = 65536;
+
+  /**
+   * Makes room in each registered species' bins for the fastest speed its
+   * particles could reach with the container's kinetic energy
+   * @param store the store that was just binned
+   */
+  void ReserveForEnergy(const ParticleStore& store);
+
+  std::vector<Color> colors_;
+  std::vector<SpeedBins> speed_bins_;
+  std::vector<float> max_speeds_;
+
+  // Which registered species each store species belongs to, reused each update
+  std::vector<size_t> indices_by_species_;
+  // How many particles the bins were last reserved for
+  size_t num_particles_reserved_for_ = kUnregistered;
+};
+
+}  // namespace idealgas
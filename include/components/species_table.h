@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "components/color.h"
+
+namespace idealgas {
+
+/**
+ * The compact index a particle uses to refer to its species
+ */
+using SpeciesId = uint16_t;
+
+/**
+ * Registry of every kind of particle in a store. The color, radius and mass of
+ * a species are kept once here rather than once per particle. Species are
+ * found by their attributes through a hash map, so even mixes where every
+ * particle is its own species are registered in constant time per particle.
+ */
+class SpeciesTable {
+ public:
+  /**
+   * Creates an empty table
+   */
+  SpeciesTable();
+
+  /**
+   * Looks up the species with exactly these attributes, registering a new one
+   * if there isn't one yet
+   * @param color the color of the species
+   * @param radius the radius of every particle in the species
+   * @param mass the mass of every particle in the species
+   * @return the id of the species
+   * @throws std::length_error if the species is new and every SpeciesId is
+   * already taken
+   */
+  SpeciesId FindOrAdd(const Color& color, float radius, float mass);
+
+  /**
+   * Removes every species
+   */
+  void Clear();
+
+  size_t Size() const;
+
+  const Color& GetColor(SpeciesId species) const;
+
+  float GetRadius(SpeciesId species) const;
+
+  float GetMass(SpeciesId species) const;
+
+  /**
+   * Gets how strongly a species is deflected when it hits another species,
+   * 2 * other_mass / (mass + other_mass) in the elastic collision equations.
+   * It is worked out from the two masses each time rather than stored, since
+   * a table of every pair grows with the square of the number of species.
+   * @param species the species whose velocity is being updated
+   * @param other_species the species it collided with
+   * @return the mass factor of the pair
+   */
+  float GetMassFactor(SpeciesId species, SpeciesId other_species) const;
+
+  /**
+   * Calculates the mass factor of a pair of masses, shared so the table and
+   * standalone particles always agree
+   * @param mass the mass whose velocity is being updated
+   * @param other_mass the mass it collided with
+   * @return the mass factor of the pair
+   */
+  static float CalculateMassFactor(float mass, float other_mass);
+
+ private:
+  /**
+   * The attributes a species is looked up by
+   */
+  struct SpeciesKey {
+    bool operator==(const SpeciesKey& other) const;
+
+    Color color;
+    float radius;
+    float mass;
+  };
+
+  struct SpeciesKeyHash {
+    size_t operator()(const SpeciesKey& key) const;
+  };
+
+  // One more than the largest SpeciesId, so ids never wrap around
+  static const size_t kMaxSpecies =
+      size_t(std::numeric_limits<SpeciesId>::max()) + 1;
+
+  std::vector<Color> colors_;
+  std::vector<float> radii_;
+  std::vector<float> masses_;
+  std::unordered_map<SpeciesKey, SpeciesId, SpeciesKeyHash> species_by_key_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "components/color.h"
+#include "components/particle.h"
+#include "components/particle_store.h"
+
+namespace idealgas {
+
+/**
+ * Counts how many particles fall into each fixed-width range of speeds. This is
+ * the rendering-free half of a Histogram, so it can run without Cinder.
+ */
+class SpeedBins {
+ public:
+  /**
+   * Creates a single empty bin with a width of one
+   */
+  SpeedBins();
+
+  /**
+   * Creates a single empty bin
+   * @param bin_width the range of speeds covered by each bin
+   */
+  explicit SpeedBins(float bin_width);
+
+  /**
+   * Re-bins a set of particles in a single pass, growing or shrinking the
+   * number of bins so the fastest particle lands in the last one
+   * @param particles the particles to bin
+   * @return the number of particles in each bin
+   */
+  const std::vector<size_t>& Update(const std::vector<Particle*>& particles);
+
+  /**
+   * Re-bins the particles in a store that have a specific color
+   * @param store the store holding every particle in the container
+   * @param color the color of the particles to bin
+   * @return the number of particles in each bin
+   */
+  const std::vector<size_t>& Update(const ParticleStore& store,
+                                    const Color& color);
+
+  /**
+   * Empties the bins back to a single empty bin, keeping their memory
+   */
+  void Clear();
+
+  /**
+   * Makes room for a number of bins so adding particles up to that speed
+   * won't allocate
+   * @param num_bins the number of bins to make room for
+   */
+  void Reserve(size_t num_bins);
+
+  /**
+   * Counts one more particle, adding bins if it is faster than any so far
+   * @param speed the speed of the particle
+   */
+  void Add(float speed);
+
+  const std::vector<size_t>& GetBins() const;
+
+  size_t GetNumBins() const;
+
+  float GetBinWidth() const;
+
+  /**
+   * Determines which bin of particles has the most particles
+   * @return the number of particles in that bin
+   */
+  size_t CalculateMostParticlesInSingleBin() const;
+
+ private:
+  float bin_width_;
+  std::vector<size_t> bins_;
+};
+
+}  // namespace idealgas
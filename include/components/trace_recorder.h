@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * Records timed events from any thread over a bounded window of frames and
+ * writes them out as a Chrome trace-event JSON file, which chrome://tracing
+ * and Perfetto can open. Every thread appends to its own preallocated buffer
+ * without locking or allocating; nothing is formatted until WriteJson is
+ * called after the window closes, so recording stays off the hot path.
+ *
+ * A thread gets its buffer when it names itself or calls Start, and gives it
+ * back when it exits, so a later thread can take over the slot. Events from a
+ * thread without a buffer are counted as dropped.
+ *
+ * The simulation only records through the IDEALGAS_TRACE_* macros below, which
+ * compile to nothing unless IDEALGAS_PROFILING is defined.
+ */
+class TraceRecorder {
+ public:
+  static const size_t kMaxEventsPerThread = 16384;
+  static const size_t kMaxThreads = 64;
+
+  /**
+   * Records an event lasting from construction until the end of the enclosing
+   * scope, if the recorder was recording when it began
+   */
+  class ScopedEvent {
+   public:
+    /**
+     * Starts timing an event
+     * @param recorder the recorder to add the event to
+     * @param name the name of the event, which must outlive the recorder
+     */
+    ScopedEvent(TraceRecorder* recorder, const char* name);
+
+    /**
+     * Adds the event to the recorder
+     */
+    ~ScopedEvent();
+
+   private:
+    TraceRecorder* recorder_;
+    const char* name_;
+    bool is_recording_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  /**
+   * Creates a recorder that isn't recording yet
+   */
+  TraceRecorder();
+
+  TraceRecorder(const TraceRecorder&) = delete;
+
+  TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+  /**
+   * Gets the recorder the IDEALGAS_TRACE_* macros record into
+   * @return the process-wide recorder
+   */
+  static TraceRecorder& GetInstance();
+
+  /**
+   * Throws away any earlier events and starts recording, giving the calling
+   * thread a buffer if it doesn't have one yet
+   * @param num_frames the number of frames to record before stopping on its
+   * own, counted by MarkFrame
+   */
+  void Start(size_t num_frames);
+
+  /**
+   * Stops recording before the window of frames has finished
+   */
+  void Stop();
+
+  bool IsRecording() const;
+
+  /**
+   * Counts the end of a frame, stopping the recording once the window is over
+   */
+  void MarkFrame();
+
+  /**
+   * Names the calling thread in the written trace, giving it a buffer if it
+   * doesn't have one yet
+   * @param name the name of the thread, which must outlive the recorder
+   */
+  void NameThisThread(const char* name);
+
+  /**
+   * Adds a finished event for the calling thread, dropping it if the thread
+   * has no buffer or its buffer is full
+   * @param name the name of the event, which must outlive the recorder
+   * @param start when the event began
+   * @param end when the event finished
+   */
+  void Record(const char* name, std::chrono::steady_clock::time_point start,
+              std::chrono::steady_clock::time_point end);
+
+  /**
+   * Gets the number of events recorded since the last Start
+   * @return the number of events across every thread
+   */
+  size_t GetNumEvents() const;
+
+  /**
+   * Gets the number of events dropped because a buffer was full or missing
+   * @return the number of dropped events across every thread
+   */
+  size_t GetNumDroppedEvents() const;
+
+  /**
+   * Writes every event recorded since the last Start as trace-event JSON
+   * @param output the stream to write to
+   */
+  void WriteJson(std::ostream& output) const;
+
+ private:
+  struct TraceEvent {
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+  };
+
+  /**
+   * The events of one thread. Only the owning thread writes to it; the count
+   * is published with release ordering so readers see whole events.
+   */
+  struct ThreadBuffer {
+    std::thread::id thread_id;
+    const char* thread_name;
+    std::vector<TraceEvent> events;
+    std::atomic<size_t> num_events;
+    std::atomic<size_t> num_dropped_events;
+    std::atomic<size_t> generation;
+    // Cleared when the owning thread exits, so another thread can take over
+    std::atomic<bool> is_claimed;
+  };
+
+  /**
+   * Finds the calling thread's buffer without locking, emptying it on its
+   * first event after a Start
+   * @return the buffer, or null if the thread has none
+   */
+  ThreadBuffer* GetThreadBuffer();
+
+  /**
+   * Gives the calling thread a buffer, reusing its own, then one left behind
+   * by an exited thread with nothing from the current window, then a new one.
+   * Must be called with buffers_mutex_ held.
+   * @return the buffer, or null if every slot is taken
+   */
+  ThreadBuffer* ClaimThreadBuffer();
+
+  /**
+   * Finds a buffer the calling thread claimed before and no other thread has
+   * taken over since, without allocating.
+   * Must be called with buffers_mutex_ held.
+   * @return the buffer, or null if the thread has none
+   */
+  ThreadBuffer* FindThreadBuffer();
+
+  /**
+   * Points the calling thread's cached lookup at one of this recorder's
+   * buffers, giving back the buffer it pointed at before. Must be called with
+   * buffers_mutex_ held.
+   * @param buffer the buffer to cache, or null if the thread has none
+   */
+  void CacheThreadBuffer(ThreadBuffer* buffer);
+
+  // Distinguishes recorders in each thread's cached buffer lookup
+  const size_t id_;
+  const std::chrono::steady_clock::time_point epoch_;
+
+  std::atomic<bool> is_recording_;
+  std::atomic<size_t> frames_remaining_;
+  // Bumped by every Start so stale buffers are skipped and lazily emptied
+  std::atomic<size_t> generation_;
+  // Events from threads without a buffer since the last Start
+  std::atomic<size_t> num_unbuffered_events_;
+
+  mutable std::mutex buffers_mutex_;
+  // Shared with the threads' cached lookups, which may outlive the recorder
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+}  // namespace idealgas
+
+#define IDEALGAS_TRACE_CONCAT_INNER(a, b) a##b
+#define IDEALGAS_TRACE_CONCAT(a, b) IDEALGAS_TRACE_CONCAT_INNER(a, b)
+
+#ifdef IDEALGAS_PROFILING
+#define IDEALGAS_TRACE_SCOPE(name)                              \
+  ::idealgas::TraceRecorder::ScopedEvent IDEALGAS_TRACE_CONCAT( \
+      idealgas_trace_scope_, __LINE__)(                         \
+      &::idealgas::TraceRecorder::GetInstance(), name)
+#define IDEALGAS_TRACE_FRAME() \
+  ::idealgas::TraceRecorder::GetInstance().MarkFrame()
+#define IDEALGAS_TRACE_THREAD_NAME(name) \
+  ::idealgas::TraceRecorder::GetInstance().NameThisThread(name)
+#else
+#define IDEALGAS_TRACE_SCOPE(name) ((void)0)
+#define IDEALGAS_TRACE_FRAME() ((void)0)
+#define IDEALGAS_TRACE_THREAD_NAME(name) ((void)0)
+#endif
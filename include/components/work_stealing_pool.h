@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * A fixed set of worker threads that the stages of a frame hand their loops
+ * to. A loop is cut into chunks, and each thread starts on an even share of
+ * them; a thread that runs out steals half of the chunks another thread has
+ * left, so a share that lands on a dense corner of the container doesn't keep
+ * the rest of the threads waiting. The workers sleep between loops and are
+ * reused from frame to frame, and handing out a loop never allocates.
+ */
+class WorkStealingPool {
+ public:
+  /**
+   * Creates a pool that runs loops on the calling thread and num_threads - 1
+   * workers
+   * @param num_threads the number of threads loops are split across, at least
+   * one
+   */
+  explicit WorkStealingPool(size_t num_threads = 1);
+
+  WorkStealingPool(const WorkStealingPool& other) = delete;
+
+  WorkStealingPool& operator=(const WorkStealingPool& other) = delete;
+
+  /**
+   * Stops and joins every worker
+   */
+  ~WorkStealingPool();
+
+  /**
+   * Replaces the workers with a different number of them, which must not
+   * happen while a loop is running
+   * @param num_threads the number of threads, at least one
+   */
+  void SetNumThreads(size_t num_threads);
+
+  size_t GetNumThreads() const;
+
+  /**
+   * Runs a loop over [0, count) cut into chunks of grain_size and waits for
+   * every chunk to finish. The calling thread takes part, and a loop of a
+   * single chunk runs on it without waking any worker.
+   * @param count the number of loop iterations
+   * @param grain_size the iterations per chunk, at least one
+   * @param task called as task(begin, end, thread) for each chunk, where
+   * thread is below GetNumThreads and no two chunks run on the same thread at
+   * once
+   */
+  template <typename Task>
+  void ParallelFor(size_t count, size_t grain_size, const Task& task);
+
+  /**
+   * Runs a number of tasks, one chunk each, and waits for all of them
+   * @param num_tasks the number of tasks
+   * @param task called as task(index) for each task
+   */
+  template <typename Task>
+  void RunTasks(size_t num_tasks, const Task& task);
+
+  /**
+   * Picks a chunk size that gives every thread several chunks to balance with
+   * while keeping chunks big enough to be worth handing out
+   * @param count the number of loop iterations
+   * @param min_grain_size the fewest iterations worth running as one chunk
+   * @return the iterations per chunk
+   */
+  size_t CalculateGrainSize(size_t count, size_t min_grain_size) const;
+
+  /**
+   * Gets how many times a thread has taken chunks from another thread's share
+   * @return the number of steals since the pool was created
+   */
+  size_t GetNumSteals() const;
+
+ private:
+  // How many chunks CalculateGrainSize aims to give each thread
+  static const size_t kChunksPerThread = 8;
+
+  typedef void (*ChunkFunction)(const void* task, size_t begin, size_t end,
+                                size_t thread);
+
+  /**
+   * The chunks a thread has left, packed as first << 32 | end so the owner
+   * taking from the front and thieves taking from the back never both win.
+   * Padded so that threads updating their own shares don't share cache lines.
+   */
+  struct ChunkShare {
+    std::atomic<uint64_t> chunks;
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  /**
+   * Calls a task of a known type through the type-erased job
+   */
+  template <typename Task>
+  static void CallTask(const void* task, size_t begin, size_t end,
+                       size_t thread);
+
+  /**
+   * Hands the job to the workers, runs chunks on the calling thread until
+   * none are left, then waits for the workers to finish theirs
+   */
+  void Run(size_t count, size_t grain_size, ChunkFunction function,
+           const void* task);
+
+  /**
+   * Sleeps until a job is posted, runs its chunks, and repeats until the pool
+   * is stopped
+   * @param thread the index of the worker's share
+   * @param generation the number of jobs posted before the worker started
+   */
+  void WorkerLoop(size_t thread, size_t generation);
+
+  /**
+   * Runs chunks from the thread's own share, then stolen ones, until every
+   * share is empty
+   */
+  void RunChunks(size_t thread);
+
+  /**
+   * Takes the first chunk of a thread's own share
+   * @return whether there was a chunk to take
+   */
+  bool TakeChunk(size_t thread, size_t* chunk);
+
+  /**
+   * Moves the back half of another thread's share into this thread's share
+   * and takes the first chunk of it
+   * @return whether any thread had chunks left
+   */
+  bool StealChunk(size_t thread, size_t* chunk);
+
+  /**
+   * Stops the workers and waits for them to exit
+   */
+  void StopWorkers();
+
+  size_t num_threads_;
+  std::unique_ptr<ChunkShare[]> shares_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> num_steals_;
+
+  // The job being run, written under mutex_ before generation_ moves on
+  std::mutex mutex_;
+  std::condition_variable job_posted_;
+  std::condition_variable job_finished_;
+  size_t generation_;
+  size_t num_busy_workers_;
+  bool is_stopping_;
+  ChunkFunction function_;
+  const void* task_;
+  size_t count_;
+  size_t grain_size_;
+};
+
+template <typename Task>
+void WorkStealingPool::ParallelFor(size_t count, size_t grain_size,
+                                   const Task& task) {
+  Run(count, grain_size, &CallTask<Task>, &task);
+}
+
+template <typename Task>
+void WorkStealingPool::RunTasks(size_t num_tasks, const Task& task) {
+  ParallelFor(num_tasks, 1, [&task](size_t begin, size_t end, size_t) {
+    for (size_t index = begin; index < end; ++index) {
+      task(index);
+    }
+  });
+}
+
+template <typename Task>
+void WorkStealingPool::CallTask(const void* task, size_t begin, size_t end,
+                                size_t thread) {
+  (*static_cast<const Task*>(task))(begin, end, thread);
+}
+
+}  // namespace idealgas
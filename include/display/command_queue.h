@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "display/gas_container.h"
+#include "display/simulation_command.h"
+
+namespace idealgas {
+
+/**
+ * A fixed-size lock-free queue carrying commands from one producer thread,
+ * such as the UI, to the one thread that steps the container. Neither side
+ * ever takes a lock or allocates after construction, so the stepping loop can
+ * drain it at every step boundary at no cost when it is empty.
+ */
+class CommandQueue {
+ public:
+  /**
+   * Creates an empty queue
+   * @param capacity the most commands that can wait at once, rounded up to a
+   * power of two
+   */
+  explicit CommandQueue(size_t capacity);
+
+  CommandQueue(const CommandQueue&) = delete;
+
+  CommandQueue& operator=(const CommandQueue&) = delete;
+
+  /**
+   * Adds a command to the back of the queue. Only the producer thread may
+   * call this.
+   * @param command the command to add
+   * @return false if the queue was full and the command was dropped
+   */
+  bool TryPush(const SimulationCommand& command);
+
+  /**
+   * Takes the command at the front of the queue. Only the consumer thread may
+   * call this.
+   * @param command set to the command that was taken
+   * @return false if the queue was empty
+   */
+  bool TryPop(SimulationCommand* command);
+
+  /**
+   * Applies every waiting command to a container in the order they were
+   * pushed. Only the consumer thread may call this.
+   * @param container the container to change
+   * @return the number of commands applied
+   */
+  size_t DrainInto(GasContainer* container);
+
+  size_t GetCapacity() const;
+
+ private:
+  /**
+   * A queue index padded out to a cache line so the two threads don't contend
+   */
+  struct PaddedIndex {
+    std::atomic<size_t> value;
+    char padding[64 - sizeof(std::atomic<size_t>)];
+  };
+
+  std::vector<SimulationCommand> commands_;
+  size_t index_mask_;
+
+  // Only the consumer moves the head and only the producer moves the tail
+  PaddedIndex head_;
+  PaddedIndex tail_;
+};
+
+}  // namespace idealgas
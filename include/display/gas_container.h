@@ -1,17 +1,76 @@
 #pragma once
 
-#include "cinder/gl/gl.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "components/color.h"
+#include "components/frame_profiler.h"
 #include "components/particle.h"
+#include "components/particle_ids.h"
+#include "components/particle_range.h"
+#include "components/particle_store.h"
+#include "components/particle_view.h"
+#include "components/slot_index.h"
+#include "components/trace_recorder.h"
+#include "components/work_stealing_pool.h"
+#include "physics/aabb_tree.h"
 #include "physics/collision_physics.h"
+#include "physics/event_driven_engine.h"
+#include "physics/morton_order.h"
+#include "physics/parallel_collision_resolver.h"
+#include "physics/sweep_and_prune.h"
+#include "physics/uniform_grid.h"
+#include "physics/verlet_neighbour_list.h"
 
 namespace idealgas {
 
+/**
+ * The ways a container can move its particles forward in time
+ */
+enum class SteppingMode {
+  // Move every particle by its velocity, then resolve any overlaps
+  kFixedStep,
+  // Jump between exactly timed collisions, sampling positions once per frame
+  kEventDriven
+};
+
+/**
+ * The ways a fixed step container can find the pairs of particles that might
+ * be touching
+ */
+enum class BroadPhase {
+  // Bin every particle into a fresh grid each frame
+  kUniformGrid,
+  // Keep each particle's nearby particles in a list, rebuilt only once some
+  // particle has moved more than half the skin distance
+  kVerletList,
+  // Keep the particles sorted along x and pair up overlapping intervals
+  kSweepAndPrune,
+  // Keep a tree of bounding boxes, refitted to the particles each frame
+  kAabbTree,
+  // Use the grid, or the tree once the particle sizes are too far apart for
+  // cells sized to the largest particle to suit the smallest
+  kAutomatic
+};
+
 /**
  * The container in which all of the gas particles are contained. This class
  * stores all of the particles and updates them on each frame of the simulation.
+ * Particle state lives in a ParticleStore owned by the container; the Particle
+ * objects handed out by GetParticles are views onto that store. Views and
+ * slots follow whichever particle is in a slot, which changes as particles are
+ * removed or reordered, so callers that need to keep hold of one particle keep
+ * its id instead.
  */
 class GasContainer {
  public:
+  // How many times the largest particle radius must exceed the smallest for
+  // the automatic broad phase to use the tree
+  static const float kTreeRadiusRatio;
+  // How many times further apart than just after sorting the particles in
+  // neighbouring slots may drift before they are sorted again early
+  static const float kReorderSpreadRatio;
+
   /**
    * Initializes a container for particles to exist within and generates the
    * starting conditions for the container given a specific set of parameters
@@ -34,13 +93,26 @@ class GasContainer {
                size_t num_rand_particles, const glm::vec2& top_left_corner,
                const glm::vec2& bottom_right_corner,
                float default_particle_radius, float default_particle_mass,
-               const ci::Color& default_particle_color);
+               const Color& default_particle_color);
 
   /**
    * A default constructor as required by the Ideal Gas class
    */
   GasContainer();
 
+  /**
+   * Copies a container, pointing the copied particle views at the new store
+   * @param other the container to copy
+   */
+  GasContainer(const GasContainer& other);
+
+  /**
+   * Copies a container, pointing the copied particle views at the new store
+   * @param other the container to copy
+   * @return this container
+   */
+  GasContainer& operator=(const GasContainer& other);
+
   /**
    * A deconstructor to deallocate the memory that was utilized
    */
@@ -48,15 +120,91 @@ class GasContainer {
 
   /**
    * Displays the container walls and the current positions of the particles.
+   * Defined in gas_container_display.cc, which only the Cinder targets build.
    */
   void Display() const;
 
+  /**
+   * Displays the container walls around a snapshot of its particles taken
+   * elsewhere, such as one published by a SimulationThread
+   * @param snapshot the particles to draw
+   */
+  void Display(const ParticleStore& snapshot) const;
+
   /**
    * Updates the positions and velocities of all particles (based on the rules
    * described in the assignment documentation).
    */
   void AdvanceOneFrame();
 
+  /**
+   * Chooses how AdvanceOneFrame moves the particles
+   * @param mode fixed frame steps, or exact event-driven collisions
+   */
+  void SetSteppingMode(SteppingMode mode);
+
+  SteppingMode GetSteppingMode() const;
+
+  /**
+   * Chooses how fixed steps find the pairs of particles to test. Every broad
+   * phase resolves exactly the same collisions.
+   * @param broad_phase a grid rebuilt each frame, Verlet neighbour lists,
+   * sweep and prune, a bounding box tree, or automatic, which is the default
+   */
+  void SetBroadPhase(BroadPhase broad_phase);
+
+  BroadPhase GetBroadPhase() const;
+
+  /**
+   * Gets the broad phase the next frame will use, which for the automatic
+   * broad phase depends on the particles in the container
+   * @return any broad phase but automatic
+   */
+  BroadPhase GetActiveBroadPhase() const;
+
+  /**
+   * Sets how far past touching the Verlet lists look. A larger skin rebuilds
+   * the lists less often but tests more pairs each frame.
+   * @param skin the extra distance between particle edges, at least zero
+   */
+  void SetNeighbourSkin(float skin);
+
+  float GetNeighbourSkin() const;
+
+  /**
+   * Sets how often the particles are re-sorted along a Z-order curve so
+   * particles close in space stay close in memory. Every few frames they are
+   * also checked for having drifted far further out of order than when they
+   * were last sorted or the interval was set, and re-sorted early if so.
+   * Sorting changes the order collisions are resolved in, so it is off by
+   * default.
+   * @param num_frames the most frames between sorts, or zero to never sort
+   */
+  void SetReorderInterval(size_t num_frames);
+
+  size_t GetReorderInterval() const;
+
+  /**
+   * Sorts the particles along a Z-order curve through the container straight
+   * away, moving them to new slots while keeping their ids
+   */
+  void ReorderParticles();
+
+  /**
+   * Gets the id of the particle in a slot, which stays with the particle
+   * until it is removed however its slot changes
+   * @param slot the slot of the particle
+   * @return the particle's id
+   */
+  size_t GetParticleId(size_t slot) const;
+
+  /**
+   * Gets the slot a particle is currently stored in
+   * @param id the id of the particle
+   * @return the particle's slot, or ParticleIds::kNoSlot if it was removed
+   */
+  size_t GetParticleSlot(size_t id) const;
+
   /**
    * Updates the velocity of all of the particles according to a global
    * velocity change
@@ -68,19 +216,76 @@ class GasContainer {
                             bool should_increase_speed);
 
   /**
-   * Adds a specific particle configuration to the container
+   * Adds a specific particle configuration to the container. The particle's
+   * state is copied into the container's store.
    * @param particle the particle configuration to add to the container
    */
   void AddParticleToContainer(Particle* particle);
 
-  std::vector<Particle*> GetParticles();
+  /**
+   * Adds a specific particle configuration to the container. The particle's
+   * state is copied into the container's store, so the caller can keep the
+   * particle on the stack rather than allocating it.
+   * @param particle the particle configuration to add to the container
+   */
+  void AddParticleToContainer(const Particle& particle);
+
+  /**
+   * Removes a particle from the container. The last particle in the container
+   * moves into the freed slot, which the next added particle reuses.
+   * @param slot the slot of the particle to remove
+   */
+  void RemoveParticle(size_t slot);
 
   /**
-   * Gets all of the particles in the container by a color filter
+   * Removes every particle from the container at once while keeping the
+   * memory the particles used, so refilling the container doesn't allocate
+   */
+  void ClearParticles();
+
+  /**
+   * Sets how many threads the wall, grid rebuild and particle collision stages
+   * run on. The threads are started here and kept for every later frame. Any
+   * thread count gives exactly the same velocities as a single thread.
+   * @param num_threads the number of threads, at least one
+   */
+  void SetNumThreads(size_t num_threads);
+
+  size_t GetNumThreads() const;
+
+  /**
+   * Gets every particle in the container without copying them
+   * @return a view of the particles in slot order, valid until particles are
+   * added or removed
+   */
+  ParticleRange GetParticles();
+
+  const ParticleStore& GetParticleStore() const;
+
+  /**
+   * Gets the phase timings and counts of the frames advanced so far, which are
+   * only recorded when the build defines IDEALGAS_PROFILING
+   * @return the container's profiler
+   */
+  const FrameProfiler& GetProfiler() const;
+
+  /**
+   * Gets all of the particles in the container by a color filter, read from an
+   * index kept up to date as particles are added and removed
    * @param color the color to filter by
-   * @return all of the particles in the container with specified color
+   * @return a view of the particles with the specified color, valid until
+   * particles are added or removed
+   */
+  ParticleRange GetParticlesByColor(const Color& color);
+
+  /**
+   * Gets all of the particles in the container of a single species, read from
+   * an index kept up to date as particles are added and removed
+   * @param species the id of the species in the container's store
+   * @return a view of the particles of that species, valid until particles are
+   * added or removed
    */
-  std::vector<Particle*> GetParticlesByColor(const ci::Color& color);
+  ParticleRange GetParticlesBySpecies(SpeciesId species);
 
  private:
   /**
@@ -112,6 +317,19 @@ class GasContainer {
    */
   void AddParticleToContainer(const glm::vec2& new_position);
 
+  /**
+   * Points one view at each slot of this container's store, used after the
+   * store has been copied from another container
+   */
+  void RebindParticleViews();
+
+  /**
+   * Gives a particle just added to the store its view and its place in the
+   * species and color indexes
+   * @param slot the slot the particle was stored in
+   */
+  void TrackAddedParticle(size_t slot);
+
   /**
    * Generates a random number in between a min and max value
    * @param min the minimum value the number can be
@@ -120,28 +338,89 @@ class GasContainer {
    */
   float GenerateRandomNumber(float min, float max) const;
 
+  /**
+   * Advances one frame by moving every particle by its velocity, after
+   * resolving the wall and particle collisions it starts the frame in
+   */
+  void AdvanceFixedStep();
+
+  /**
+   * Advances one frame by jumping between exactly timed collisions
+   */
+  void AdvanceEventDriven();
+
   /**
    * Determines what particles during a frame have collided with the wall and
-   * updates their velocities correspondingly
-   * @param particles the current state of all of the particles within the
-   * container
+   * updates their velocities correspondingly, a whole axis at a time
    */
   void DetermineWallCollisions();
 
   /**
-   * Determines what particles during a frame have collided with each other
-   * @param particles the current state of all of the particles within the
-   * container
+   * Determines what particles during a frame have collided with each other.
+   * Only the candidate pairs from the broad phase are tested, visited in the
+   * same order as checking every pair so the resolved collisions are
+   * identical.
    */
   void DetermineParticleCollisions();
 
-  std::vector<Particle*> particles_;
+  /**
+   * Tests and resolves every candidate pair from a broad phase that is up to
+   * date with the particles' positions. With more than one thread the work is
+   * handed to the parallel collision resolver.
+   * @param neighbour_source a UniformGrid, VerletNeighbourList, SweepAndPrune
+   * or AabbTree
+   */
+  template <typename NeighbourSource>
+  void CollideNeighbours(const NeighbourSource& neighbour_source);
+
+  /**
+   * Bounces two particles off each other if they are touching and approaching
+   * @param slot1 the slot of the first particle
+   * @param slot2 the slot of the second particle, after the first
+   */
+  void CollideParticles(size_t slot1, size_t slot2);
+
+  /**
+   * Points every stage that splits its work across threads at the
+   * container's task pool, sizing their per-thread buffers to match it
+   */
+  void ShareTaskPool();
+
+  ParticleStore store_;
+  std::vector<ParticleView> particle_views_;
+  // Slots by species and by color; species sharing a color are indexed under
+  // the id of the first of them, which color_groups_ maps each species to
+  SlotIndex species_index_;
+  SlotIndex color_index_;
+  std::vector<SpeciesId> color_groups_;
   glm::vec2 top_left_corner_;
   glm::vec2 bottom_right_corner_;
   float default_particle_radius_;
   float default_particle_mass_;
-  ci::Color default_particle_color_;
+  Color default_particle_color_;
   CollisionPhysics physics_;
+  BroadPhase broad_phase_ = BroadPhase::kAutomatic;
+  // Shared by every stage of a frame, so its threads are only started when
+  // the thread count changes
+  WorkStealingPool task_pool_;
+  // Wall bounces counted by each thread of the task pool
+  std::vector<size_t> thread_wall_bounces_;
+  UniformGrid grid_;
+  VerletNeighbourList neighbour_list_;
+  SweepAndPrune sweep_and_prune_;
+  AabbTree aabb_tree_;
+  std::vector<size_t> collision_candidates_;
+  ParallelCollisionResolver collision_resolver_;
+  ParticleIds particle_ids_;
+  size_t reorder_interval_ = 0;
+  size_t frames_since_reorder_ = 0;
+  float sorted_spread_ = 0;
+  MortonOrder morton_order_;
+  // The store the particles are gathered into when sorting, then swapped in
+  ParticleStore reordered_store_;
+  SteppingMode stepping_mode_ = SteppingMode::kFixedStep;
+  EventDrivenEngine event_engine_;
+  FrameProfiler profiler_;
 };
 
 }  // namespace idealgas
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <components/frame_profiler.h>
 #include <components/histogram.h>
+#include <components/species_speed_bins.h>
+#include <components/trace_recorder.h>
+
+#include <deque>
+#include <memory>
 
 #include "cinder/app/App.h"
 #include "cinder/app/RendererGl.h"
 #include "cinder/gl/gl.h"
 #include "gas_container.h"
+#include "simulation_thread.h"
 
 namespace idealgas {
 
@@ -31,7 +38,8 @@ class IdealGasApp : public ci::app::App {
   void update() override;
 
   /**
-   * Listens for user input and passes on events to the container
+   * Listens for user input and passes on events to the container, toggles the
+   * profiler overlay on p, or starts recording a trace on t
    * @param event the keyboard event triggered by the user
    */
   void keyDown(ci::app::KeyEvent event) override;
@@ -45,15 +53,56 @@ class IdealGasApp : public ci::app::App {
   const float kDefaultParticleRadius = 3.0;
   const float kDefaultParticleMass = 1.0;
   const ci::Color kDefaultParticleColor = ci::Color("orange");
+  const float kStepsPerSecond = 60.0f;
+  const size_t kTraceFrames = 300;
+  const char* const kTraceFileName = "idealgas_trace.json";
+
+  Particle GenerateParticle(const glm::vec2& position,
+                            const glm::vec2& velocity, const ci::Color& color,
+                            float radius, float mass);
 
-  Particle* GenerateParticle(const glm::vec2& position,
-                             const glm::vec2& velocity, const ci::Color& color,
-                             float radius, float mass);
+  /**
+   * Sends a command to the simulation thread, holding it back to retry on the
+   * next update if the command queue is full so no input is lost. Commands
+   * are always delivered in the order they were posted.
+   * @param command the command to send
+   */
+  void PostCommand(const SimulationCommand& command);
+
+  /**
+   * Sends as many of the held back commands as the command queue has room
+   * for, oldest first
+   */
+  void RetryUnpostedCommands();
+
+  /**
+   * Draws the rolling frame timings and counts in the corner of the window
+   */
+  void DrawProfilerOverlay() const;
+
+  /**
+   * Writes the recorded trace to kTraceFileName once its window of frames has
+   * finished
+   */
+  void WriteFinishedTrace();
 
+  // The UI's copy of the container, only used for its walls once the
+  // simulation thread has taken its own copy to step
   GasContainer container_;
+  std::unique_ptr<SimulationThread> simulation_;
+  // Commands the full command queue turned away, waiting to be sent again
+  std::deque<SimulationCommand> unposted_commands_;
   Histogram blue_histogram_;
   Histogram orange_histogram_;
   Histogram white_histogram_;
+  SpeciesSpeedBins species_bins_;
+  size_t blue_species_;
+  size_t orange_species_;
+  size_t white_species_;
+  // Each UI frame records the newest simulation step plus the histogram work
+  FrameProfiler profiler_;
+  bool is_profiler_shown_ = false;
+  bool is_trace_pending_ = false;
   Particle blue_particle_ =
       Particle(glm::vec2(550, 550), glm::vec2(-3, -1), ci::Color("blue"), 3, 5);
   Particle orange_particle_ = Particle(glm::vec2(550, 550), glm::vec2(-2, -2),
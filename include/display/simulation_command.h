@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "components/color.h"
+#include "components/particle.h"
+#include "display/gas_container.h"
+
+namespace idealgas {
+
+/**
+ * A change to a running simulation, sent from the UI and applied by whichever
+ * thread steps the container, always between two steps. Commands are plain
+ * values so they can be passed through a CommandQueue without allocating.
+ */
+struct SimulationCommand {
+  /**
+   * The kinds of change a command can make
+   */
+  enum class Type {
+    kModifySpeed,
+    kAddParticle,
+    kRemoveParticle,
+    kClearParticles,
+    kSetNumThreads,
+    kSetSteppingMode
+  };
+
+  /**
+   * Creates a command that speeds up or slows down every particle
+   * @param delta_velocity the amount to change all of the velocities by
+   * @param should_increase_speed whether the velocities should grow or shrink
+   * @return the command
+   */
+  static SimulationCommand ModifySpeed(const glm::vec2& delta_velocity,
+                                       bool should_increase_speed);
+
+  /**
+   * Creates a command that copies a particle into the container
+   * @param particle the particle configuration to add
+   * @return the command
+   */
+  static SimulationCommand AddParticle(const Particle& particle);
+
+  /**
+   * Creates a command that removes a particle, which is ignored if the
+   * particle is already gone by the time the command is applied. Particles are
+   * named by their stable id, since their slots move whenever another particle
+   * is removed or the store is reordered.
+   * @param particle_id the id of the particle to remove
+   * @return the command
+   */
+  static SimulationCommand RemoveParticle(size_t particle_id);
+
+  /**
+   * Creates a command that removes every particle
+   * @return the command
+   */
+  static SimulationCommand ClearParticles();
+
+  /**
+   * Creates a command that changes how many threads resolve collisions
+   * @param num_threads the number of threads, at least one
+   * @return the command
+   */
+  static SimulationCommand SetNumThreads(size_t num_threads);
+
+  /**
+   * Creates a command that changes how the container moves its particles
+   * @param mode the new stepping mode
+   * @return the command
+   */
+  static SimulationCommand SetSteppingMode(SteppingMode mode);
+
+  /**
+   * Makes the change this command describes
+   * @param container the container being simulated
+   */
+  void ApplyTo(GasContainer* container) const;
+
+  Type type = Type::kClearParticles;
+
+  // Only the fields used by the command's type are set
+  glm::vec2 position;
+  glm::vec2 velocity;
+  Color color;
+  float radius = 0;
+  float mass = 0;
+  bool should_increase_speed = false;
+  size_t particle_id = 0;
+  size_t num_threads = 1;
+  SteppingMode stepping_mode = SteppingMode::kFixedStep;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+
+#include "components/frame_profiler.h"
+#include "components/particle_store.h"
+#include "display/command_queue.h"
+#include "display/gas_container.h"
+#include "display/simulation_command.h"
+
+namespace idealgas {
+
+/**
+ * Steps a GasContainer on its own thread at a target rate, independent of how
+ * often the UI updates or draws. After every step the particles are published
+ * through a triple buffer: the simulation always has a buffer to write into
+ * and the UI always has a complete one to read, so neither ever waits on the
+ * other and a drawn frame never mixes two steps.
+ */
+class SimulationThread {
+ public:
+  /**
+   * Takes a copy of a container to simulate, without starting the thread
+   * @param container the container to simulate
+   * @param steps_per_second how many frames to advance each second, or zero to
+   * advance as fast as possible
+   */
+  SimulationThread(const GasContainer& container, float steps_per_second);
+
+  /**
+   * Stops the thread if it is still running
+   */
+  ~SimulationThread();
+
+  SimulationThread(const SimulationThread&) = delete;
+
+  SimulationThread& operator=(const SimulationThread&) = delete;
+
+  /**
+   * Starts stepping the container on the simulation thread
+   */
+  void Start();
+
+  /**
+   * Stops stepping the container, waiting for the step in progress to finish
+   */
+  void Stop();
+
+  bool IsRunning() const;
+
+  /**
+   * Changes how many frames the simulation advances each second
+   * @param steps_per_second the new rate, or zero to run as fast as possible
+   */
+  void SetTargetRate(float steps_per_second);
+
+  float GetTargetRate() const;
+
+  /**
+   * Queues a change to the container, applied by the simulation thread before
+   * its next step. Only one thread, normally the UI, may post commands.
+   * @param command the change to make to the container
+   * @return false if too many commands were already waiting and this one was
+   * dropped
+   */
+  bool Post(const SimulationCommand& command);
+
+  /**
+   * Swaps in the newest published snapshot if there is one. Only the UI
+   * thread may call this.
+   * @return the particles as of the newest published step
+   */
+  const ParticleStore& AcquireSnapshot();
+
+  /**
+   * Gets the snapshot taken by the last AcquireSnapshot without looking for a
+   * newer one, so several readers in one UI frame see the same particles
+   * @return the particles as of the acquired step
+   */
+  const ParticleStore& GetSnapshot() const;
+
+  /**
+   * Gets which step the current snapshot was published after
+   * @return the number of frames advanced before the snapshot was taken
+   */
+  size_t GetSnapshotStep() const;
+
+  /**
+   * Gets the phase timings and counts of the step the current snapshot was
+   * published after
+   * @return the profile of that step, all zero unless profiling is built in
+   */
+  const FrameProfile& GetSnapshotProfile() const;
+
+  /**
+   * Gets the number of frames advanced so far, safe to call from any thread
+   * @return the number of frames advanced
+   */
+  size_t GetNumStepsTaken() const;
+
+ private:
+  static const size_t kCommandQueueCapacity = 1024;
+
+  // Marks the shared buffer as published but not yet acquired
+  static const unsigned kFreshBit = 4;
+  static const unsigned kIndexMask = 3;
+
+  /**
+   * The loop run by the simulation thread
+   */
+  void Run();
+
+  /**
+   * Copies the container's particles into the back buffer and swaps it with
+   * the shared buffer
+   */
+  void Publish();
+
+  GasContainer container_;
+  std::thread thread_;
+  std::atomic<bool> is_running_;
+  std::atomic<float> steps_per_second_;
+  std::atomic<size_t> num_steps_taken_;
+
+  CommandQueue commands_;
+
+  ParticleStore buffers_[3];
+  size_t buffer_steps_[3];
+  FrameProfile buffer_profiles_[3];
+  // Only the simulation thread touches the back buffer and only the UI thread
+  // touches the front buffer; the shared index says which buffer is between
+  std::atomic<unsigned> shared_buffer_;
+  unsigned back_buffer_;
+  unsigned front_buffer_;
+};
+
+}  // namespace idealgas
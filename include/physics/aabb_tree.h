@@ -0,0 +1,143 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "components/particle_store.h"
+#include "physics/candidate_pairs.h"
+
+namespace idealgas {
+
+/**
+ * A bounding volume hierarchy broad phase over the particles' axis aligned
+ * bounding boxes. Every box is as big as its own particle, so a mix of very
+ * small and very large particles doesn't crowd the small ones into cells
+ * sized for the large ones. The tree is split at the median along its longer
+ * side when built, and each frame only the boxes are refitted bottom up; the
+ * tree is rebuilt once the refitted boxes have grown too loose. The
+ * overlapping pairs are then found in one pass over the tree against itself.
+ */
+class AabbTree {
+ public:
+  /**
+   * Creates a tree with no particles
+   */
+  AabbTree();
+
+  /**
+   * Refits the tree to the particles' current positions, rebuilding it if it
+   * was invalidated or has grown too loose, and finds every pair of particles
+   * whose boxes overlap
+   * @param store the particles to bound, in container order
+   * @return whether the tree was rebuilt
+   */
+  bool Update(const ParticleStore& store);
+
+  /**
+   * Forces the next Update to rebuild, used whenever particles are added or
+   * removed
+   */
+  void Invalidate();
+
+  /**
+   * Collects the particles whose boxes overlapped the given particle's box at
+   * the last Update and that come after it in container order
+   * @param particle_idx the container index of the particle
+   * @param candidates filled with the candidate indices in ascending order
+   */
+  void GatherNeighbourCandidates(size_t particle_idx,
+                                 std::vector<size_t>* candidates) const;
+
+  /**
+   * Gets how many times the tree has been built from scratch
+   * @return the number of rebuilds since the tree was created
+   */
+  size_t GetNumRebuilds() const;
+
+  size_t GetNumNodes() const;
+
+  /**
+   * Gets how many overlapping pairs the last Update found
+   * @return the number of candidate pairs
+   */
+  size_t GetNumPairs() const;
+
+ private:
+  /**
+   * A box around either a few particles, for a leaf, or two child nodes. The
+   * left child always directly follows its parent.
+   */
+  struct Node {
+    float min_x;
+    float min_y;
+    float max_x;
+    float max_y;
+    // Leaves own leaf_slots_[first, first + count), inner nodes have no count
+    size_t first;
+    size_t count;
+    size_t right_child;
+  };
+
+  /**
+   * Builds the subtree over a run of leaf_slots_, appending its nodes
+   * @param first the first entry of leaf_slots_ in the subtree
+   * @param count the number of particles in the subtree
+   * @return the index of the subtree's root node
+   */
+  size_t BuildNode(size_t first, size_t count);
+
+  /**
+   * Recomputes every node's box from its particles or children
+   * @return the total area of the inner nodes, which grows as the tree loosens
+   */
+  float Refit();
+
+  /**
+   * Collects every pair of particles whose boxes overlap into pairs_
+   */
+  void FindOverlappingPairs();
+
+  /**
+   * Collects the overlapping pairs with one particle under each node of the
+   * node pairs on node_pair_stack_, emptying the stack
+   */
+  void FindPairsBetweenSubtrees();
+
+  /**
+   * Adds two particles to pairs_ if their boxes overlap
+   */
+  void AddPairIfOverlapping(size_t slot1, size_t slot2);
+
+  /**
+   * Copies each particle's padded box out of the store
+   */
+  void UpdateParticleBoxes(const ParticleStore& store);
+
+  /**
+   * Checks whether two boxes overlap
+   */
+  static bool DoBoxesOverlap(float min_x1, float min_y1, float max_x1,
+                             float max_y1, float min_x2, float min_y2,
+                             float max_x2, float max_y2);
+
+  // Particles per leaf
+  static const size_t kLeafSize = 4;
+  // How much the inner nodes' total area may grow before rebuilding
+  static const float kRebuildAreaRatio;
+
+  bool is_valid_;
+  size_t num_rebuilds_;
+  float built_area_;
+  std::vector<Node> nodes_;
+  std::vector<size_t> leaf_slots_;
+  std::vector<std::pair<size_t, size_t>> node_pair_stack_;
+  CandidatePairs pairs_;
+
+  // Each particle's padded box, by slot
+  std::vector<float> min_xs_;
+  std::vector<float> min_ys_;
+  std::vector<float> max_xs_;
+  std::vector<float> max_ys_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace idealgas {
+
+/**
+ * The pairs of particles a broad phase found might be touching, grouped by
+ * their first particle so each particle's candidates can be read back in the
+ * order the all-pairs loop would visit them
+ */
+class CandidatePairs {
+ public:
+  /**
+   * Creates an empty set of pairs
+   */
+  CandidatePairs();
+
+  /**
+   * Removes every pair, keeping their memory
+   */
+  void Clear();
+
+  /**
+   * Adds a pair, which is listed under whichever particle comes first
+   * @param slot1 the slot of one particle
+   * @param slot2 the slot of the other particle
+   */
+  void Add(size_t slot1, size_t slot2);
+
+  /**
+   * Groups the pairs added since the last Clear, which must be done before
+   * they can be read
+   * @param num_particles the number of particles in the store
+   */
+  void Group(size_t num_particles);
+
+  /**
+   * Collects the particles paired with the given particle that come after it
+   * in container order
+   * @param particle_idx the container index of the particle
+   * @param candidates filled with the candidate indices in ascending order
+   */
+  void GatherNeighbourCandidates(size_t particle_idx,
+                                 std::vector<size_t>* candidates) const;
+
+  size_t Size() const;
+
+ private:
+  std::vector<std::pair<size_t, size_t>> pairs_;
+
+  // Particle p's candidates are candidates_[candidate_starts_[p],
+  // candidate_starts_[p + 1])
+  std::vector<size_t> candidate_starts_;
+  std::vector<size_t> candidate_fill_;
+  std::vector<size_t> candidates_;
+};
+
+}  // namespace idealgas
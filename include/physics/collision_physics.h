@@ -1,7 +1,10 @@
 #pragma once
 
-#include "cinder/gl/gl.h"
+#include <glm/glm.hpp>
+
 #include "components/particle.h"
+#include "components/particle_store.h"
+#include "physics/wall_collision_kernel.h"
 
 namespace idealgas {
 
@@ -40,6 +43,38 @@ class CollisionPhysics {
    */
   void UpdateCollidedParticleVelocities(Particle* particle1,
                                         Particle* particle2);
+
+  /**
+   * Calculates whether two particles in a store are touching and moving toward
+   * each other, reading the store arrays directly
+   * @param store the store holding both particles
+   * @param slot1 the slot of the first particle
+   * @param slot2 the slot of the second particle
+   * @return true if particles are touching, else false
+   */
+  bool DidParticlesCollide(const ParticleStore& store, size_t slot1,
+                           size_t slot2) const;
+
+  /**
+   * Calculates whether two particles in a store overlap, ignoring how they are
+   * moving
+   * @param store the store holding both particles
+   * @param slot1 the slot of the first particle
+   * @param slot2 the slot of the second particle
+   * @return true if the particles' circles overlap, else false
+   */
+  bool AreParticlesTouching(const ParticleStore& store, size_t slot1,
+                            size_t slot2) const;
+
+  /**
+   * Calculates and updates the velocities for two collided particles in a
+   * store
+   * @param store the store holding both particles
+   * @param slot1 the slot of the first particle that collided
+   * @param slot2 the slot of the second particle that collided
+   */
+  void UpdateCollidedParticleVelocities(ParticleStore* store, size_t slot1,
+                                        size_t slot2) const;
   /**
    * Determines if a particle is colliding the top wall of the container
    * @param particle the particle in the container
@@ -47,6 +82,14 @@ class CollisionPhysics {
    */
   bool IsParticleCollidingWithTopWall(const Particle& particle) const;
 
+  /**
+   * Determines if a particle is colliding the top wall of the container from
+   * its raw y coordinate, y velocity and radius
+   * @return true if the particle is touching the top wall, else false
+   */
+  bool IsParticleCollidingWithTopWall(float y_pos, float y_velocity,
+                                      float radius) const;
+
   /**
    * Determines if a particle is colliding the left wall of the container
    * @param particle the particle in the container
@@ -54,6 +97,14 @@ class CollisionPhysics {
    */
   bool IsParticleCollidingWithLeftWall(const Particle& particle) const;
 
+  /**
+   * Determines if a particle is colliding the left wall of the container from
+   * its raw x coordinate, x velocity and radius
+   * @return true if the particle is touching the left wall, else false
+   */
+  bool IsParticleCollidingWithLeftWall(float x_pos, float x_velocity,
+                                       float radius) const;
+
   /**
    * Determines if a particle is colliding the right wall of the container
    * @param particle the particle in the container
@@ -61,6 +112,14 @@ class CollisionPhysics {
    */
   bool IsParticleCollidingWithRightWall(const Particle& particle) const;
 
+  /**
+   * Determines if a particle is colliding the right wall of the container from
+   * its raw x coordinate, x velocity and radius
+   * @return true if the particle is touching the right wall, else false
+   */
+  bool IsParticleCollidingWithRightWall(float x_pos, float x_velocity,
+                                        float radius) const;
+
   /**
    * Determines if a particle is colliding the bottom wall of the container
    * @param particle the particle in the container
@@ -68,10 +127,38 @@ class CollisionPhysics {
    */
   bool IsParticleCollidingWithBottomWall(const Particle& particle) const;
 
+  /**
+   * Determines if a particle is colliding the bottom wall of the container from
+   * its raw y coordinate, y velocity and radius
+   * @return true if the particle is touching the bottom wall, else false
+   */
+  bool IsParticleCollidingWithBottomWall(float y_pos, float y_velocity,
+                                         float radius) const;
+
+  /**
+   * Reflects every particle in a store that is colliding with any wall, giving
+   * the same velocities as the four per-particle wall checks
+   * @param store the particles in the container
+   * @return the number of wall bounces, counting a corner bounce twice
+   */
+  size_t ReflectWallCollisions(ParticleStore* store) const;
+
+  /**
+   * Reflects the particles in a run of slots that are colliding with any wall,
+   * so separate runs can be reflected on separate threads
+   * @param store the particles in the container
+   * @param begin the first slot to reflect
+   * @param end one past the last slot to reflect
+   * @return the number of wall bounces, counting a corner bounce twice
+   */
+  size_t ReflectWallCollisions(ParticleStore* store, size_t begin,
+                               size_t end) const;
+
  private:
   float left_wall_;
   float right_wall_;
   float top_wall_;
   float bottom_wall_;
+  WallCollisionKernel wall_kernel_;
 };
 }  // namespace idealgas
\ No newline at end of file
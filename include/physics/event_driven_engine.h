@@ -0,0 +1,196 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "components/particle_store.h"
+#include "physics/collision_physics.h"
+
+namespace idealgas {
+
+/**
+ * Steps hard-sphere particles from collision to collision instead of by fixed
+ * frames. The exact times of upcoming particle-particle collisions, wall
+ * collisions and cell crossings are kept in a priority queue, and events that
+ * a particle's later collision made stale are skipped when they come up.
+ *
+ * Particles are kept in a cell list whose cells span the largest diameter, so
+ * a particle only needs predictions against its neighbouring cells, and only
+ * against the newly neighbouring cells when it crosses into another cell.
+ */
+class EventDrivenEngine {
+ public:
+  /**
+   * Creates an engine for an empty container
+   */
+  EventDrivenEngine();
+
+  /**
+   * Creates an engine for a bounded container
+   * @param top_left_corner the top left corner of the container
+   * @param bottom_right_corner the bottom right corner of the container
+   */
+  EventDrivenEngine(const glm::vec2& top_left_corner,
+                    const glm::vec2& bottom_right_corner);
+
+  /**
+   * Runs every event that happens over a stretch of time and leaves every
+   * particle in the store at its position at the end of it
+   * @param store the particles to step
+   * @param physics the physics used to resolve particle-particle collisions
+   * @param duration how long to simulate, in frames
+   */
+  void Advance(ParticleStore* store, const CollisionPhysics& physics,
+               float duration);
+
+  /**
+   * Drops every predicted event, used whenever particles are added or their
+   * velocities are changed outside the engine
+   */
+  void Invalidate();
+
+  /**
+   * Gets how many collisions have been resolved since the engine was created
+   * @return the number of particle-particle and particle-wall collisions
+   */
+  size_t GetNumCollisions() const;
+
+  /**
+   * Gets how many of the resolved collisions were with a wall
+   * @return the number of particle-wall collisions
+   */
+  size_t GetNumWallBounces() const;
+
+ private:
+  /**
+   * The kinds of event that can happen to a particle
+   */
+  enum EventType {
+    kParticleCollision,
+    kVerticalWall,
+    kHorizontalWall,
+    kColumnCrossing,
+    kRowCrossing
+  };
+
+  /**
+   * A predicted event, only valid while neither particle has collided since it
+   * was predicted
+   */
+  struct Event {
+    double time;
+    EventType type;
+    size_t particle1;
+    size_t particle2;
+    size_t particle1_count;
+    size_t particle2_count;
+
+    /**
+     * Orders events so the queue pops the earliest, breaking ties by particle
+     * so the order never depends on the queue's internals
+     */
+    bool operator>(const Event& other) const;
+  };
+
+  /**
+   * Moves every particle to the current time, rebins them into freshly sized
+   * cells and predicts every particle's next events
+   */
+  void Rebuild(ParticleStore* store);
+
+  /**
+   * Runs every queued event up to a time
+   */
+  void ProcessEvents(ParticleStore* store, const CollisionPhysics& physics,
+                     double end_time);
+
+  /**
+   * Moves a particle into the next column or row along its velocity and
+   * predicts collisions with the particles that just became its neighbours
+   */
+  void CrossCell(const ParticleStore& store, size_t particle, int axis);
+
+  /**
+   * Predicts every event a particle is part of, after its velocity changed
+   */
+  void PredictEvents(const ParticleStore& store, size_t particle);
+
+  /**
+   * Predicts collisions between a particle and every particle in a block of
+   * cells, clamped to the grid
+   */
+  void PredictCellCollisions(const ParticleStore& store, size_t particle,
+                             int first_column, int last_column, int first_row,
+                             int last_row);
+
+  /**
+   * Predicts when two particles will collide and queues it if they will
+   */
+  void PredictParticleCollision(const ParticleStore& store, size_t particle1,
+                                size_t particle2);
+
+  /**
+   * Predicts when a particle will next hit a vertical and a horizontal wall
+   */
+  void PredictWallCollisions(const ParticleStore& store, size_t particle);
+
+  /**
+   * Predicts when a particle will next leave its column or row
+   * @param axis 0 for its column, 1 for its row
+   */
+  void PredictCellCrossing(const ParticleStore& store, size_t particle,
+                           int axis);
+
+  /**
+   * Gets where a particle is at the current time along one axis
+   */
+  double CalculateCurrentPosition(const ParticleStore& store, size_t particle,
+                                  int axis) const;
+
+  /**
+   * Moves a particle along its velocity to the current time
+   */
+  void Drift(ParticleStore* store, size_t particle);
+
+  void AddToCell(size_t particle);
+
+  void RemoveFromCell(size_t particle);
+
+  void PushEvent(const Event& event);
+
+  // Rebuild once the queue holds this many events per particle, most stale
+  static const size_t kMaxEventsPerParticle = 32;
+
+  // Upper bound on columns and rows so tiny radii can't blow up memory
+  static const int kMaxCellsPerAxis = 1024;
+
+  // Ends a cell's list of particles
+  static const size_t kNoParticle = size_t(-1);
+
+  glm::vec2 top_left_corner_;
+  glm::vec2 bottom_right_corner_;
+  bool needs_rebuild_;
+  size_t num_collisions_;
+  size_t num_wall_bounces_;
+  double time_;
+
+  // A min-heap of events, kept in a vector so clearing it keeps its capacity
+  std::vector<Event> events_;
+
+  float cell_size_;
+  int num_cells_[2];
+  // The first particle of each cell's list, or kNoParticle if it is empty
+  std::vector<size_t> cell_heads_;
+
+  // Per particle bookkeeping, indexed by store slot. particle_cells_ holds the
+  // column and row of each particle one after the other. The particles of a
+  // cell are linked through next_in_cell_ and previous_in_cell_, so moving a
+  // particle between cells never allocates.
+  std::vector<double> particle_times_;
+  std::vector<size_t> collision_counts_;
+  std::vector<int> particle_cells_;
+  std::vector<size_t> next_in_cell_;
+  std::vector<size_t> previous_in_cell_;
+};
+
+}  // namespace idealgas
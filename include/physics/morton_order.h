@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+#include "components/particle_store.h"
+
+namespace idealgas {
+
+/**
+ * Sorts particles along a Z-order (Morton) curve through the container. The
+ * curve visits every small square of the container before moving on to the
+ * next, so storing particles in its order keeps particles that are close in
+ * space close in memory, and each collision pass reads its neighbours from
+ * cache lines it has only just loaded.
+ */
+class MortonOrder {
+ public:
+  /**
+   * Creates a sorter with no particles
+   */
+  MortonOrder();
+
+  /**
+   * Works out the order of the particles along the curve
+   * @param store the particles to sort
+   * @param top_left_corner the top left corner of the container
+   * @param bottom_right_corner the bottom right corner of the container
+   * @return the current slot of the particle that belongs in each slot, valid
+   * until the next Sort
+   */
+  const std::vector<size_t>& Sort(const ParticleStore& store,
+                                  const glm::vec2& top_left_corner,
+                                  const glm::vec2& bottom_right_corner);
+
+  /**
+   * Calculates a cell's position along the curve by interleaving the bits of
+   * its column and row
+   * @param column the cell's column
+   * @param row the cell's row
+   * @return the cell's Morton code
+   */
+  static uint32_t CalculateCode(uint16_t column, uint16_t row);
+
+  /**
+   * Calculates how far apart particles in neighbouring slots are on average,
+   * which grows as particles drift away from the order they were sorted in
+   * @param store the particles to measure
+   * @return the mean distance between the particles in each pair of
+   * consecutive slots, or zero for fewer than two particles
+   */
+  static float CalculateSpread(const ParticleStore& store);
+
+ private:
+  /**
+   * Spreads the bits of a number out to every other bit
+   */
+  static uint32_t SpreadBits(uint16_t value);
+
+  // Each particle's code alongside its slot, which breaks ties
+  std::vector<std::pair<uint32_t, size_t>> coded_slots_;
+  std::vector<size_t> order_;
+};
+
+}  // namespace idealgas
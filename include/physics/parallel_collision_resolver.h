@@ -0,0 +1,144 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "components/particle_store.h"
+#include "components/work_stealing_pool.h"
+#include "physics/collision_physics.h"
+
+namespace idealgas {
+
+/**
+ * Resolves particle collisions on several threads while giving exactly the
+ * same velocities as the serial all-pairs loop, whatever the number of
+ * threads. Touching pairs are found in parallel, then split into color classes
+ * in which no two pairs share a particle. The classes are resolved one after
+ * another, each fully in parallel, and a pair's class always comes after the
+ * classes of the earlier pairs sharing its particles, so every particle meets
+ * its collisions in the serial order. Both stages run on a work-stealing task
+ * pool in small chunks, since the work per particle follows how crowded its
+ * corner of the container is.
+ */
+class ParallelCollisionResolver {
+ public:
+  /**
+   * Creates a resolver that runs on the calling thread alone
+   */
+  ParallelCollisionResolver();
+
+  /**
+   * Creates a resolver that runs on a task pool
+   * @param task_pool the pool to split the work across, or null to run on the
+   * calling thread alone
+   */
+  explicit ParallelCollisionResolver(WorkStealingPool* task_pool);
+
+  /**
+   * Detects and resolves every collision between the particles in a store
+   * @param store the particles to collide
+   * @param neighbour_source a UniformGrid, VerletNeighbourList, SweepAndPrune
+   * or AabbTree that was brought up to date with the store's current
+   * positions
+   * @param physics the physics used to test and resolve each pair
+   * @return the number of collisions that were resolved
+   */
+  template <typename NeighbourSource>
+  size_t ResolveCollisions(ParticleStore* store,
+                           const NeighbourSource& neighbour_source,
+                           const CollisionPhysics& physics);
+
+  /**
+   * Sets the task pool the work is split across
+   * @param task_pool the pool to run on, or null to run on the calling thread
+   * alone
+   */
+  void SetTaskPool(WorkStealingPool* task_pool);
+
+  size_t GetNumThreads() const;
+
+  /**
+   * Gets the touching pairs found by the last call to ResolveCollisions
+   * @return the pairs in the order the serial loop would visit them
+   */
+  const std::vector<std::pair<size_t, size_t>>& GetTouchingPairs() const;
+
+  /**
+   * Gets how many color classes the last call to ResolveCollisions split the
+   * touching pairs into
+   * @return the number of classes, which were resolved one after another
+   */
+  size_t GetNumColors() const;
+
+  /**
+   * Gets how many candidate pairs the last call to ResolveCollisions tested
+   * @return the number of pair tests
+   */
+  size_t GetNumPairTests() const;
+
+ private:
+  /**
+   * Finds every pair of particles whose circles overlap. Positions don't change
+   * while collisions are resolved, so only these pairs can ever collide.
+   * @param store the particles to search
+   * @param neighbour_source the broad phase to gather each particle's
+   * candidates from
+   * @param physics the physics used to test each pair
+   */
+  template <typename NeighbourSource>
+  void FindTouchingPairs(const ParticleStore& store,
+                         const NeighbourSource& neighbour_source,
+                         const CollisionPhysics& physics);
+
+  /**
+   * Resolves the touching pairs found by FindTouchingPairs color by color
+   * @return the number of collisions that were resolved
+   */
+  size_t ResolveTouchingPairs(ParticleStore* store,
+                              const CollisionPhysics& physics);
+
+  /**
+   * Runs a loop in chunks on the task pool, or chunk by chunk on the calling
+   * thread without one
+   * @param count the number of loop iterations
+   * @param grain_size the iterations per chunk
+   * @param task called as task(begin, end, thread) for each chunk
+   */
+  template <typename Task>
+  void ParallelFor(size_t count, size_t grain_size, const Task& task);
+
+  /**
+   * Picks the chunk size for a loop, a single chunk without a task pool
+   * @param count the number of loop iterations
+   * @param min_grain_size the fewest iterations worth running as one chunk
+   * @return the iterations per chunk
+   */
+  size_t CalculateGrainSize(size_t count, size_t min_grain_size) const;
+
+  /**
+   * Splits the touching pairs into color classes of pairs that share no
+   * particles, keeping the serial pair order inside each class
+   * @param num_particles the number of particles in the store
+   */
+  void BuildColorClasses(size_t num_particles);
+
+  WorkStealingPool* task_pool_;
+
+  // Touching pairs found in each chunk of particles, in ascending order
+  std::vector<std::vector<std::pair<size_t, size_t>>> chunk_pairs_;
+  std::vector<std::vector<size_t>> thread_candidates_;
+  // Added to once per chunk by the thread that ran it
+  std::vector<size_t> thread_pair_tests_;
+  std::vector<size_t> thread_collisions_;
+  std::vector<std::pair<size_t, size_t>> touching_pairs_;
+
+  // Color bookkeeping, color c owns color_pairs_[color_starts_[c],
+  // color_starts_[c + 1])
+  std::vector<size_t> particle_next_colors_;
+  std::vector<size_t> pair_colors_;
+  std::vector<size_t> color_starts_;
+  std::vector<size_t> color_fill_;
+  std::vector<std::pair<size_t, size_t>> color_pairs_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+
+#include "components/particle_store.h"
+#include "physics/candidate_pairs.h"
+
+namespace idealgas {
+
+/**
+ * A sweep-and-prune broad phase that keeps the particles sorted by the left
+ * edge of their x-interval. Only particles whose x-intervals overlap can be
+ * touching, and each particle's interval is as wide as its own diameter, so
+ * small particles aren't tested against everything in a cell sized for the
+ * largest one. Particles move little between frames, so the order from the
+ * last frame is repaired with an insertion sort instead of sorted afresh.
+ */
+class SweepAndPrune {
+ public:
+  /**
+   * Creates a broad phase with no particles
+   */
+  SweepAndPrune();
+
+  /**
+   * Re-sorts the particles by their current positions and finds every pair
+   * whose x-intervals and y-intervals both overlap
+   * @param store the particles to sweep, in container order
+   */
+  void Update(const ParticleStore& store);
+
+  /**
+   * Forgets the order from the last frame so the next Update sorts from
+   * scratch, used whenever particles are added or removed
+   */
+  void Invalidate();
+
+  /**
+   * Collects the particles found overlapping the given particle that come
+   * after it in container order
+   * @param particle_idx the container index of the particle
+   * @param candidates filled with the candidate indices in ascending order
+   */
+  void GatherNeighbourCandidates(size_t particle_idx,
+                                 std::vector<size_t>* candidates) const;
+
+  /**
+   * Gets how far the insertion sort had to move intervals in the last Update
+   * @return the number of swaps, zero after sorting from scratch
+   */
+  size_t GetNumSwaps() const;
+
+  /**
+   * Gets how many overlapping pairs the last Update found
+   * @return the number of candidate pairs
+   */
+  size_t GetNumPairs() const;
+
+ private:
+  /**
+   * A particle's extent along the sweep axis
+   */
+  struct Interval {
+    float min_x;
+    float max_x;
+    size_t slot;
+  };
+
+  /**
+   * Restores the order by the left edges, moving each interval back past the
+   * ones that now start after it
+   */
+  void InsertionSort();
+
+  bool is_valid_;
+  size_t num_swaps_;
+  std::vector<Interval> intervals_;
+  CandidatePairs pairs_;
+};
+
+}  // namespace idealgas
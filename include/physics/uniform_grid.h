@@ -0,0 +1,162 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "components/particle_store.h"
+#include "components/work_stealing_pool.h"
+
+namespace idealgas {
+
+/**
+ * A uniform cell list over the container that is used as a broad phase for
+ * particle collisions. Cells are at least as wide as the largest particle
+ * diameter, so any two touching particles always sit in the same or in
+ * neighbouring cells. The particles are binned with a counting sort run in
+ * parts on a task pool. The parts first group the particles into one run of
+ * cells per part, each holding about as many particles however unevenly they
+ * are spread, then each part sorts just its own cells, so no part touches
+ * every cell. Every cell ends up a contiguous range of one array.
+ */
+class UniformGrid {
+ public:
+  /**
+   * Creates an empty grid with no cells
+   */
+  UniformGrid();
+
+  /**
+   * Bins every particle into its cell, sizing the cells from the largest
+   * particle radius. The grid keeps no pointers to the particles, so it must be
+   * rebuilt whenever the particles move or the particle set changes.
+   * @param store the particles to bin, in container order
+   * @param top_left_corner the top left corner of the container
+   * @param bottom_right_corner the bottom right corner of the container
+   */
+  void Rebuild(const ParticleStore& store, const glm::vec2& top_left_corner,
+               const glm::vec2& bottom_right_corner);
+
+  /**
+   * Bins every particle like the other Rebuild, but with cells wide enough
+   * that particles closer than their radii plus a skin distance are still in
+   * the same or in neighbouring cells
+   * @param store the particles to bin, in container order
+   * @param top_left_corner the top left corner of the container
+   * @param bottom_right_corner the bottom right corner of the container
+   * @param skin how far apart two particles' edges can be and still need to
+   * be neighbours
+   */
+  void Rebuild(const ParticleStore& store, const glm::vec2& top_left_corner,
+               const glm::vec2& bottom_right_corner, float skin);
+
+  /**
+   * Collects every particle that could touch the given particle and comes
+   * after it in container order, i.e. all particles in its own and the eight
+   * surrounding cells with a larger index
+   * @param particle_idx the container index of the particle
+   * @param candidates filled with the candidate indices in ascending order
+   */
+  void GatherNeighbourCandidates(size_t particle_idx,
+                                 std::vector<size_t>* candidates) const;
+
+  float GetCellSize() const;
+
+  size_t GetNumColumns() const;
+
+  size_t GetNumRows() const;
+
+  /**
+   * Sets the threads each Rebuild is split across. Any number of threads bins
+   * the particles exactly as a single thread does.
+   * @param task_pool the pool to run on, or null to rebuild on the calling
+   * thread alone
+   */
+  void SetTaskPool(WorkStealingPool* task_pool);
+
+ private:
+  /**
+   * Runs a task once for each part of the particles, on the task pool when
+   * there is more than one part
+   * @param task called with the index of each part
+   */
+  template <typename Task>
+  void RunParts(const Task& task);
+
+  /**
+   * Gets which of the evenly sized buckets of cells that the runs of cells
+   * are cut between a cell belongs to
+   * @param cell the index of the cell
+   * @return the index of the bucket
+   */
+  size_t CalculateCellBucket(size_t cell) const;
+
+  /**
+   * Gets the first cell in a bucket of cells
+   * @param bucket the index of the bucket
+   * @return the index of the cell
+   */
+  size_t CalculateFirstBucketCell(size_t bucket) const;
+
+  /**
+   * Works out each particle's cell, splits the cells into one run per part
+   * holding about as many particles each, then groups the particles in
+   * range_entries_ by run, keeping container order inside each run. With a
+   * single part the particles are already grouped.
+   * @param store the particles to bin
+   */
+  void SplitParticlesByCellRange(const ParticleStore& store);
+
+  /**
+   * Counting sorts each part's particles into its own run of cells, filling
+   * cell_starts_ and cell_entries_ for those cells
+   */
+  void SortCellRanges();
+
+  /**
+   * Determines which column or row a coordinate falls in. Coordinates outside
+   * the container are clamped to the border cells.
+   * @param coordinate the x or y coordinate of a particle
+   * @param origin the matching coordinate of the top left corner
+   * @param num_cells the number of columns or rows
+   * @return the column or row index
+   */
+  size_t CalculateCellCoordinate(float coordinate, float origin,
+                                 size_t num_cells) const;
+
+  // Upper bound on columns and rows so tiny radii can't blow up memory
+  static const size_t kMaxCellsPerAxis = 1024;
+  // Fewest particles worth handing a thread of their own while binning
+  static const size_t kMinParticlesPerPart = 2048;
+  // How many buckets of cells each part's run of cells can be cut from, so a
+  // run can be cut to within a bucket of an even share of the particles
+  static const size_t kBucketsPerPart = 64;
+
+  glm::vec2 origin_;
+  float cell_size_;
+  size_t num_columns_;
+  size_t num_rows_;
+
+  // Cell c owns cell_entries_[cell_starts_[c], cell_starts_[c + 1])
+  std::vector<size_t> cell_starts_;
+  std::vector<size_t> cell_entries_;
+  std::vector<size_t> particle_cells_;
+
+  WorkStealingPool* task_pool_;
+  size_t num_parts_;
+  std::vector<float> part_max_radii_;
+  // Row p holds part p's particle count per bucket of cells
+  std::vector<size_t> part_bucket_counts_;
+  // Which part's run of cells each bucket of cells falls in
+  std::vector<size_t> bucket_ranges_;
+  // Run r is cells [range_first_cells_[r], range_first_cells_[r + 1])
+  std::vector<size_t> range_first_cells_;
+  // Row p holds part p's particle count per run of cells, then where its
+  // particles in each run go in range_entries_
+  std::vector<size_t> part_range_counts_;
+  // The particles grouped by cell range, range r owning
+  // range_entries_[range_starts_[r], range_starts_[r + 1])
+  std::vector<size_t> range_entries_;
+  std::vector<size_t> range_starts_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "components/particle_store.h"
+#include "physics/uniform_grid.h"
+
+namespace idealgas {
+
+/**
+ * A Verlet list broad phase that keeps, for every particle, the later
+ * particles within their radii plus a skin distance of it. While no particle
+ * has moved more than half the skin since the lists were built, no pair can
+ * have closed the gap, so every touching pair is still in the lists and they
+ * can be reused instead of rebuilding the grid each frame.
+ */
+class VerletNeighbourList {
+ public:
+  static const float kDefaultSkin;
+
+  /**
+   * Creates an empty list with the default skin
+   */
+  VerletNeighbourList();
+
+  /**
+   * Creates an empty list
+   * @param skin the extra distance beyond touching that pairs are kept within
+   */
+  explicit VerletNeighbourList(float skin);
+
+  /**
+   * Rebuilds the lists if they were invalidated or any particle has moved
+   * more than half the skin since they were last built
+   * @param store the particles to list, in container order
+   * @param top_left_corner the top left corner of the container
+   * @param bottom_right_corner the bottom right corner of the container
+   * @return whether the lists were rebuilt
+   */
+  bool Update(const ParticleStore& store, const glm::vec2& top_left_corner,
+              const glm::vec2& bottom_right_corner);
+
+  /**
+   * Forces the next Update to rebuild, used whenever particles are added or
+   * removed
+   */
+  void Invalidate();
+
+  /**
+   * Sets the skin distance, which invalidates the lists
+   * @param skin the extra distance beyond touching, at least zero
+   */
+  void SetSkin(float skin);
+
+  float GetSkin() const;
+
+  /**
+   * Gets the listed neighbours of a particle, in the same form as the grid
+   * gives its candidates
+   * @param particle_idx the container index of the particle
+   * @param candidates filled with the neighbours' indices in ascending order,
+   * all larger than particle_idx
+   */
+  void GatherNeighbourCandidates(size_t particle_idx,
+                                 std::vector<size_t>* candidates) const;
+
+  /**
+   * Gets the listed neighbours of a particle without copying them
+   * @param particle_idx the container index of the particle
+   * @return the first of the neighbours' indices, in ascending order
+   */
+  const size_t* GetNeighbours(size_t particle_idx) const;
+
+  size_t GetNumNeighbours(size_t particle_idx) const;
+
+  /**
+   * Gets how many times the lists have been built
+   * @return the number of rebuilds since the list was created
+   */
+  size_t GetNumRebuilds() const;
+
+ private:
+  /**
+   * Lists every pair within the skin from the particles' current positions
+   */
+  void Rebuild(const ParticleStore& store, const glm::vec2& top_left_corner,
+               const glm::vec2& bottom_right_corner);
+
+  /**
+   * Checks whether any particle has moved more than half the skin since the
+   * lists were built
+   */
+  bool HasMovedTooFar(const ParticleStore& store) const;
+
+  float skin_;
+  bool is_valid_;
+  size_t num_rebuilds_;
+  UniformGrid grid_;
+  std::vector<size_t> candidates_;
+
+  // Particle p's neighbours are neighbours_[neighbour_starts_[p],
+  // neighbour_starts_[p + 1])
+  std::vector<size_t> neighbour_starts_;
+  std::vector<size_t> neighbours_;
+
+  // Where each particle was when the lists were built
+  std::vector<float> built_x_positions_;
+  std::vector<float> built_y_positions_;
+};
+
+}  // namespace idealgas
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+
+namespace idealgas {
+
+/**
+ * Reflects particle velocities off a pair of opposite walls over contiguous
+ * arrays without branching. The widest instruction set the CPU supports is
+ * picked at runtime, and every instruction set gives bit-identical results to
+ * the per-particle IsParticleCollidingWith*Wall checks.
+ */
+class WallCollisionKernel {
+ public:
+  /**
+   * The instruction sets the kernel can run on
+   */
+  enum class InstructionSet { kScalar, kSse, kAvx2 };
+
+  /**
+   * Creates a kernel that runs on the widest instruction set available
+   */
+  WallCollisionKernel();
+
+  /**
+   * Creates a kernel that runs on a specific instruction set, falling back to
+   * the widest available one if the CPU doesn't support it
+   * @param instruction_set the instruction set to run on
+   */
+  explicit WallCollisionKernel(InstructionSet instruction_set);
+
+  /**
+   * Flips the velocity component of every particle that touches the near wall
+   * while moving toward it, or the far wall while moving toward it
+   * @param positions the particle coordinates along one axis
+   * @param velocities the particle velocity components along the same axis
+   * @param radii the particle radii
+   * @param count the number of particles
+   * @param near_wall the coordinate of the top or left wall
+   * @param far_wall the coordinate of the bottom or right wall
+   * @return the number of velocities that were flipped
+   */
+  size_t Reflect(const float* positions, float* velocities, const float* radii,
+                 size_t count, float near_wall, float far_wall) const;
+
+  InstructionSet GetInstructionSet() const;
+
+  /**
+   * Determines the widest instruction set this CPU can run the kernel on
+   * @return the detected instruction set
+   */
+  static InstructionSet DetectInstructionSet();
+
+ private:
+  InstructionSet instruction_set_;
+};
+
+}  // namespace idealgas
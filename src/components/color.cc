@@ -0,0 +1,19 @@
+#include "components/color.h"
+
+namespace idealgas {
+
+Color::Color() : r(0), g(0), b(0) {
+}
+
+Color::Color(float red, float green, float blue) : r(red), g(green), b(blue) {
+}
+
+bool Color::operator==(const Color& other) const {
+  return r == other.r && g == other.g && b == other.b;
+}
+
+bool Color::operator!=(const Color& other) const {
+  return !(*this == other);
+}
+
+}  // namespace idealgas
@@ -0,0 +1,152 @@
+#include "components/frame_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "components/trace_recorder.h"
+
+namespace idealgas {
+
+namespace {
+
+const size_t kNumPhases = size_t(ProfilePhase::kNumPhases);
+const size_t kNumCounters = size_t(ProfileCounter::kNumCounters);
+
+FrameProfile MakeEmptyFrame() {
+  FrameProfile frame;
+  std::fill(frame.phase_seconds, frame.phase_seconds + kNumPhases, 0.0);
+  std::fill(frame.counts, frame.counts + kNumCounters, size_t(0));
+  return frame;
+}
+
+}  // namespace
+
+const size_t FrameProfiler::kHistorySize;
+
+FrameProfiler::ScopedPhase::ScopedPhase(FrameProfiler* profiler,
+                                        ProfilePhase phase)
+    : profiler_(profiler),
+      phase_(phase),
+      start_(std::chrono::steady_clock::now()) {
+}
+
+FrameProfiler::ScopedPhase::~ScopedPhase() {
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  std::chrono::duration<double> elapsed = end - start_;
+  profiler_->AddPhaseTime(phase_, elapsed.count());
+
+  // Phases also show up in a trace whenever one is being recorded
+  TraceRecorder::GetInstance().Record(GetPhaseName(phase_), start_, end);
+}
+
+FrameProfiler::FrameProfiler()
+    : current_frame_(MakeEmptyFrame()),
+      history_(kHistorySize, MakeEmptyFrame()),
+      next_history_slot_(0),
+      num_frames_(0),
+      scratch_(kHistorySize) {
+}
+
+void FrameProfiler::BeginFrame() {
+  current_frame_ = MakeEmptyFrame();
+}
+
+void FrameProfiler::EndFrame() {
+  history_[next_history_slot_] = current_frame_;
+  next_history_slot_ = (next_history_slot_ + 1) % kHistorySize;
+  num_frames_ = std::min(num_frames_ + 1, kHistorySize);
+}
+
+void FrameProfiler::AddPhaseTime(ProfilePhase phase, double seconds) {
+  current_frame_.phase_seconds[size_t(phase)] += seconds;
+}
+
+void FrameProfiler::AddCount(ProfileCounter counter, size_t amount) {
+  current_frame_.counts[size_t(counter)] += amount;
+}
+
+void FrameProfiler::AddFrame(const FrameProfile& frame) {
+  for (size_t phase = 0; phase < kNumPhases; ++phase) {
+    current_frame_.phase_seconds[phase] += frame.phase_seconds[phase];
+  }
+  for (size_t counter = 0; counter < kNumCounters; ++counter) {
+    current_frame_.counts[counter] += frame.counts[counter];
+  }
+}
+
+const FrameProfile& FrameProfiler::GetLastFrame() const {
+  return history_[(next_history_slot_ + kHistorySize - 1) % kHistorySize];
+}
+
+size_t FrameProfiler::GetNumFrames() const {
+  return num_frames_;
+}
+
+double FrameProfiler::CalculatePhasePercentile(ProfilePhase phase,
+                                               float percentile) const {
+  for (size_t frame = 0; frame < num_frames_; ++frame) {
+    scratch_[frame] = history_[frame].phase_seconds[size_t(phase)];
+  }
+
+  return CalculateScratchPercentile(percentile);
+}
+
+double FrameProfiler::CalculateCounterPercentile(ProfileCounter counter,
+                                                 float percentile) const {
+  for (size_t frame = 0; frame < num_frames_; ++frame) {
+    scratch_[frame] = double(history_[frame].counts[size_t(counter)]);
+  }
+
+  return CalculateScratchPercentile(percentile);
+}
+
+const char* FrameProfiler::GetPhaseName(ProfilePhase phase) {
+  switch (phase) {
+    case ProfilePhase::kWallCollisions:
+      return "wall collisions";
+    case ProfilePhase::kParticleCollisions:
+      return "particle collisions";
+    case ProfilePhase::kPositionUpdate:
+      return "position update";
+    case ProfilePhase::kEventDriven:
+      return "event-driven step";
+    case ProfilePhase::kReorder:
+      return "storage reorder";
+    case ProfilePhase::kHistograms:
+      return "histograms";
+    default:
+      return "unknown";
+  }
+}
+
+const char* FrameProfiler::GetCounterName(ProfileCounter counter) {
+  switch (counter) {
+    case ProfileCounter::kPairTests:
+      return "pair tests";
+    case ProfileCounter::kCollisions:
+      return "collisions";
+    case ProfileCounter::kWallBounces:
+      return "wall bounces";
+    case ProfileCounter::kNeighbourRebuilds:
+      return "neighbour list rebuilds";
+    case ProfileCounter::kReorders:
+      return "storage reorders";
+    default:
+      return "unknown";
+  }
+}
+
+double FrameProfiler::CalculateScratchPercentile(float percentile) const {
+  if (num_frames_ == 0) {
+    return 0;
+  }
+
+  // Nearest-rank percentile, so the result is always a recorded value
+  size_t rank = size_t(std::ceil(percentile / 100 * num_frames_));
+  size_t index = rank == 0 ? 0 : std::min(rank, num_frames_) - 1;
+  std::nth_element(scratch_.begin(), scratch_.begin() + index,
+                   scratch_.begin() + num_frames_);
+  return scratch_[index];
+}
+
+}  // namespace idealgas
@@ -2,6 +2,8 @@
 
 #include <utility>
 
+#include "components/trace_recorder.h"
+
 namespace idealgas {
 
 Histogram::Histogram() = default;
@@ -9,22 +11,23 @@ Histogram::Histogram() = default;
 Histogram::Histogram(const std::vector<Particle*>& particles,
                      const glm::vec2& top_left_corner,
                      const glm::vec2& bottom_right_corner, float bin_width,
-                     const ci::Color& bin_color, size_t num_y_axis_marks) {
+                     const Color& bin_color, size_t num_y_axis_marks) {
   top_left_corner_ = top_left_corner;
   bottom_right_corner_ = bottom_right_corner;
   histogram_height_ = bottom_right_corner_.y - top_left_corner_.y;
   histogram_width_ = bottom_right_corner_.x - top_left_corner_.x;
-  bin_width_ = bin_width;
+  speed_bins_ = SpeedBins(bin_width);
   bin_color_ = bin_color;
   num_y_axis_marks_ = num_y_axis_marks;
-  num_bins_ = CalculateNumOfBins(particles);
+  speed_bins_.Update(particles);
 }
 
 void Histogram::Draw() {
+  IDEALGAS_TRACE_SCOPE("Histogram::Draw");
   ci::Color border_color("white");
   ci::gl::color(border_color);
   ci::gl::drawStrokedRect(ci::Rectf(top_left_corner_, bottom_right_corner_));
-  ci::gl::color(bin_color_);
+  ci::gl::color(ci::Color(bin_color_.r, bin_color_.g, bin_color_.b));
 
   ci::Color text_color("white");
   float text_size = 25.0f;
@@ -51,7 +54,7 @@ void Histogram::DrawHistogramXAxisLabel(const ci::Color& text_color,
 void Histogram::DrawHistogramYAxisValues(const ci::Color& text_color,
                                          float text_size,
                                          const ci::Font& text_font) {
-  size_t highest_bin_height = CalculateMostParticlesInSingleBin();
+  size_t highest_bin_height = speed_bins_.CalculateMostParticlesInSingleBin();
   float y_interval = histogram_height_ / num_y_axis_marks_;
 
   // Calculates the common difference to be displayed on the y axis
@@ -73,12 +76,13 @@ void Histogram::DrawHistogramYAxisValues(const ci::Color& text_color,
 }
 
 void Histogram::DrawHistogramBins() {
-  size_t display_width = size_t(histogram_width_) / num_bins_;
+  const std::vector<size_t>& particle_bins = speed_bins_.GetBins();
+  size_t display_width = size_t(histogram_width_) / particle_bins.size();
 
-  size_t max_particles = CalculateMostParticlesInSingleBin();
+  size_t max_particles = speed_bins_.CalculateMostParticlesInSingleBin();
 
-  for (size_t bin = 0; bin < particle_bins_.size(); ++bin) {
-    size_t num_particles = particle_bins_[bin];
+  for (size_t bin = 0; bin < particle_bins.size(); ++bin) {
+    size_t num_particles = particle_bins[bin];
     float bin_height = num_particles / float(max_particles) * histogram_height_;
 
     float top_left_x = top_left_corner_.x + bin + display_width * bin;
@@ -95,44 +99,23 @@ void Histogram::DrawHistogramBins() {
   }
 }
 
-std::vector<size_t> Histogram::UpdateParticleBins(
+const std::vector<size_t>& Histogram::UpdateParticleBins(
     const std::vector<Particle*>& particles) {
-  num_bins_ = CalculateNumOfBins(particles);
-  particle_bins_ = std::vector<size_t>(num_bins_, 0);
-
-  for (Particle* particle : particles) {
-    size_t bin = int(particle->GetSpeed() / bin_width_);
-    ++particle_bins_[bin];
-  }
-
-  return particle_bins_;
-}
-
-size_t Histogram::CalculateNumOfBins(const std::vector<Particle*>& particles) {
-  float max_speed = CalculateFastestParticle(particles);
-
-  return size_t(max_speed / bin_width_) + 1;
+  return speed_bins_.Update(particles);
 }
 
-size_t Histogram::CalculateMostParticlesInSingleBin() {
-  size_t max_particles = 0;
-
-  for (const size_t& particle_bin : particle_bins_) {
-    max_particles = std::max(particle_bin, max_particles);
-  }
-
-  return max_particles;
+const std::vector<size_t>& Histogram::UpdateParticleBins(
+    const ParticleStore& store) {
+  return speed_bins_.Update(store, bin_color_);
 }
 
-float Histogram::CalculateFastestParticle(
-    const std::vector<Particle*>& particles) {
-  float max_speed = 0;
-
-  for (Particle* particle : particles) {
-    max_speed = std::max(particle->GetSpeed(), max_speed);
-  }
-
-  return max_speed;
+const std::vector<size_t>& Histogram::UpdateParticleBins(
+    const SpeedBins& speed_bins) {
+  // Matching the source's reserved room means copy assignment keeps reusing
+  // the same memory as the bins grow into it
+  speed_bins_.Reserve(speed_bins.GetBins().capacity());
+  speed_bins_ = speed_bins;
+  return speed_bins_.GetBins();
 }
 
 }  // namespace idealgas
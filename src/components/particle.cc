@@ -1,9 +1,11 @@
 #include "components/particle.h"
 
+#include "components/particle_store.h"
+
 namespace idealgas {
 
 Particle::Particle(const glm::vec2 &position, const glm::vec2 &velocity,
-                   const ci::Color &color, float radius, float mass)
+                   const Color &color, float radius, float mass)
     : position_(position),
       velocity_(velocity),
       color_(color),
@@ -19,7 +21,7 @@ glm::vec2 Particle::GetVelocity() const {
   return velocity_;
 }
 
-ci::Color Particle::GetColor() const {
+Color Particle::GetColor() const {
   return color_;
 }
 
@@ -32,7 +34,8 @@ float Particle::GetMass() const {
 }
 
 float Particle::GetSpeed() const {
-  return std::sqrt(std::pow(velocity_.x, 2) + std::pow(velocity_.y, 2));
+  glm::vec2 velocity = GetVelocity();
+  return ParticleStore::CalculateSpeed(velocity.x, velocity.y);
 }
 
 void Particle::UpdatePosition() {
@@ -45,31 +48,31 @@ void Particle::SetVelocity(const glm::vec2 &new_velocity) {
 
 void Particle::UpdateVelocity(const glm::vec2 &delta_velocity,
                               bool should_increase_speed) {
-  if (should_increase_speed) {
-    if (velocity_.x > 0) {
-      velocity_.x += delta_velocity.x;
-    } else if (velocity_.x < 0) {
-      velocity_.x -= delta_velocity.x;
-    }
+  glm::vec2 velocity = GetVelocity();
+  velocity.x = AdjustVelocityComponent(velocity.x, delta_velocity.x,
+                                       should_increase_speed);
+  velocity.y = AdjustVelocityComponent(velocity.y, delta_velocity.y,
+                                       should_increase_speed);
+  SetVelocity(velocity);
+}
 
-    if (velocity_.y > 0) {
-      velocity_.y += delta_velocity.y;
-    } else if (velocity_.y < 0) {
-      velocity_.y -= delta_velocity.y;
+float Particle::AdjustVelocityComponent(float component, float delta,
+                                        bool should_increase_speed) {
+  if (should_increase_speed) {
+    if (component > 0) {
+      return component + delta;
+    } else if (component < 0) {
+      return component - delta;
     }
   } else {
-    if (velocity_.x > 0) {
-      velocity_.x -= delta_velocity.x;
-    } else if (velocity_.x < 0) {
-      velocity_.x += delta_velocity.x;
-    }
-
-    if (velocity_.y > 0) {
-      velocity_.y -= delta_velocity.y;
-    } else if (velocity_.y < 0) {
-      velocity_.y += delta_velocity.y;
+    if (component > 0) {
+      return component - delta;
+    } else if (component < 0) {
+      return component + delta;
     }
   }
+
+  return component;
 }
 
-}  // namespace idealgas
\ No newline at end of file
+}  // namespace idealgas
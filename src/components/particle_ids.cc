@@ -0,0 +1,72 @@
+#include "components/particle_ids.h"
+
+#include <limits>
+
+namespace idealgas {
+
+const size_t ParticleIds::kNoSlot = std::numeric_limits<size_t>::max();
+
+ParticleIds::ParticleIds() = default;
+
+size_t ParticleIds::Add() {
+  size_t slot = slot_ids_.size();
+  size_t id;
+  if (free_ids_.empty()) {
+    id = id_slots_.size();
+    id_slots_.push_back(slot);
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+    id_slots_[id] = slot;
+  }
+
+  slot_ids_.push_back(id);
+  return id;
+}
+
+void ParticleIds::Remove(size_t slot) {
+  size_t removed_id = slot_ids_[slot];
+  size_t last = slot_ids_.size() - 1;
+  if (slot != last) {
+    slot_ids_[slot] = slot_ids_[last];
+    id_slots_[slot_ids_[slot]] = slot;
+  }
+
+  slot_ids_.pop_back();
+  id_slots_[removed_id] = kNoSlot;
+  free_ids_.push_back(removed_id);
+}
+
+void ParticleIds::Clear() {
+  slot_ids_.clear();
+  id_slots_.clear();
+  free_ids_.clear();
+}
+
+void ParticleIds::Reorder(const std::vector<size_t>& order) {
+  reordered_ids_.resize(order.size());
+  for (size_t slot = 0; slot < order.size(); ++slot) {
+    reordered_ids_[slot] = slot_ids_[order[slot]];
+    id_slots_[reordered_ids_[slot]] = slot;
+  }
+
+  slot_ids_.swap(reordered_ids_);
+}
+
+size_t ParticleIds::Size() const {
+  return slot_ids_.size();
+}
+
+size_t ParticleIds::GetId(size_t slot) const {
+  return slot_ids_[slot];
+}
+
+size_t ParticleIds::GetSlot(size_t id) const {
+  if (id >= id_slots_.size()) {
+    return kNoSlot;
+  }
+
+  return id_slots_[id];
+}
+
+}  // namespace idealgas
@@ -0,0 +1,76 @@
+#include "components/particle_range.h"
+
+#include <stdexcept>
+
+namespace idealgas {
+
+ParticleRange::Iterator::Iterator(const ParticleRange* range, size_t index)
+    : range_(range),
+      index_(index),
+      particle_copy_(glm::vec2(0, 0), glm::vec2(0, 0), Color(), 0, 0),
+      has_particle_copy_(false) {
+}
+
+ParticleRange::Iterator::~Iterator() {
+  WriteBackParticle();
+}
+
+Particle* ParticleRange::Iterator::CopyParticle() const {
+  ParticleView* view = GetView();
+  particle_copy_ =
+      Particle(view->GetPosition(), view->GetVelocity(), view->GetColor(),
+               view->GetRadius(), view->GetMass());
+  has_particle_copy_ = true;
+  return &particle_copy_;
+}
+
+void ParticleRange::Iterator::WriteBackParticle() {
+  if (!has_particle_copy_) {
+    return;
+  }
+
+  // A Particle can only move or change velocity, so only those are copied
+  ParticleView* view = GetView();
+  view->SetPosition(particle_copy_.GetPosition());
+  view->SetVelocity(particle_copy_.GetVelocity());
+  has_particle_copy_ = false;
+}
+
+ParticleRange::ParticleRange()
+    : particles_(nullptr), slots_(nullptr), size_(0) {
+}
+
+ParticleRange::ParticleRange(ParticleView* particles, size_t size)
+    : particles_(particles), slots_(nullptr), size_(size) {
+}
+
+ParticleRange::ParticleRange(ParticleView* particles, const size_t* slots,
+                             size_t size)
+    : particles_(particles), slots_(slots), size_(size) {
+}
+
+ParticleView* ParticleRange::at(size_t index) const {
+  if (index >= size_) {
+    throw std::out_of_range("Particle index is past the end of the range");
+  }
+
+  return (*this)[index];
+}
+
+size_t ParticleRange::size() const {
+  return size_;
+}
+
+bool ParticleRange::empty() const {
+  return size_ == 0;
+}
+
+ParticleRange::Iterator ParticleRange::begin() const {
+  return Iterator(this, 0);
+}
+
+ParticleRange::Iterator ParticleRange::end() const {
+  return Iterator(this, size_);
+}
+
+}  // namespace idealgas
@@ -0,0 +1,187 @@
+#include "components/particle_store.h"
+
+#include <cmath>
+
+namespace idealgas {
+
+ParticleStore::ParticleStore() = default;
+
+size_t ParticleStore::Add(const glm::vec2& position, const glm::vec2& velocity,
+                          const Color& color, float radius, float mass) {
+  return Add(position, velocity, RegisterSpecies(color, radius, mass));
+}
+
+size_t ParticleStore::Add(const glm::vec2& position, const glm::vec2& velocity,
+                          SpeciesId species) {
+  x_positions_.push_back(position.x);
+  y_positions_.push_back(position.y);
+  x_velocities_.push_back(velocity.x);
+  y_velocities_.push_back(velocity.y);
+  radii_.push_back(species_table_.GetRadius(species));
+  species_.push_back(species);
+
+  return x_positions_.size() - 1;
+}
+
+void ParticleStore::Reserve(size_t capacity) {
+  x_positions_.reserve(capacity);
+  y_positions_.reserve(capacity);
+  x_velocities_.reserve(capacity);
+  y_velocities_.reserve(capacity);
+  radii_.reserve(capacity);
+  species_.reserve(capacity);
+}
+
+void ParticleStore::Remove(size_t slot) {
+  size_t last = x_positions_.size() - 1;
+  x_positions_[slot] = x_positions_[last];
+  y_positions_[slot] = y_positions_[last];
+  x_velocities_[slot] = x_velocities_[last];
+  y_velocities_[slot] = y_velocities_[last];
+  radii_[slot] = radii_[last];
+  species_[slot] = species_[last];
+
+  x_positions_.pop_back();
+  y_positions_.pop_back();
+  x_velocities_.pop_back();
+  y_velocities_.pop_back();
+  radii_.pop_back();
+  species_.pop_back();
+}
+
+void ParticleStore::Clear() {
+  x_positions_.clear();
+  y_positions_.clear();
+  x_velocities_.clear();
+  y_velocities_.clear();
+  radii_.clear();
+  species_.clear();
+}
+
+void ParticleStore::GatherFrom(const ParticleStore& source,
+                               const std::vector<size_t>& order) {
+  Reserve(source.Capacity());
+  x_positions_.resize(order.size());
+  y_positions_.resize(order.size());
+  x_velocities_.resize(order.size());
+  y_velocities_.resize(order.size());
+  radii_.resize(order.size());
+  species_.resize(order.size());
+
+  for (size_t slot = 0; slot < order.size(); ++slot) {
+    size_t source_slot = order[slot];
+    x_positions_[slot] = source.x_positions_[source_slot];
+    y_positions_[slot] = source.y_positions_[source_slot];
+    x_velocities_[slot] = source.x_velocities_[source_slot];
+    y_velocities_[slot] = source.y_velocities_[source_slot];
+    radii_[slot] = source.radii_[source_slot];
+    species_[slot] = source.species_[source_slot];
+  }
+
+  species_table_ = source.species_table_;
+}
+
+size_t ParticleStore::Size() const {
+  return x_positions_.size();
+}
+
+size_t ParticleStore::Capacity() const {
+  return x_positions_.capacity();
+}
+
+bool ParticleStore::IsEmpty() const {
+  return x_positions_.empty();
+}
+
+glm::vec2 ParticleStore::GetPosition(size_t slot) const {
+  return glm::vec2(x_positions_[slot], y_positions_[slot]);
+}
+
+glm::vec2 ParticleStore::GetVelocity(size_t slot) const {
+  return glm::vec2(x_velocities_[slot], y_velocities_[slot]);
+}
+
+const Color& ParticleStore::GetColor(size_t slot) const {
+  return species_table_.GetColor(species_[slot]);
+}
+
+float ParticleStore::GetRadius(size_t slot) const {
+  return radii_[slot];
+}
+
+float ParticleStore::GetMass(size_t slot) const {
+  return species_table_.GetMass(species_[slot]);
+}
+
+SpeciesId ParticleStore::GetSpecies(size_t slot) const {
+  return species_[slot];
+}
+
+float ParticleStore::GetSpeed(size_t slot) const {
+  return CalculateSpeed(x_velocities_[slot], y_velocities_[slot]);
+}
+
+void ParticleStore::SetPosition(size_t slot, const glm::vec2& new_position) {
+  x_positions_[slot] = new_position.x;
+  y_positions_[slot] = new_position.y;
+}
+
+void ParticleStore::SetVelocity(size_t slot, const glm::vec2& new_velocity) {
+  x_velocities_[slot] = new_velocity.x;
+  y_velocities_[slot] = new_velocity.y;
+}
+
+float* ParticleStore::GetXPositions() {
+  return x_positions_.data();
+}
+
+float* ParticleStore::GetYPositions() {
+  return y_positions_.data();
+}
+
+float* ParticleStore::GetXVelocities() {
+  return x_velocities_.data();
+}
+
+float* ParticleStore::GetYVelocities() {
+  return y_velocities_.data();
+}
+
+const float* ParticleStore::GetXPositions() const {
+  return x_positions_.data();
+}
+
+const float* ParticleStore::GetYPositions() const {
+  return y_positions_.data();
+}
+
+const float* ParticleStore::GetXVelocities() const {
+  return x_velocities_.data();
+}
+
+const float* ParticleStore::GetYVelocities() const {
+  return y_velocities_.data();
+}
+
+const float* ParticleStore::GetRadii() const {
+  return radii_.data();
+}
+
+const SpeciesId* ParticleStore::GetSpeciesIds() const {
+  return species_.data();
+}
+
+const SpeciesTable& ParticleStore::GetSpeciesTable() const {
+  return species_table_;
+}
+
+SpeciesId ParticleStore::RegisterSpecies(const Color& color, float radius,
+                                         float mass) {
+  return species_table_.FindOrAdd(color, radius, mass);
+}
+
+float ParticleStore::CalculateSpeed(float x_velocity, float y_velocity) {
+  return std::sqrt(std::pow(x_velocity, 2) + std::pow(y_velocity, 2));
+}
+
+}  // namespace idealgas
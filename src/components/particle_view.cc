@@ -0,0 +1,61 @@
+#include "components/particle_view.h"
+
+#include "components/particle.h"
+
+namespace idealgas {
+
+ParticleView::ParticleView(ParticleStore* store, size_t slot)
+    : store_(store), slot_(slot) {
+}
+
+glm::vec2 ParticleView::GetPosition() const {
+  return store_->GetPosition(slot_);
+}
+
+glm::vec2 ParticleView::GetVelocity() const {
+  return store_->GetVelocity(slot_);
+}
+
+Color ParticleView::GetColor() const {
+  return store_->GetColor(slot_);
+}
+
+float ParticleView::GetRadius() const {
+  return store_->GetRadius(slot_);
+}
+
+float ParticleView::GetMass() const {
+  return store_->GetMass(slot_);
+}
+
+float ParticleView::GetSpeed() const {
+  return store_->GetSpeed(slot_);
+}
+
+size_t ParticleView::GetSlot() const {
+  return slot_;
+}
+
+void ParticleView::SetPosition(const glm::vec2& new_position) {
+  store_->SetPosition(slot_, new_position);
+}
+
+void ParticleView::SetVelocity(const glm::vec2& new_velocity) {
+  store_->SetVelocity(slot_, new_velocity);
+}
+
+void ParticleView::UpdatePosition() {
+  store_->SetPosition(slot_, GetPosition() + GetVelocity());
+}
+
+void ParticleView::UpdateVelocity(const glm::vec2& delta_velocity,
+                                  bool should_increase_speed) {
+  glm::vec2 velocity = GetVelocity();
+  velocity.x = Particle::AdjustVelocityComponent(
+      velocity.x, delta_velocity.x, should_increase_speed);
+  velocity.y = Particle::AdjustVelocityComponent(
+      velocity.y, delta_velocity.y, should_increase_speed);
+  SetVelocity(velocity);
+}
+
+}  // namespace idealgas
@@ -0,0 +1,60 @@
+#include "components/slot_index.h"
+
+namespace idealgas {
+
+SlotIndex::SlotIndex() = default;
+
+size_t SlotIndex::Add(size_t bucket) {
+  if (bucket >= bucket_slots_.size()) {
+    bucket_slots_.resize(bucket + 1);
+  }
+
+  size_t slot = slot_buckets_.size();
+  slot_buckets_.push_back(bucket);
+  slot_positions_.push_back(bucket_slots_[bucket].size());
+  bucket_slots_[bucket].push_back(slot);
+  return slot;
+}
+
+void SlotIndex::Remove(size_t slot) {
+  // Take the slot out of its bucket by moving the bucket's last entry into it
+  std::vector<size_t>& slots = bucket_slots_[slot_buckets_[slot]];
+  size_t moved_entry = slots.back();
+  slots[slot_positions_[slot]] = moved_entry;
+  slot_positions_[moved_entry] = slot_positions_[slot];
+  slots.pop_back();
+
+  // Then the store's last slot takes over the removed slot's number
+  size_t last = slot_buckets_.size() - 1;
+  if (slot != last) {
+    bucket_slots_[slot_buckets_[last]][slot_positions_[last]] = slot;
+    slot_buckets_[slot] = slot_buckets_[last];
+    slot_positions_[slot] = slot_positions_[last];
+  }
+
+  slot_buckets_.pop_back();
+  slot_positions_.pop_back();
+}
+
+void SlotIndex::Clear() {
+  for (std::vector<size_t>& slots : bucket_slots_) {
+    slots.clear();
+  }
+
+  slot_buckets_.clear();
+  slot_positions_.clear();
+}
+
+size_t SlotIndex::Size() const {
+  return slot_buckets_.size();
+}
+
+const std::vector<size_t>& SlotIndex::GetSlots(size_t bucket) const {
+  if (bucket >= bucket_slots_.size()) {
+    return no_slots_;
+  }
+
+  return bucket_slots_[bucket];
+}
+
+}  // namespace idealgas
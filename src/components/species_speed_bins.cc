@@ -0,0 +1,106 @@
+#include "components/species_speed_bins.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+
+const size_t SpeciesSpeedBins::kUnregistered;
+const size_t SpeciesSpeedBins::kMaxReservedBins;
+
+size_t SpeciesSpeedBins::Register(const Color& color, float bin_width) {
+  colors_.push_back(color);
+  speed_bins_.emplace_back(bin_width);
+  max_speeds_.push_back(0);
+  // The new species' bins have nothing reserved yet
+  num_particles_reserved_for_ = kUnregistered;
+  return colors_.size() - 1;
+}
+
+void SpeciesSpeedBins::Update(const ParticleStore& store) {
+  const float* x_velocities = store.GetXVelocities();
+  const float* y_velocities = store.GetYVelocities();
+  const SpeciesId* species_ids = store.GetSpeciesIds();
+
+  for (size_t index = 0; index < colors_.size(); ++index) {
+    speed_bins_[index].Clear();
+    max_speeds_[index] = 0;
+  }
+
+  // Colors are only compared once per store species, so each particle just
+  // looks its species up
+  const SpeciesTable& species_table = store.GetSpeciesTable();
+  indices_by_species_.assign(species_table.Size(), kUnregistered);
+  for (size_t species = 0; species < species_table.Size(); ++species) {
+    for (size_t index = 0; index < colors_.size(); ++index) {
+      if (species_table.GetColor(SpeciesId(species)) == colors_[index]) {
+        indices_by_species_[species] = index;
+        break;
+      }
+    }
+  }
+
+  for (size_t slot = 0; slot < store.Size(); ++slot) {
+    size_t index = indices_by_species_[species_ids[slot]];
+    if (index == kUnregistered) {
+      continue;
+    }
+
+    float speed =
+        ParticleStore::CalculateSpeed(x_velocities[slot], y_velocities[slot]);
+    speed_bins_[index].Add(speed);
+    max_speeds_[index] = std::max(speed, max_speeds_[index]);
+  }
+
+  // Collisions only pass energy around, so the bins only need reserving again
+  // once particles come or go
+  if (store.Size() != num_particles_reserved_for_) {
+    ReserveForEnergy(store);
+    num_particles_reserved_for_ = store.Size();
+  }
+}
+
+void SpeciesSpeedBins::ReserveForEnergy(const ParticleStore& store) {
+  const float* x_velocities = store.GetXVelocities();
+  const float* y_velocities = store.GetYVelocities();
+  const SpeciesId* species_ids = store.GetSpeciesIds();
+  const SpeciesTable& species_table = store.GetSpeciesTable();
+
+  // Twice the total kinetic energy
+  double energy = 0;
+  for (size_t slot = 0; slot < store.Size(); ++slot) {
+    float x_velocity = x_velocities[slot];
+    float y_velocity = y_velocities[slot];
+    energy += double(species_table.GetMass(species_ids[slot])) *
+              (x_velocity * x_velocity + y_velocity * y_velocity);
+  }
+
+  // No particle can go faster than if it held all of the energy, so while the
+  // energy stays put the bins never have to grow again
+  for (size_t species = 0; species < species_table.Size(); ++species) {
+    size_t index = indices_by_species_[species];
+    float mass = species_table.GetMass(SpeciesId(species));
+    if (index == kUnregistered || mass <= 0) {
+      continue;
+    }
+
+    double max_bins =
+        std::sqrt(energy / mass) / speed_bins_[index].GetBinWidth() + 1;
+    speed_bins_[index].Reserve(
+        size_t(std::min(max_bins, double(kMaxReservedBins))));
+  }
+}
+
+const SpeedBins& SpeciesSpeedBins::GetSpeedBins(size_t index) const {
+  return speed_bins_[index];
+}
+
+float SpeciesSpeedBins::GetMaxSpeed(size_t index) const {
+  return max_speeds_[index];
+}
+
+size_t SpeciesSpeedBins::GetNumSpecies() const {
+  return colors_.size();
+}
+
+}  // namespace idealgas
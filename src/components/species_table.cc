@@ -0,0 +1,99 @@
+#include "components/species_table.h"
+
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * Hashes a float so that every pair of floats that compare equal, including
+ * zero and negative zero, hash the same
+ */
+size_t HashFloat(float value) {
+  if (value == 0) {
+    value = 0;
+  }
+
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return std::hash<uint32_t>()(bits);
+}
+
+}  // namespace
+
+const size_t SpeciesTable::kMaxSpecies;
+
+bool SpeciesTable::SpeciesKey::operator==(const SpeciesKey& other) const {
+  return color == other.color && radius == other.radius && mass == other.mass;
+}
+
+size_t SpeciesTable::SpeciesKeyHash::operator()(const SpeciesKey& key) const {
+  size_t hash = 0;
+  for (float value : {key.color.r, key.color.g, key.color.b, key.radius,
+                      key.mass}) {
+    hash = hash * 31 + HashFloat(value);
+  }
+
+  return hash;
+}
+
+SpeciesTable::SpeciesTable() = default;
+
+SpeciesId SpeciesTable::FindOrAdd(const Color& color, float radius,
+                                  float mass) {
+  SpeciesKey key = {color, radius, mass};
+  auto found = species_by_key_.find(key);
+  if (found != species_by_key_.end()) {
+    return found->second;
+  }
+
+  if (colors_.size() == kMaxSpecies) {
+    throw std::length_error("Every species id is already taken");
+  }
+
+  colors_.push_back(color);
+  radii_.push_back(radius);
+  masses_.push_back(mass);
+  SpeciesId species = SpeciesId(colors_.size() - 1);
+  species_by_key_.emplace(key, species);
+  return species;
+}
+
+void SpeciesTable::Clear() {
+  colors_.clear();
+  radii_.clear();
+  masses_.clear();
+  species_by_key_.clear();
+}
+
+size_t SpeciesTable::Size() const {
+  return colors_.size();
+}
+
+const Color& SpeciesTable::GetColor(SpeciesId species) const {
+  return colors_[species];
+}
+
+float SpeciesTable::GetRadius(SpeciesId species) const {
+  return radii_[species];
+}
+
+float SpeciesTable::GetMass(SpeciesId species) const {
+  return masses_[species];
+}
+
+float SpeciesTable::GetMassFactor(SpeciesId species,
+                                  SpeciesId other_species) const {
+  return CalculateMassFactor(masses_[species], masses_[other_species]);
+}
+
+float SpeciesTable::CalculateMassFactor(float mass, float other_mass) {
+  float mass_sum = mass + other_mass;
+  return 2 * other_mass / mass_sum;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,80 @@
+#include "components/speed_bins.h"
+
+#include <algorithm>
+
+namespace idealgas {
+
+SpeedBins::SpeedBins() : SpeedBins(1.0f) {
+}
+
+SpeedBins::SpeedBins(float bin_width) : bin_width_(bin_width), bins_(1, 0) {
+}
+
+const std::vector<size_t>& SpeedBins::Update(
+    const std::vector<Particle*>& particles) {
+  Clear();
+  for (Particle* particle : particles) {
+    Add(particle->GetSpeed());
+  }
+
+  return bins_;
+}
+
+const std::vector<size_t>& SpeedBins::Update(const ParticleStore& store,
+                                             const Color& color) {
+  const float* x_velocities = store.GetXVelocities();
+  const float* y_velocities = store.GetYVelocities();
+
+  Clear();
+  for (size_t slot = 0; slot < store.Size(); ++slot) {
+    if (store.GetColor(slot) == color) {
+      Add(ParticleStore::CalculateSpeed(x_velocities[slot],
+                                        y_velocities[slot]));
+    }
+  }
+
+  return bins_;
+}
+
+void SpeedBins::Clear() {
+  bins_.assign(1, 0);
+}
+
+void SpeedBins::Reserve(size_t num_bins) {
+  bins_.reserve(num_bins);
+}
+
+void SpeedBins::Add(float speed) {
+  // The last bin always holds the fastest particle, exactly as if the bins had
+  // been sized from the fastest speed up front
+  size_t bin = int(speed / bin_width_);
+  if (bin >= bins_.size()) {
+    bins_.resize(bin + 1, 0);
+  }
+
+  ++bins_[bin];
+}
+
+const std::vector<size_t>& SpeedBins::GetBins() const {
+  return bins_;
+}
+
+size_t SpeedBins::GetNumBins() const {
+  return bins_.size();
+}
+
+float SpeedBins::GetBinWidth() const {
+  return bin_width_;
+}
+
+size_t SpeedBins::CalculateMostParticlesInSingleBin() const {
+  size_t max_particles = 0;
+
+  for (const size_t& particle_bin : bins_) {
+    max_particles = std::max(particle_bin, max_particles);
+  }
+
+  return max_particles;
+}
+
+}  // namespace idealgas
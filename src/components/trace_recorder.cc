@@ -0,0 +1,313 @@
+#include "components/trace_recorder.h"
+
+#include <iomanip>
+
+namespace idealgas {
+
+namespace {
+
+// Gives every recorder its own id for the per-thread lookup cache
+std::atomic<size_t> next_recorder_id(1);
+
+/**
+ * Remembers which buffer the calling thread writes to, so recording never
+ * takes the buffers lock, and gives the buffer back when the thread exits
+ */
+struct ThreadBufferCache {
+  ~ThreadBufferCache() {
+    if (claim) {
+      *claim = false;
+    }
+  }
+
+  size_t recorder_id = 0;
+  void* buffer = nullptr;
+  // Points at the buffer's claim flag and keeps the buffer alive
+  std::shared_ptr<std::atomic<bool>> claim;
+};
+
+thread_local ThreadBufferCache thread_buffer_cache;
+
+/**
+ * Writes a string as a JSON string literal
+ */
+void WriteJsonString(std::ostream& output, const char* text) {
+  output << '"';
+  for (const char* character = text; *character != '\0'; ++character) {
+    if (*character == '"' || *character == '\\') {
+      output << '\\' << *character;
+    } else if (static_cast<unsigned char>(*character) < 0x20) {
+      output << ' ';
+    } else {
+      output << *character;
+    }
+  }
+  output << '"';
+}
+
+}  // namespace
+
+const size_t TraceRecorder::kMaxEventsPerThread;
+const size_t TraceRecorder::kMaxThreads;
+
+TraceRecorder::ScopedEvent::ScopedEvent(TraceRecorder* recorder,
+                                        const char* name)
+    : recorder_(recorder),
+      name_(name),
+      is_recording_(recorder->IsRecording()) {
+  // Reading the clock is skipped entirely while nothing is being recorded
+  if (is_recording_) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+TraceRecorder::ScopedEvent::~ScopedEvent() {
+  if (is_recording_) {
+    recorder_->Record(name_, start_, std::chrono::steady_clock::now());
+  }
+}
+
+TraceRecorder::TraceRecorder()
+    : id_(next_recorder_id++),
+      epoch_(std::chrono::steady_clock::now()),
+      is_recording_(false),
+      frames_remaining_(0),
+      generation_(0),
+      num_unbuffered_events_(0) {
+}
+
+TraceRecorder& TraceRecorder::GetInstance() {
+  static TraceRecorder instance;
+  return instance;
+}
+
+void TraceRecorder::Start(size_t num_frames) {
+  is_recording_ = false;
+  frames_remaining_ = num_frames;
+  ++generation_;
+  num_unbuffered_events_ = 0;
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    CacheThreadBuffer(ClaimThreadBuffer());
+  }
+  is_recording_ = num_frames > 0;
+}
+
+void TraceRecorder::Stop() {
+  is_recording_ = false;
+}
+
+bool TraceRecorder::IsRecording() const {
+  return is_recording_.load(std::memory_order_relaxed);
+}
+
+void TraceRecorder::MarkFrame() {
+  if (!IsRecording()) {
+    return;
+  }
+
+  // Only the frame that brings the count to zero ends the window
+  if (frames_remaining_.fetch_sub(1) == 1) {
+    is_recording_ = false;
+  }
+}
+
+void TraceRecorder::NameThisThread(const char* name) {
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  ThreadBuffer* buffer = ClaimThreadBuffer();
+  if (buffer != nullptr) {
+    buffer->thread_name = name;
+  }
+  CacheThreadBuffer(buffer);
+}
+
+void TraceRecorder::Record(const char* name,
+                           std::chrono::steady_clock::time_point start,
+                           std::chrono::steady_clock::time_point end) {
+  if (!IsRecording()) {
+    return;
+  }
+
+  ThreadBuffer* buffer = GetThreadBuffer();
+  if (buffer == nullptr) {
+    num_unbuffered_events_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  size_t num_events = buffer->num_events.load(std::memory_order_relaxed);
+  if (num_events == buffer->events.size()) {
+    buffer->num_dropped_events.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  TraceEvent& event = buffer->events[num_events];
+  event.name = name;
+  event.start = start;
+  event.end = end;
+  buffer->num_events.store(num_events + 1, std::memory_order_release);
+}
+
+size_t TraceRecorder::GetNumEvents() const {
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  size_t generation = generation_;
+  size_t num_events = 0;
+  for (const std::shared_ptr<ThreadBuffer>& buffer : buffers_) {
+    if (buffer->generation == generation) {
+      num_events += buffer->num_events.load(std::memory_order_acquire);
+    }
+  }
+
+  return num_events;
+}
+
+size_t TraceRecorder::GetNumDroppedEvents() const {
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  size_t generation = generation_;
+  size_t num_dropped_events = num_unbuffered_events_;
+  for (const std::shared_ptr<ThreadBuffer>& buffer : buffers_) {
+    if (buffer->generation == generation) {
+      num_dropped_events += buffer->num_dropped_events;
+    }
+  }
+
+  return num_dropped_events;
+}
+
+void TraceRecorder::WriteJson(std::ostream& output) const {
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  size_t generation = generation_;
+
+  output << "{\"traceEvents\":[";
+  bool is_first_event = true;
+  output << std::fixed << std::setprecision(3);
+
+  for (size_t thread = 0; thread < buffers_.size(); ++thread) {
+    const ThreadBuffer& buffer = *buffers_[thread];
+    if (buffer.thread_name != nullptr) {
+      output << (is_first_event ? "" : ",")
+             << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+             << thread << ",\"args\":{\"name\":";
+      WriteJsonString(output, buffer.thread_name);
+      output << "}}";
+      is_first_event = false;
+    }
+
+    if (buffer.generation != generation) {
+      continue;
+    }
+
+    // Events added after this load are left for a later write
+    size_t num_events = buffer.num_events.load(std::memory_order_acquire);
+    for (size_t index = 0; index < num_events; ++index) {
+      const TraceEvent& event = buffer.events[index];
+      std::chrono::duration<double, std::micro> start = event.start - epoch_;
+      std::chrono::duration<double, std::micro> duration =
+          event.end - event.start;
+
+      output << (is_first_event ? "" : ",") << "\n{\"name\":";
+      WriteJsonString(output, event.name);
+      output << ",\"cat\":\"idealgas\",\"ph\":\"X\",\"ts\":" << start.count()
+             << ",\"dur\":" << duration.count() << ",\"pid\":1,\"tid\":"
+             << thread << "}";
+      is_first_event = false;
+    }
+  }
+
+  output << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::GetThreadBuffer() {
+  ThreadBufferCache& cache = thread_buffer_cache;
+  if (cache.recorder_id != id_) {
+    // Only a thread switching between recorders gets here, and it never
+    // allocates; a thread that never claimed a buffer caches null
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    CacheThreadBuffer(FindThreadBuffer());
+  }
+
+  ThreadBuffer* buffer = static_cast<ThreadBuffer*>(cache.buffer);
+  if (buffer == nullptr) {
+    return nullptr;
+  }
+
+  // The buffer is only ever emptied by its own thread, so it can't be in the
+  // middle of adding an event; its memory is kept for the next window
+  size_t generation = generation_.load(std::memory_order_relaxed);
+  if (buffer->generation.load(std::memory_order_relaxed) != generation) {
+    buffer->num_events = 0;
+    buffer->num_dropped_events = 0;
+    buffer->generation = generation;
+  }
+
+  return buffer;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::ClaimThreadBuffer() {
+  ThreadBuffer* thread_buffer = FindThreadBuffer();
+  if (thread_buffer != nullptr) {
+    return thread_buffer;
+  }
+
+  // A slot left by an exited thread is only taken over once its events are
+  // no longer part of the window being recorded
+  size_t generation = generation_;
+  for (const std::shared_ptr<ThreadBuffer>& buffer : buffers_) {
+    if (!buffer->is_claimed &&
+        (buffer->generation != generation || buffer->num_events == 0)) {
+      thread_buffer = buffer.get();
+      break;
+    }
+  }
+
+  if (thread_buffer == nullptr) {
+    if (buffers_.size() == kMaxThreads) {
+      return nullptr;
+    }
+
+    buffers_.emplace_back(new ThreadBuffer());
+    thread_buffer = buffers_.back().get();
+    thread_buffer->events.resize(kMaxEventsPerThread);
+    thread_buffer->num_events = 0;
+    thread_buffer->num_dropped_events = 0;
+    thread_buffer->generation = generation;
+  }
+
+  thread_buffer->thread_id = std::this_thread::get_id();
+  thread_buffer->thread_name = nullptr;
+  thread_buffer->is_claimed = true;
+  return thread_buffer;
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::FindThreadBuffer() {
+  std::thread::id thread_id = std::this_thread::get_id();
+  for (const std::shared_ptr<ThreadBuffer>& buffer : buffers_) {
+    if (buffer->thread_id == thread_id) {
+      return buffer.get();
+    }
+  }
+
+  return nullptr;
+}
+
+void TraceRecorder::CacheThreadBuffer(ThreadBuffer* buffer) {
+  ThreadBufferCache& cache = thread_buffer_cache;
+  if (cache.buffer == buffer && cache.recorder_id == id_) {
+    return;
+  }
+
+  if (cache.claim) {
+    *cache.claim = false;
+  }
+  cache.recorder_id = id_;
+  cache.buffer = buffer;
+  cache.claim.reset();
+  for (const std::shared_ptr<ThreadBuffer>& shared_buffer : buffers_) {
+    if (shared_buffer.get() == buffer) {
+      buffer->is_claimed = true;
+      cache.claim = std::shared_ptr<std::atomic<bool>>(shared_buffer,
+                                                       &buffer->is_claimed);
+    }
+  }
+}
+
+}  // namespace idealgas
@@ -0,0 +1,196 @@
+#include "components/work_stealing_pool.h"
+
+#include <algorithm>
+
+namespace idealgas {
+
+namespace {
+
+uint64_t PackChunks(size_t first, size_t end) {
+  return (uint64_t(first) << 32) | uint64_t(end);
+}
+
+size_t GetFirstChunk(uint64_t chunks) {
+  return size_t(chunks >> 32);
+}
+
+size_t GetEndChunk(uint64_t chunks) {
+  return size_t(chunks & 0xFFFFFFFF);
+}
+
+}  // namespace
+
+const size_t WorkStealingPool::kChunksPerThread;
+
+WorkStealingPool::WorkStealingPool(size_t num_threads)
+    : num_threads_(0),
+      num_steals_(0),
+      generation_(0),
+      num_busy_workers_(0),
+      is_stopping_(false),
+      function_(nullptr),
+      task_(nullptr),
+      count_(0),
+      grain_size_(1) {
+  SetNumThreads(num_threads);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  StopWorkers();
+}
+
+void WorkStealingPool::SetNumThreads(size_t num_threads) {
+  num_threads = std::max(num_threads, size_t(1));
+  if (num_threads == num_threads_) {
+    return;
+  }
+
+  StopWorkers();
+  num_threads_ = num_threads;
+  shares_.reset(new ChunkShare[num_threads_]);
+  for (size_t thread = 0; thread < num_threads_; ++thread) {
+    shares_[thread].chunks = PackChunks(0, 0);
+  }
+
+  is_stopping_ = false;
+  workers_.reserve(num_threads_ - 1);
+  for (size_t thread = 1; thread < num_threads_; ++thread) {
+    workers_.push_back(
+        std::thread(&WorkStealingPool::WorkerLoop, this, thread, generation_));
+  }
+}
+
+size_t WorkStealingPool::GetNumThreads() const {
+  return num_threads_;
+}
+
+size_t WorkStealingPool::CalculateGrainSize(size_t count,
+                                            size_t min_grain_size) const {
+  size_t num_chunks = num_threads_ * kChunksPerThread;
+  return std::max((count + num_chunks - 1) / num_chunks,
+                  std::max(min_grain_size, size_t(1)));
+}
+
+size_t WorkStealingPool::GetNumSteals() const {
+  return num_steals_;
+}
+
+void WorkStealingPool::Run(size_t count, size_t grain_size,
+                           ChunkFunction function, const void* task) {
+  grain_size = std::max(grain_size, size_t(1));
+  size_t num_chunks = (count + grain_size - 1) / grain_size;
+  if (num_chunks <= 1 || workers_.empty()) {
+    for (size_t begin = 0; begin < count; begin += grain_size) {
+      function(task, begin, std::min(begin + grain_size, count), 0);
+    }
+    return;
+  }
+
+  for (size_t thread = 0; thread < num_threads_; ++thread) {
+    shares_[thread].chunks =
+        PackChunks(num_chunks * thread / num_threads_,
+                   num_chunks * (thread + 1) / num_threads_);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    function_ = function;
+    task_ = task;
+    count_ = count;
+    grain_size_ = grain_size;
+    num_busy_workers_ = workers_.size();
+    ++generation_;
+  }
+  job_posted_.notify_all();
+
+  RunChunks(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  job_finished_.wait(lock, [this]() { return num_busy_workers_ == 0; });
+}
+
+void WorkStealingPool::WorkerLoop(size_t thread, size_t generation) {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      job_posted_.wait(lock, [&]() {
+        return is_stopping_ || generation_ != generation;
+      });
+      if (is_stopping_) {
+        return;
+      }
+      generation = generation_;
+    }
+
+    RunChunks(thread);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--num_busy_workers_ == 0) {
+      job_finished_.notify_one();
+    }
+  }
+}
+
+void WorkStealingPool::RunChunks(size_t thread) {
+  size_t chunk;
+  while (TakeChunk(thread, &chunk) || StealChunk(thread, &chunk)) {
+    size_t begin = chunk * grain_size_;
+    function_(task_, begin, std::min(begin + grain_size_, count_), thread);
+  }
+}
+
+bool WorkStealingPool::TakeChunk(size_t thread, size_t* chunk) {
+  std::atomic<uint64_t>& share = shares_[thread].chunks;
+  uint64_t chunks = share.load();
+  while (GetFirstChunk(chunks) < GetEndChunk(chunks)) {
+    if (share.compare_exchange_weak(
+            chunks,
+            PackChunks(GetFirstChunk(chunks) + 1, GetEndChunk(chunks)))) {
+      *chunk = GetFirstChunk(chunks);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool WorkStealingPool::StealChunk(size_t thread, size_t* chunk) {
+  for (size_t offset = 1; offset < num_threads_; ++offset) {
+    size_t victim = (thread + offset) % num_threads_;
+    std::atomic<uint64_t>& share = shares_[victim].chunks;
+    uint64_t chunks = share.load();
+
+    while (GetFirstChunk(chunks) < GetEndChunk(chunks)) {
+      size_t first = GetFirstChunk(chunks);
+      size_t end = GetEndChunk(chunks);
+      size_t middle = first + (end - first) / 2;
+      if (!share.compare_exchange_weak(chunks, PackChunks(first, middle))) {
+        continue;
+      }
+
+      // Only this thread adds to its own share, and it is empty, so the
+      // stolen chunks can be stored outright
+      shares_[thread].chunks = PackChunks(middle + 1, end);
+      ++num_steals_;
+      *chunk = middle;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void WorkStealingPool::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    is_stopping_ = true;
+  }
+  job_posted_.notify_all();
+
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+}  // namespace idealgas
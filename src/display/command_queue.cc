@@ -0,0 +1,57 @@
+#include "display/command_queue.h"
+
+namespace idealgas {
+
+CommandQueue::CommandQueue(size_t capacity) {
+  head_.value = 0;
+  tail_.value = 0;
+
+  size_t rounded_capacity = 1;
+  while (rounded_capacity < capacity) {
+    rounded_capacity *= 2;
+  }
+
+  commands_.resize(rounded_capacity);
+  index_mask_ = rounded_capacity - 1;
+}
+
+bool CommandQueue::TryPush(const SimulationCommand& command) {
+  size_t tail = tail_.value.load(std::memory_order_relaxed);
+  if (tail - head_.value.load(std::memory_order_acquire) == commands_.size()) {
+    return false;
+  }
+
+  commands_[tail & index_mask_] = command;
+  // Publishes the command to the consumer
+  tail_.value.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+bool CommandQueue::TryPop(SimulationCommand* command) {
+  size_t head = head_.value.load(std::memory_order_relaxed);
+  if (head == tail_.value.load(std::memory_order_acquire)) {
+    return false;
+  }
+
+  *command = commands_[head & index_mask_];
+  // Hands the slot back to the producer
+  head_.value.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+size_t CommandQueue::DrainInto(GasContainer* container) {
+  size_t num_applied = 0;
+  SimulationCommand command;
+  while (TryPop(&command)) {
+    command.ApplyTo(container);
+    ++num_applied;
+  }
+
+  return num_applied;
+}
+
+size_t CommandQueue::GetCapacity() const {
+  return commands_.size();
+}
+
+}  // namespace idealgas
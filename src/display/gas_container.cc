@@ -1,113 +1,431 @@
 #include "display/gas_container.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+
 namespace idealgas {
 
+namespace {
+
+// Every particle costs the same to check against the walls, so chunks only
+// need to be big enough to outweigh handing them out
+const size_t kMinParticlesPerWallChunk = 4096;
+
+// Measuring the spread is a pass over every particle, so between sorts it is
+// only checked this many frames apart
+const size_t kSpreadCheckFrames = 16;
+
+}  // namespace
+
+const float GasContainer::kTreeRadiusRatio = 4.0f;
+const float GasContainer::kReorderSpreadRatio = 2.0f;
+
 GasContainer::GasContainer(const std::vector<Particle*>& initial_particles,
                            size_t num_rand_particles,
                            const glm::vec2& top_left_corner,
                            const glm::vec2& bottom_right_corner,
                            float default_particle_radius,
                            float default_particle_mass,
-                           const ci::Color& default_particle_color) {
+                           const Color& default_particle_color) {
   top_left_corner_ = top_left_corner;
   bottom_right_corner_ = bottom_right_corner;
   default_particle_radius_ = default_particle_radius;
   default_particle_mass_ = default_particle_mass;
   default_particle_color_ = default_particle_color;
+  ShareTaskPool();
   physics_ = CollisionPhysics(top_left_corner, bottom_right_corner);
+  event_engine_ = EventDrivenEngine(top_left_corner, bottom_right_corner);
+  store_.Reserve(num_rand_particles + initial_particles.size());
   GasContainer::AddRandomParticles(num_rand_particles);
 
-  particles_.insert(particles_.end(), initial_particles.begin(),
-                    initial_particles.end());
+  for (Particle* particle : initial_particles) {
+    GasContainer::AddParticleToContainer(particle);
+  }
+}
+
+GasContainer::GasContainer() {
+  ShareTaskPool();
 }
 
-GasContainer::GasContainer() = default;
+GasContainer::GasContainer(const GasContainer& other)
+    : store_(other.store_),
+      species_index_(other.species_index_),
+      color_index_(other.color_index_),
+      color_groups_(other.color_groups_),
+      top_left_corner_(other.top_left_corner_),
+      bottom_right_corner_(other.bottom_right_corner_),
+      default_particle_radius_(other.default_particle_radius_),
+      default_particle_mass_(other.default_particle_mass_),
+      default_particle_color_(other.default_particle_color_),
+      physics_(other.physics_),
+      broad_phase_(other.broad_phase_),
+      task_pool_(other.task_pool_.GetNumThreads()),
+      neighbour_list_(other.neighbour_list_),
+      sweep_and_prune_(other.sweep_and_prune_),
+      aabb_tree_(other.aabb_tree_),
+      particle_ids_(other.particle_ids_),
+      reorder_interval_(other.reorder_interval_),
+      frames_since_reorder_(other.frames_since_reorder_),
+      sorted_spread_(other.sorted_spread_),
+      stepping_mode_(other.stepping_mode_),
+      event_engine_(other.event_engine_),
+      profiler_(other.profiler_) {
+  ShareTaskPool();
+  RebindParticleViews();
+}
+
+GasContainer& GasContainer::operator=(const GasContainer& other) {
+  store_ = other.store_;
+  species_index_ = other.species_index_;
+  color_index_ = other.color_index_;
+  color_groups_ = other.color_groups_;
+  top_left_corner_ = other.top_left_corner_;
+  bottom_right_corner_ = other.bottom_right_corner_;
+  default_particle_radius_ = other.default_particle_radius_;
+  default_particle_mass_ = other.default_particle_mass_;
+  default_particle_color_ = other.default_particle_color_;
+  physics_ = other.physics_;
+  broad_phase_ = other.broad_phase_;
+  neighbour_list_ = other.neighbour_list_;
+  sweep_and_prune_ = other.sweep_and_prune_;
+  aabb_tree_ = other.aabb_tree_;
+  SetNumThreads(other.GetNumThreads());
+  particle_ids_ = other.particle_ids_;
+  reorder_interval_ = other.reorder_interval_;
+  frames_since_reorder_ = other.frames_since_reorder_;
+  sorted_spread_ = other.sorted_spread_;
+  stepping_mode_ = other.stepping_mode_;
+  event_engine_ = other.event_engine_;
+  profiler_ = other.profiler_;
+  RebindParticleViews();
+  return *this;
+}
 
 GasContainer::~GasContainer() {
-  particles_.clear();
+  particle_views_.clear();
+  store_.Clear();
 }
 
-void GasContainer::Display() const {
-  for (Particle* current_particle : particles_) {
-    ci::gl::color(current_particle->GetColor());
-    ci::gl::drawSolidCircle(current_particle->GetPosition(),
-                            current_particle->GetRadius());
+void GasContainer::AdvanceOneFrame() {
+  {
+    IDEALGAS_TRACE_SCOPE("advance frame");
+    IDEALGAS_PROFILE_BEGIN_FRAME(&profiler_);
+
+    if (reorder_interval_ > 0) {
+      IDEALGAS_PROFILE_PHASE(&profiler_, ProfilePhase::kReorder);
+      ++frames_since_reorder_;
+      if (frames_since_reorder_ >= reorder_interval_ ||
+          (frames_since_reorder_ % kSpreadCheckFrames == 0 &&
+           MortonOrder::CalculateSpread(store_) >
+               kReorderSpreadRatio * sorted_spread_)) {
+        ReorderParticles();
+      }
+    }
+
+    if (stepping_mode_ == SteppingMode::kEventDriven) {
+      AdvanceEventDriven();
+    } else {
+      AdvanceFixedStep();
+    }
+
+    IDEALGAS_PROFILE_END_FRAME(&profiler_);
   }
-  ci::gl::color(ci::Color("white"));
-  ci::gl::drawStrokedRect(ci::Rectf(top_left_corner_, bottom_right_corner_));
+
+  // Counted once the frame's own event is in, so the last frame of a trace
+  // window isn't cut off
+  IDEALGAS_TRACE_FRAME();
 }
 
-void GasContainer::AdvanceOneFrame() {
+void GasContainer::AdvanceFixedStep() {
   // Check if there are any collisions on this frame
-  GasContainer::DetermineWallCollisions();
-  GasContainer::DetermineParticleCollisions();
+  {
+    IDEALGAS_PROFILE_PHASE(&profiler_, ProfilePhase::kWallCollisions);
+    GasContainer::DetermineWallCollisions();
+  }
+  {
+    IDEALGAS_PROFILE_PHASE(&profiler_, ProfilePhase::kParticleCollisions);
+    GasContainer::DetermineParticleCollisions();
+  }
 
   // Update the position of all of the particles
-  for (Particle* current_particle : particles_) {
-    current_particle->UpdatePosition();
+  IDEALGAS_PROFILE_PHASE(&profiler_, ProfilePhase::kPositionUpdate);
+  float* x_positions = store_.GetXPositions();
+  float* y_positions = store_.GetYPositions();
+  const float* x_velocities = store_.GetXVelocities();
+  const float* y_velocities = store_.GetYVelocities();
+
+  for (size_t slot = 0; slot < store_.Size(); ++slot) {
+    x_positions[slot] += x_velocities[slot];
+    y_positions[slot] += y_velocities[slot];
   }
 }
 
-std::vector<Particle*> GasContainer::GetParticles() {
-  return particles_;
+void GasContainer::AdvanceEventDriven() {
+  IDEALGAS_PROFILE_PHASE(&profiler_, ProfilePhase::kEventDriven);
+  size_t collisions_before = event_engine_.GetNumCollisions();
+  size_t wall_bounces_before = event_engine_.GetNumWallBounces();
+
+  event_engine_.Advance(&store_, physics_, 1.0f);
+
+  // The engine counts wall bounces among its collisions
+  size_t num_wall_bounces =
+      event_engine_.GetNumWallBounces() - wall_bounces_before;
+  size_t num_collisions =
+      event_engine_.GetNumCollisions() - collisions_before - num_wall_bounces;
+  IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kCollisions,
+                         num_collisions);
+  IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kWallBounces,
+                         num_wall_bounces);
 }
 
-std::vector<Particle*> GasContainer::GetParticlesByColor(
-    const ci::Color& color) {
-  std::vector<Particle*> colored_particles;
+void GasContainer::SetSteppingMode(SteppingMode mode) {
+  stepping_mode_ = mode;
+  event_engine_.Invalidate();
+}
 
-  for (Particle* particle : particles_) {
-    if (particle->GetColor() == color) {
-      colored_particles.push_back(particle);
+SteppingMode GasContainer::GetSteppingMode() const {
+  return stepping_mode_;
+}
+
+void GasContainer::SetBroadPhase(BroadPhase broad_phase) {
+  broad_phase_ = broad_phase;
+  neighbour_list_.Invalidate();
+  sweep_and_prune_.Invalidate();
+  aabb_tree_.Invalidate();
+}
+
+BroadPhase GasContainer::GetBroadPhase() const {
+  return broad_phase_;
+}
+
+BroadPhase GasContainer::GetActiveBroadPhase() const {
+  if (broad_phase_ != BroadPhase::kAutomatic) {
+    return broad_phase_;
+  }
+
+  // Only the species that have particles in the container count, and there
+  // are only a handful of them
+  const SpeciesTable& species_table = store_.GetSpeciesTable();
+  float min_radius = std::numeric_limits<float>::max();
+  float max_radius = 0;
+  for (size_t species = 0; species < species_table.Size(); ++species) {
+    if (species_index_.GetSlots(species).empty()) {
+      continue;
     }
+
+    float radius = species_table.GetRadius(SpeciesId(species));
+    min_radius = std::min(min_radius, radius);
+    max_radius = std::max(max_radius, radius);
+  }
+
+  if (max_radius > kTreeRadiusRatio * min_radius) {
+    return BroadPhase::kAabbTree;
   }
 
-  return colored_particles;
+  return BroadPhase::kUniformGrid;
+}
+
+void GasContainer::SetNeighbourSkin(float skin) {
+  neighbour_list_.SetSkin(skin);
+}
+
+float GasContainer::GetNeighbourSkin() const {
+  return neighbour_list_.GetSkin();
+}
+
+void GasContainer::SetReorderInterval(size_t num_frames) {
+  reorder_interval_ = num_frames;
+  frames_since_reorder_ = 0;
+  // Until the first sort, particles only count as drifting once they are
+  // further out of order than they are now
+  if (reorder_interval_ > 0) {
+    sorted_spread_ = MortonOrder::CalculateSpread(store_);
+  }
+}
+
+size_t GasContainer::GetReorderInterval() const {
+  return reorder_interval_;
+}
+
+void GasContainer::ReorderParticles() {
+  const std::vector<size_t>& order =
+      morton_order_.Sort(store_, top_left_corner_, bottom_right_corner_);
+  reordered_store_.GatherFrom(store_, order);
+  // Views point at store_ itself, so they see the sorted particles as is
+  std::swap(store_, reordered_store_);
+  particle_ids_.Reorder(order);
+
+  // Both indexes keep their buckets' memory when cleared
+  species_index_.Clear();
+  color_index_.Clear();
+  for (size_t slot = 0; slot < store_.Size(); ++slot) {
+    SpeciesId species = store_.GetSpecies(slot);
+    species_index_.Add(species);
+    color_index_.Add(color_groups_[species]);
+  }
+
+  neighbour_list_.Invalidate();
+  sweep_and_prune_.Invalidate();
+  aabb_tree_.Invalidate();
+  event_engine_.Invalidate();
+  sorted_spread_ = MortonOrder::CalculateSpread(store_);
+  frames_since_reorder_ = 0;
+  IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kReorders, 1);
+}
+
+size_t GasContainer::GetParticleId(size_t slot) const {
+  return particle_ids_.GetId(slot);
+}
+
+size_t GasContainer::GetParticleSlot(size_t id) const {
+  return particle_ids_.GetSlot(id);
+}
+
+void GasContainer::SetNumThreads(size_t num_threads) {
+  task_pool_.SetNumThreads(num_threads);
+  ShareTaskPool();
+}
+
+size_t GasContainer::GetNumThreads() const {
+  return task_pool_.GetNumThreads();
+}
+
+ParticleRange GasContainer::GetParticles() {
+  return ParticleRange(particle_views_.data(), particle_views_.size());
+}
+
+const ParticleStore& GasContainer::GetParticleStore() const {
+  return store_;
+}
+
+const FrameProfiler& GasContainer::GetProfiler() const {
+  return profiler_;
+}
+
+ParticleRange GasContainer::GetParticlesByColor(const Color& color) {
+  // Only species seen in this container have a color group, and the first
+  // species of a color is the group every other species of that color joins
+  for (size_t species = 0; species < color_groups_.size(); ++species) {
+    if (store_.GetSpeciesTable().GetColor(SpeciesId(species)) == color) {
+      const std::vector<size_t>& slots =
+          color_index_.GetSlots(color_groups_[species]);
+      return ParticleRange(particle_views_.data(), slots.data(), slots.size());
+    }
+  }
+
+  return ParticleRange();
+}
+
+ParticleRange GasContainer::GetParticlesBySpecies(SpeciesId species) {
+  const std::vector<size_t>& slots = species_index_.GetSlots(species);
+  return ParticleRange(particle_views_.data(), slots.data(), slots.size());
 }
 
 void GasContainer::ModifyParticlesSpeed(const glm::vec2& delta_velocity,
                                         bool should_increase_speed) {
-  for (Particle* current_particle : particles_) {
-    current_particle->UpdateVelocity(delta_velocity, should_increase_speed);
+  float* x_velocities = store_.GetXVelocities();
+  float* y_velocities = store_.GetYVelocities();
+
+  for (size_t slot = 0; slot < store_.Size(); ++slot) {
+    x_velocities[slot] = Particle::AdjustVelocityComponent(
+        x_velocities[slot], delta_velocity.x, should_increase_speed);
+    y_velocities[slot] = Particle::AdjustVelocityComponent(
+        y_velocities[slot], delta_velocity.y, should_increase_speed);
   }
+
+  event_engine_.Invalidate();
 }
 
 void GasContainer::DetermineParticleCollisions() {
-  for (size_t particle_1_idx = 0; particle_1_idx < particles_.size() - 1;
-       ++particle_1_idx) {
-    // Compare all of the particles with each the first particle past this point
-    for (size_t particle_2_idx = particle_1_idx + 1;
-         particle_2_idx < particles_.size(); ++particle_2_idx) {
-      Particle* particle1 = particles_[particle_1_idx];
-      Particle* particle2 = particles_[particle_2_idx];
-
-      if (physics_.DidParticlesCollide(*particle1, *particle2)) {
-        physics_.UpdateCollidedParticleVelocities(particle1, particle2);
+  switch (GetActiveBroadPhase()) {
+    case BroadPhase::kVerletList:
+      if (neighbour_list_.Update(store_, top_left_corner_,
+                                 bottom_right_corner_)) {
+        IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kNeighbourRebuilds,
+                               1);
       }
-    }
+      CollideNeighbours(neighbour_list_);
+      break;
+    case BroadPhase::kSweepAndPrune:
+      sweep_and_prune_.Update(store_);
+      CollideNeighbours(sweep_and_prune_);
+      break;
+    case BroadPhase::kAabbTree:
+      aabb_tree_.Update(store_);
+      CollideNeighbours(aabb_tree_);
+      break;
+    default:
+      grid_.Rebuild(store_, top_left_corner_, bottom_right_corner_);
+      CollideNeighbours(grid_);
+      break;
   }
 }
 
-void GasContainer::DetermineWallCollisions() {
-  for (Particle* current_particle : particles_) {
-    float x_velocity = current_particle->GetVelocity().x;
-    float y_velocity = current_particle->GetVelocity().y;
+template <typename NeighbourSource>
+void GasContainer::CollideNeighbours(const NeighbourSource& neighbour_source) {
+  if (task_pool_.GetNumThreads() > 1) {
+    IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kCollisions,
+                           collision_resolver_.ResolveCollisions(
+                               &store_, neighbour_source, physics_));
+    IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kPairTests,
+                           collision_resolver_.GetNumPairTests());
+    return;
+  }
 
-    if (physics_.IsParticleCollidingWithTopWall(*current_particle) ||
-        physics_.IsParticleCollidingWithBottomWall(*current_particle)) {
-      current_particle->SetVelocity(glm::vec2(x_velocity, -y_velocity));
+  // No particle can have more candidates than there are particles, so after
+  // this the candidate list never grows mid-frame
+  collision_candidates_.reserve(store_.Size());
 
-      // Update y_velocity properly if particle is also colliding with sides
-      y_velocity = -y_velocity;
-    }
+  for (size_t particle_1_idx = 0; particle_1_idx < store_.Size();
+       ++particle_1_idx) {
+    // Only the broad phase's candidates past this point can be touching
+    neighbour_source.GatherNeighbourCandidates(particle_1_idx,
+                                               &collision_candidates_);
+    IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kPairTests,
+                           collision_candidates_.size());
 
-    if (physics_.IsParticleCollidingWithRightWall(*current_particle) ||
-        physics_.IsParticleCollidingWithLeftWall(*current_particle)) {
-      current_particle->SetVelocity(glm::vec2(-x_velocity, y_velocity));
+    for (size_t particle_2_idx : collision_candidates_) {
+      CollideParticles(particle_1_idx, particle_2_idx);
     }
   }
 }
 
+void GasContainer::CollideParticles(size_t slot1, size_t slot2) {
+  if (physics_.DidParticlesCollide(store_, slot1, slot2)) {
+    physics_.UpdateCollidedParticleVelocities(&store_, slot1, slot2);
+    IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kCollisions, 1);
+  }
+}
+
+void GasContainer::DetermineWallCollisions() {
+  size_t num_particles = store_.Size();
+  auto reflect_chunk = [&](size_t begin, size_t end, size_t thread) {
+    thread_wall_bounces_[thread] +=
+        physics_.ReflectWallCollisions(&store_, begin, end);
+  };
+
+  std::fill(thread_wall_bounces_.begin(), thread_wall_bounces_.end(), 0);
+  task_pool_.ParallelFor(
+      num_particles,
+      task_pool_.CalculateGrainSize(num_particles, kMinParticlesPerWallChunk),
+      reflect_chunk);
+
+  size_t num_bounces = 0;
+  for (size_t thread_bounces : thread_wall_bounces_) {
+    num_bounces += thread_bounces;
+  }
+  IDEALGAS_PROFILE_COUNT(&profiler_, ProfileCounter::kWallBounces,
+                         num_bounces);
+}
+
+void GasContainer::ShareTaskPool() {
+  grid_.SetTaskPool(&task_pool_);
+  collision_resolver_.SetTaskPool(&task_pool_);
+  thread_wall_bounces_.assign(task_pool_.GetNumThreads(), 0);
+}
+
 void GasContainer::AddRandomParticles(size_t particle_count) {
   for (size_t particle = 0; particle < particle_count; ++particle) {
     glm::vec2 rand_position = GasContainer::CalculateRandomInitialPosition();
@@ -118,15 +436,84 @@ void GasContainer::AddRandomParticles(size_t particle_count) {
 void GasContainer::AddParticleToContainer(const glm::vec2& new_position) {
   glm::vec2 new_velocity =
       GasContainer::CalculateRandomInitialVelocity(default_particle_radius_);
-  ci::Color color(default_particle_color_);
-  Particle* new_particle =
-      new Particle(new_position, new_velocity, color, default_particle_radius_,
-                   default_particle_mass_);
-  particles_.push_back(new_particle);
+  size_t slot =
+      store_.Add(new_position, new_velocity, default_particle_color_,
+                 default_particle_radius_, default_particle_mass_);
+  TrackAddedParticle(slot);
 }
 
 void GasContainer::AddParticleToContainer(Particle* particle) {
-  particles_.push_back(particle);
+  AddParticleToContainer(*particle);
+}
+
+void GasContainer::AddParticleToContainer(const Particle& particle) {
+  size_t slot = store_.Add(particle.GetPosition(), particle.GetVelocity(),
+                           particle.GetColor(), particle.GetRadius(),
+                           particle.GetMass());
+  TrackAddedParticle(slot);
+}
+
+void GasContainer::RemoveParticle(size_t slot) {
+  // Views are indexed by slot, so the view of the moved particle is already
+  // in place and only the last one has to go
+  store_.Remove(slot);
+  particle_views_.pop_back();
+  species_index_.Remove(slot);
+  color_index_.Remove(slot);
+  particle_ids_.Remove(slot);
+  neighbour_list_.Invalidate();
+  sweep_and_prune_.Invalidate();
+  aabb_tree_.Invalidate();
+  event_engine_.Invalidate();
+}
+
+void GasContainer::ClearParticles() {
+  store_.Clear();
+  particle_views_.clear();
+  species_index_.Clear();
+  color_index_.Clear();
+  particle_ids_.Clear();
+  neighbour_list_.Invalidate();
+  sweep_and_prune_.Invalidate();
+  aabb_tree_.Invalidate();
+  event_engine_.Invalidate();
+}
+
+void GasContainer::TrackAddedParticle(size_t slot) {
+  particle_views_.push_back(ParticleView(&store_, slot));
+
+  // Species are never removed from the store's table, so a new one only needs
+  // its color group worked out once
+  const SpeciesTable& species_table = store_.GetSpeciesTable();
+  while (color_groups_.size() < species_table.Size()) {
+    SpeciesId species = SpeciesId(color_groups_.size());
+    SpeciesId group = species;
+    for (SpeciesId earlier = 0; earlier < species; ++earlier) {
+      if (species_table.GetColor(earlier) == species_table.GetColor(species)) {
+        group = earlier;
+        break;
+      }
+    }
+    color_groups_.push_back(group);
+  }
+
+  SpeciesId species = store_.GetSpecies(slot);
+  species_index_.Add(species);
+  color_index_.Add(color_groups_[species]);
+  particle_ids_.Add();
+  neighbour_list_.Invalidate();
+  sweep_and_prune_.Invalidate();
+  aabb_tree_.Invalidate();
+  event_engine_.Invalidate();
+}
+
+void GasContainer::RebindParticleViews() {
+  particle_views_.clear();
+  particle_views_.reserve(store_.Size());
+
+  for (size_t slot = 0; slot < store_.Size(); ++slot) {
+    particle_views_.push_back(ParticleView(&store_, slot));
+  }
 }
 
 float GasContainer::GenerateRandomNumber(float min, float max) const {
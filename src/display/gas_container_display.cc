@@ -0,0 +1,29 @@
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+// Drawing is kept apart from the rest of GasContainer so the simulation core
+// builds without Cinder; this file is only compiled into the Cinder targets.
+
+namespace idealgas {
+
+void GasContainer::Display() const {
+  Display(store_);
+}
+
+void GasContainer::Display(const ParticleStore& snapshot) const {
+  IDEALGAS_TRACE_SCOPE("GasContainer::Display");
+  const float* x_positions = snapshot.GetXPositions();
+  const float* y_positions = snapshot.GetYPositions();
+  const float* radii = snapshot.GetRadii();
+
+  for (size_t slot = 0; slot < snapshot.Size(); ++slot) {
+    const Color& color = snapshot.GetColor(slot);
+    ci::gl::color(ci::Color(color.r, color.g, color.b));
+    ci::gl::drawSolidCircle(glm::vec2(x_positions[slot], y_positions[slot]),
+                            radii[slot]);
+  }
+  ci::gl::color(ci::Color("white"));
+  ci::gl::drawStrokedRect(ci::Rectf(top_left_corner_, bottom_right_corner_));
+}
+
+}  // namespace idealgas
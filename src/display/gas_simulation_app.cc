@@ -2,9 +2,12 @@
 
 #include <components/histogram.h>
 
+#include <fstream>
+
 namespace idealgas {
 
 IdealGasApp::IdealGasApp() {
+  IDEALGAS_TRACE_THREAD_NAME("ui");
   std::vector<Particle*> initial_particles;
   initial_particles.push_back(&orange_particle_);
   initial_particles.push_back(&white_particle_);
@@ -24,11 +27,18 @@ IdealGasApp::IdealGasApp() {
       Histogram(initial_particles, glm::vec2(1000, 100), glm::vec2(1200, 300),
                 1, white_particle_.GetColor(), 4);
 
+  blue_species_ = species_bins_.Register(blue_particle_.GetColor(), 1);
+  orange_species_ = species_bins_.Register(orange_particle_.GetColor(), 1);
+  white_species_ = species_bins_.Register(white_particle_.GetColor(), 1);
+
   container_ = container;
+  simulation_.reset(new SimulationThread(container_, kStepsPerSecond));
+  simulation_->Start();
   ci::app::setWindowSize(kWindowWidth, kWindowHeight);
 }
 
 void IdealGasApp::draw() {
+  IDEALGAS_TRACE_SCOPE("draw");
   ci::Color background_color("black");
   ci::gl::clear(background_color);
 
@@ -36,52 +46,141 @@ void IdealGasApp::draw() {
   orange_histogram_.Draw();
   white_histogram_.Draw();
 
-  container_.Display();
+  // The same snapshot the histograms were binned from in update()
+  container_.Display(simulation_->GetSnapshot());
+
+  if (is_profiler_shown_) {
+    DrawProfilerOverlay();
+  }
 }
 
 void IdealGasApp::update() {
-  std::vector<Particle*> blue_particles =
-      container_.GetParticlesByColor(blue_particle_.GetColor());
+  // The physics runs on its own thread, so the UI only picks up the newest
+  // finished step; one pass over it bins every species for every histogram
+  RetryUnpostedCommands();
+  const ParticleStore& snapshot = simulation_->AcquireSnapshot();
+  IDEALGAS_PROFILE_BEGIN_FRAME(&profiler_);
+  profiler_.AddFrame(simulation_->GetSnapshotProfile());
+
+  {
+    IDEALGAS_PROFILE_PHASE(&profiler_, ProfilePhase::kHistograms);
+    species_bins_.Update(snapshot);
+    blue_histogram_.UpdateParticleBins(
+        species_bins_.GetSpeedBins(blue_species_));
+    orange_histogram_.UpdateParticleBins(
+        species_bins_.GetSpeedBins(orange_species_));
+    white_histogram_.UpdateParticleBins(
+        species_bins_.GetSpeedBins(white_species_));
+  }
 
-  std::vector<Particle*> orange_particles =
-      container_.GetParticlesByColor(orange_particle_.GetColor());
+  IDEALGAS_PROFILE_END_FRAME(&profiler_);
 
-  std::vector<Particle*> white_particles =
-      container_.GetParticlesByColor(white_particle_.GetColor());
+  if (is_trace_pending_) {
+    WriteFinishedTrace();
+  }
+}
 
-  blue_histogram_.UpdateParticleBins(blue_particles);
-  orange_histogram_.UpdateParticleBins(orange_particles);
-  white_histogram_.UpdateParticleBins(white_particles);
+void IdealGasApp::WriteFinishedTrace() {
+  TraceRecorder& recorder = TraceRecorder::GetInstance();
+  if (recorder.IsRecording()) {
+    return;
+  }
 
-  container_.AdvanceOneFrame();
+  // Formatting happens only after recording stops, never during a frame
+  std::ofstream trace_file(kTraceFileName);
+  recorder.WriteJson(trace_file);
+  is_trace_pending_ = false;
 }
 
-Particle* IdealGasApp::GenerateParticle(const glm::vec2& position,
-                                        const glm::vec2& velocity,
-                                        const ci::Color& color, float radius,
-                                        float mass) {
-  return new Particle(position, velocity, color, radius, mass);
+void IdealGasApp::DrawProfilerOverlay() const {
+  ci::Color text_color("white");
+  ci::Font text_font("Arial", 16.0f);
+  glm::vec2 position(kTopLeftCorner.x, kBottomRightCorner.y + 30);
+  float line_height = 18.0f;
+
+  ci::gl::drawString("phase: p50 / p95 / p99 (ms)", position, text_color,
+                     text_font);
+  for (size_t phase = 0; phase < size_t(ProfilePhase::kNumPhases); ++phase) {
+    position.y += line_height;
+    ProfilePhase profile_phase = ProfilePhase(phase);
+    std::string line =
+        std::string(FrameProfiler::GetPhaseName(profile_phase)) + ": " +
+        std::to_string(
+            profiler_.CalculatePhasePercentile(profile_phase, 50) * 1000) +
+        " / " +
+        std::to_string(
+            profiler_.CalculatePhasePercentile(profile_phase, 95) * 1000) +
+        " / " +
+        std::to_string(
+            profiler_.CalculatePhasePercentile(profile_phase, 99) * 1000);
+    ci::gl::drawString(line, position, text_color, text_font);
+  }
+
+  const FrameProfile& last_frame = profiler_.GetLastFrame();
+  for (size_t counter = 0; counter < size_t(ProfileCounter::kNumCounters);
+       ++counter) {
+    position.y += line_height;
+    std::string line =
+        std::string(FrameProfiler::GetCounterName(ProfileCounter(counter))) +
+        ": " + std::to_string(last_frame.counts[counter]);
+    ci::gl::drawString(line, position, text_color, text_font);
+  }
+}
+
+Particle IdealGasApp::GenerateParticle(const glm::vec2& position,
+                                       const glm::vec2& velocity,
+                                       const ci::Color& color, float radius,
+                                       float mass) {
+  return Particle(position, velocity, color, radius, mass);
+}
+
+void IdealGasApp::PostCommand(const SimulationCommand& command) {
+  // Anything already held back goes first so commands stay in order
+  RetryUnpostedCommands();
+  if (!unposted_commands_.empty() || !simulation_->Post(command)) {
+    unposted_commands_.push_back(command);
+  }
+}
+
+void IdealGasApp::RetryUnpostedCommands() {
+  while (!unposted_commands_.empty() &&
+         simulation_->Post(unposted_commands_.front())) {
+    unposted_commands_.pop_front();
+  }
 }
 
 void IdealGasApp::keyDown(ci::app::KeyEvent event) {
   switch (event.getCode()) {
     case ci::app::KeyEvent::KEY_UP:
-      container_.ModifyParticlesSpeed(kDeltaVelocity, true);
+      PostCommand(SimulationCommand::ModifySpeed(kDeltaVelocity, true));
       break;
     case ci::app::KeyEvent::KEY_DOWN:
-      container_.ModifyParticlesSpeed(kDeltaVelocity, false);
+      PostCommand(SimulationCommand::ModifySpeed(kDeltaVelocity, false));
       break;
     case ci::app::KeyEvent::KEY_b:
-      container_.AddParticleToContainer(GenerateParticle(
-          glm::vec2(550, 550), glm::vec2(-3, -1), ci::Color("blue"), 3, 5));
+      PostCommand(SimulationCommand::AddParticle(
+          GenerateParticle(glm::vec2(550, 550), glm::vec2(-3, -1),
+                           ci::Color("blue"), 3, 5)));
       break;
     case ci::app::KeyEvent::KEY_o:
-      container_.AddParticleToContainer(GenerateParticle(
-          glm::vec2(550, 550), glm::vec2(-2, -2), ci::Color("orange"), 6, 8));
+      PostCommand(SimulationCommand::AddParticle(
+          GenerateParticle(glm::vec2(550, 550), glm::vec2(-2, -2),
+                           ci::Color("orange"), 6, 8)));
+      break;
+    case ci::app::KeyEvent::KEY_p:
+      is_profiler_shown_ = !is_profiler_shown_;
+      break;
+    case ci::app::KeyEvent::KEY_t:
+#ifdef IDEALGAS_PROFILING
+      // The window is counted in simulation steps
+      TraceRecorder::GetInstance().Start(kTraceFrames);
+      is_trace_pending_ = true;
+#endif
       break;
     case ci::app::KeyEvent::KEY_w:
-      container_.AddParticleToContainer(GenerateParticle(
-          glm::vec2(550, 550), glm::vec2(-1, -1.5), ci::Color("white"), 9, 11));
+      PostCommand(SimulationCommand::AddParticle(
+          GenerateParticle(glm::vec2(550, 550), glm::vec2(-1, -1.5),
+                           ci::Color("white"), 9, 11)));
       break;
   }
 }
@@ -0,0 +1,80 @@
+#include "display/simulation_command.h"
+
+namespace idealgas {
+
+SimulationCommand SimulationCommand::ModifySpeed(
+    const glm::vec2& delta_velocity, bool should_increase_speed) {
+  SimulationCommand command;
+  command.type = Type::kModifySpeed;
+  command.velocity = delta_velocity;
+  command.should_increase_speed = should_increase_speed;
+  return command;
+}
+
+SimulationCommand SimulationCommand::AddParticle(const Particle& particle) {
+  SimulationCommand command;
+  command.type = Type::kAddParticle;
+  command.position = particle.GetPosition();
+  command.velocity = particle.GetVelocity();
+  command.color = particle.GetColor();
+  command.radius = particle.GetRadius();
+  command.mass = particle.GetMass();
+  return command;
+}
+
+SimulationCommand SimulationCommand::RemoveParticle(size_t particle_id) {
+  SimulationCommand command;
+  command.type = Type::kRemoveParticle;
+  command.particle_id = particle_id;
+  return command;
+}
+
+SimulationCommand SimulationCommand::ClearParticles() {
+  SimulationCommand command;
+  command.type = Type::kClearParticles;
+  return command;
+}
+
+SimulationCommand SimulationCommand::SetNumThreads(size_t num_threads) {
+  SimulationCommand command;
+  command.type = Type::kSetNumThreads;
+  command.num_threads = num_threads;
+  return command;
+}
+
+SimulationCommand SimulationCommand::SetSteppingMode(SteppingMode mode) {
+  SimulationCommand command;
+  command.type = Type::kSetSteppingMode;
+  command.stepping_mode = mode;
+  return command;
+}
+
+void SimulationCommand::ApplyTo(GasContainer* container) const {
+  switch (type) {
+    case Type::kModifySpeed:
+      container->ModifyParticlesSpeed(velocity, should_increase_speed);
+      break;
+    case Type::kAddParticle:
+      container->AddParticleToContainer(
+          Particle(position, velocity, color, radius, mass));
+      break;
+    case Type::kRemoveParticle: {
+      size_t slot = container->GetParticleSlot(particle_id);
+      if (slot != ParticleIds::kNoSlot) {
+        container->RemoveParticle(slot);
+      }
+      break;
+    }
+    case Type::kClearParticles:
+      container->ClearParticles();
+      break;
+    case Type::kSetNumThreads:
+      container->SetNumThreads(num_threads);
+      break;
+    case Type::kSetSteppingMode:
+      container->SetSteppingMode(stepping_mode);
+      break;
+  }
+}
+
+}  // namespace idealgas
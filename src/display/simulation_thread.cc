@@ -0,0 +1,135 @@
+#include "display/simulation_thread.h"
+
+#include <chrono>
+
+namespace idealgas {
+
+const size_t SimulationThread::kCommandQueueCapacity;
+const unsigned SimulationThread::kFreshBit;
+const unsigned SimulationThread::kIndexMask;
+
+SimulationThread::SimulationThread(const GasContainer& container,
+                                   float steps_per_second)
+    : container_(container),
+      is_running_(false),
+      steps_per_second_(steps_per_second),
+      num_steps_taken_(0),
+      commands_(kCommandQueueCapacity),
+      shared_buffer_(1),
+      back_buffer_(0),
+      front_buffer_(2) {
+  // Every buffer starts out as the initial state so the UI can draw at once
+  for (size_t buffer = 0; buffer < 3; ++buffer) {
+    buffers_[buffer] = container_.GetParticleStore();
+    buffer_steps_[buffer] = 0;
+    buffer_profiles_[buffer] = container_.GetProfiler().GetLastFrame();
+  }
+}
+
+SimulationThread::~SimulationThread() {
+  Stop();
+}
+
+void SimulationThread::Start() {
+  if (is_running_) {
+    return;
+  }
+
+  is_running_ = true;
+  thread_ = std::thread(&SimulationThread::Run, this);
+}
+
+void SimulationThread::Stop() {
+  is_running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+bool SimulationThread::IsRunning() const {
+  return is_running_;
+}
+
+void SimulationThread::SetTargetRate(float steps_per_second) {
+  steps_per_second_ = steps_per_second;
+}
+
+float SimulationThread::GetTargetRate() const {
+  return steps_per_second_;
+}
+
+bool SimulationThread::Post(const SimulationCommand& command) {
+  return commands_.TryPush(command);
+}
+
+const ParticleStore& SimulationThread::AcquireSnapshot() {
+  if (shared_buffer_.load() & kFreshBit) {
+    front_buffer_ = shared_buffer_.exchange(front_buffer_) & kIndexMask;
+  }
+
+  return buffers_[front_buffer_];
+}
+
+const ParticleStore& SimulationThread::GetSnapshot() const {
+  return buffers_[front_buffer_];
+}
+
+size_t SimulationThread::GetSnapshotStep() const {
+  return buffer_steps_[front_buffer_];
+}
+
+const FrameProfile& SimulationThread::GetSnapshotProfile() const {
+  return buffer_profiles_[front_buffer_];
+}
+
+size_t SimulationThread::GetNumStepsTaken() const {
+  return num_steps_taken_;
+}
+
+void SimulationThread::Run() {
+  IDEALGAS_TRACE_THREAD_NAME("simulation");
+  typedef std::chrono::steady_clock Clock;
+  Clock::time_point next_step_time = Clock::now();
+
+  while (is_running_) {
+    {
+      IDEALGAS_TRACE_SCOPE("drain commands");
+      commands_.DrainInto(&container_);
+    }
+    container_.AdvanceOneFrame();
+    ++num_steps_taken_;
+    Publish();
+
+    float steps_per_second = steps_per_second_;
+    if (steps_per_second <= 0) {
+      next_step_time = Clock::now();
+      continue;
+    }
+
+    next_step_time += std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float>(1.0f / steps_per_second));
+
+    // After falling more than a step behind, drop the missed steps rather
+    // than racing to catch up with them
+    Clock::time_point now = Clock::now();
+    if (next_step_time < now) {
+      next_step_time = now;
+    }
+    std::this_thread::sleep_until(next_step_time);
+  }
+
+  // Changes queued just before stopping still reach the container
+  commands_.DrainInto(&container_);
+  Publish();
+}
+
+void SimulationThread::Publish() {
+  IDEALGAS_TRACE_SCOPE("publish snapshot");
+  // Copy assignment reuses the back buffer's memory once it is large enough
+  buffers_[back_buffer_] = container_.GetParticleStore();
+  buffer_steps_[back_buffer_] = num_steps_taken_;
+  buffer_profiles_[back_buffer_] = container_.GetProfiler().GetLastFrame();
+  back_buffer_ = shared_buffer_.exchange(back_buffer_ | kFreshBit) & kIndexMask;
+}
+
+}  // namespace idealgas
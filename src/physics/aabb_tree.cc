@@ -0,0 +1,242 @@
+#include "physics/aabb_tree.h"
+
+#include <algorithm>
+
+namespace idealgas {
+
+namespace {
+
+// Boxes are padded a little so rounding can never drop a touching pair
+const float kBoxSlack = 1.001f;
+
+}  // namespace
+
+const size_t AabbTree::kLeafSize;
+const float AabbTree::kRebuildAreaRatio = 1.2f;
+
+AabbTree::AabbTree() : is_valid_(false), num_rebuilds_(0), built_area_(0) {
+}
+
+bool AabbTree::Update(const ParticleStore& store) {
+  UpdateParticleBoxes(store);
+
+  bool should_rebuild = !is_valid_ || leaf_slots_.size() != store.Size() ||
+                        Refit() > built_area_ * kRebuildAreaRatio;
+  if (should_rebuild) {
+    leaf_slots_.resize(store.Size());
+    for (size_t slot = 0; slot < leaf_slots_.size(); ++slot) {
+      leaf_slots_[slot] = slot;
+    }
+
+    nodes_.clear();
+    if (!leaf_slots_.empty()) {
+      BuildNode(0, leaf_slots_.size());
+    }
+
+    built_area_ = Refit();
+    is_valid_ = true;
+    ++num_rebuilds_;
+  }
+
+  FindOverlappingPairs();
+  pairs_.Group(store.Size());
+  return should_rebuild;
+}
+
+void AabbTree::Invalidate() {
+  is_valid_ = false;
+}
+
+void AabbTree::GatherNeighbourCandidates(
+    size_t particle_idx, std::vector<size_t>* candidates) const {
+  pairs_.GatherNeighbourCandidates(particle_idx, candidates);
+}
+
+size_t AabbTree::GetNumRebuilds() const {
+  return num_rebuilds_;
+}
+
+size_t AabbTree::GetNumNodes() const {
+  return nodes_.size();
+}
+
+size_t AabbTree::GetNumPairs() const {
+  return pairs_.Size();
+}
+
+size_t AabbTree::BuildNode(size_t first, size_t count) {
+  size_t node_idx = nodes_.size();
+  nodes_.push_back(Node());
+  nodes_[node_idx].first = first;
+  nodes_[node_idx].count = count;
+  nodes_[node_idx].right_child = 0;
+  if (count <= kLeafSize) {
+    return node_idx;
+  }
+
+  // Split at the median center along the longer side of the particles' box
+  float min_x = min_xs_[leaf_slots_[first]];
+  float min_y = min_ys_[leaf_slots_[first]];
+  float max_x = max_xs_[leaf_slots_[first]];
+  float max_y = max_ys_[leaf_slots_[first]];
+  for (size_t entry = first + 1; entry < first + count; ++entry) {
+    size_t slot = leaf_slots_[entry];
+    min_x = std::min(min_x, min_xs_[slot]);
+    min_y = std::min(min_y, min_ys_[slot]);
+    max_x = std::max(max_x, max_xs_[slot]);
+    max_y = std::max(max_y, max_ys_[slot]);
+  }
+
+  const std::vector<float>& min_bounds =
+      max_x - min_x >= max_y - min_y ? min_xs_ : min_ys_;
+  const std::vector<float>& max_bounds =
+      max_x - min_x >= max_y - min_y ? max_xs_ : max_ys_;
+  size_t half = count / 2;
+  std::nth_element(leaf_slots_.begin() + first,
+                   leaf_slots_.begin() + first + half,
+                   leaf_slots_.begin() + first + count,
+                   [&](size_t slot1, size_t slot2) {
+                     return min_bounds[slot1] + max_bounds[slot1] <
+                            min_bounds[slot2] + max_bounds[slot2];
+                   });
+
+  nodes_[node_idx].count = 0;
+  BuildNode(first, half);
+  size_t right_child = BuildNode(first + half, count - half);
+  nodes_[node_idx].right_child = right_child;
+  return node_idx;
+}
+
+float AabbTree::Refit() {
+  float inner_area = 0;
+
+  // Children always come after their parents, so going backwards refits
+  // every child before its parent
+  for (size_t node_idx = nodes_.size(); node_idx-- > 0;) {
+    Node& node = nodes_[node_idx];
+    if (node.count == 0) {
+      const Node& left = nodes_[node_idx + 1];
+      const Node& right = nodes_[node.right_child];
+      node.min_x = std::min(left.min_x, right.min_x);
+      node.min_y = std::min(left.min_y, right.min_y);
+      node.max_x = std::max(left.max_x, right.max_x);
+      node.max_y = std::max(left.max_y, right.max_y);
+      inner_area += (node.max_x - node.min_x) * (node.max_y - node.min_y);
+      continue;
+    }
+
+    size_t first_slot = leaf_slots_[node.first];
+    node.min_x = min_xs_[first_slot];
+    node.min_y = min_ys_[first_slot];
+    node.max_x = max_xs_[first_slot];
+    node.max_y = max_ys_[first_slot];
+    for (size_t entry = node.first + 1; entry < node.first + node.count;
+         ++entry) {
+      size_t slot = leaf_slots_[entry];
+      node.min_x = std::min(node.min_x, min_xs_[slot]);
+      node.min_y = std::min(node.min_y, min_ys_[slot]);
+      node.max_x = std::max(node.max_x, max_xs_[slot]);
+      node.max_y = std::max(node.max_y, max_ys_[slot]);
+    }
+  }
+
+  return inner_area;
+}
+
+void AabbTree::FindOverlappingPairs() {
+  pairs_.Clear();
+
+  // Every pair of particles meets at exactly one node: a leaf holding both of
+  // them, or the lowest inner node with one on each side
+  for (size_t node_idx = 0; node_idx < nodes_.size(); ++node_idx) {
+    const Node& node = nodes_[node_idx];
+    if (node.count == 0) {
+      node_pair_stack_.push_back(std::make_pair(node_idx + 1,
+                                                node.right_child));
+      FindPairsBetweenSubtrees();
+      continue;
+    }
+
+    for (size_t entry1 = node.first; entry1 < node.first + node.count;
+         ++entry1) {
+      for (size_t entry2 = entry1 + 1; entry2 < node.first + node.count;
+           ++entry2) {
+        AddPairIfOverlapping(leaf_slots_[entry1], leaf_slots_[entry2]);
+      }
+    }
+  }
+}
+
+void AabbTree::FindPairsBetweenSubtrees() {
+  while (!node_pair_stack_.empty()) {
+    size_t node1_idx = node_pair_stack_.back().first;
+    size_t node2_idx = node_pair_stack_.back().second;
+    node_pair_stack_.pop_back();
+    const Node& node1 = nodes_[node1_idx];
+    const Node& node2 = nodes_[node2_idx];
+
+    if (!DoBoxesOverlap(node1.min_x, node1.min_y, node1.max_x, node1.max_y,
+                        node2.min_x, node2.min_y, node2.max_x, node2.max_y)) {
+      continue;
+    }
+
+    // Descend into the larger inner node, or test the particles of two leaves
+    bool should_split_node1 =
+        node1.count == 0 &&
+        (node2.count != 0 || (node1.max_x - node1.min_x) *
+                                     (node1.max_y - node1.min_y) >=
+                                 (node2.max_x - node2.min_x) *
+                                     (node2.max_y - node2.min_y));
+    if (should_split_node1) {
+      node_pair_stack_.push_back(std::make_pair(node1_idx + 1, node2_idx));
+      node_pair_stack_.push_back(std::make_pair(node1.right_child, node2_idx));
+    } else if (node2.count == 0) {
+      node_pair_stack_.push_back(std::make_pair(node1_idx, node2_idx + 1));
+      node_pair_stack_.push_back(std::make_pair(node1_idx, node2.right_child));
+    } else {
+      for (size_t entry1 = node1.first; entry1 < node1.first + node1.count;
+           ++entry1) {
+        for (size_t entry2 = node2.first; entry2 < node2.first + node2.count;
+             ++entry2) {
+          AddPairIfOverlapping(leaf_slots_[entry1], leaf_slots_[entry2]);
+        }
+      }
+    }
+  }
+}
+
+void AabbTree::AddPairIfOverlapping(size_t slot1, size_t slot2) {
+  if (DoBoxesOverlap(min_xs_[slot1], min_ys_[slot1], max_xs_[slot1],
+                     max_ys_[slot1], min_xs_[slot2], min_ys_[slot2],
+                     max_xs_[slot2], max_ys_[slot2])) {
+    pairs_.Add(slot1, slot2);
+  }
+}
+
+void AabbTree::UpdateParticleBoxes(const ParticleStore& store) {
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+  const float* radii = store.GetRadii();
+  size_t num_particles = store.Size();
+
+  min_xs_.resize(num_particles);
+  min_ys_.resize(num_particles);
+  max_xs_.resize(num_particles);
+  max_ys_.resize(num_particles);
+  for (size_t slot = 0; slot < num_particles; ++slot) {
+    float half_width = radii[slot] * kBoxSlack;
+    min_xs_[slot] = x_positions[slot] - half_width;
+    min_ys_[slot] = y_positions[slot] - half_width;
+    max_xs_[slot] = x_positions[slot] + half_width;
+    max_ys_[slot] = y_positions[slot] + half_width;
+  }
+}
+
+bool AabbTree::DoBoxesOverlap(float min_x1, float min_y1, float max_x1,
+                              float max_y1, float min_x2, float min_y2,
+                              float max_x2, float max_y2) {
+  return min_x1 <= max_x2 && min_x2 <= max_x1 && min_y1 <= max_y2 &&
+         min_y2 <= max_y1;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,53 @@
+#include "physics/candidate_pairs.h"
+
+#include <algorithm>
+
+namespace idealgas {
+
+CandidatePairs::CandidatePairs() = default;
+
+void CandidatePairs::Clear() {
+  pairs_.clear();
+}
+
+void CandidatePairs::Add(size_t slot1, size_t slot2) {
+  pairs_.push_back(std::make_pair(std::min(slot1, slot2),
+                                  std::max(slot1, slot2)));
+}
+
+void CandidatePairs::Group(size_t num_particles) {
+  // Counting sort of the pairs by their first particle
+  candidate_starts_.assign(num_particles + 1, 0);
+  for (const std::pair<size_t, size_t>& pair : pairs_) {
+    ++candidate_starts_[pair.first + 1];
+  }
+
+  for (size_t particle = 0; particle < num_particles; ++particle) {
+    candidate_starts_[particle + 1] += candidate_starts_[particle];
+  }
+
+  candidate_fill_.assign(candidate_starts_.begin(),
+                         candidate_starts_.end() - 1);
+  candidates_.resize(pairs_.size());
+  for (const std::pair<size_t, size_t>& pair : pairs_) {
+    candidates_[candidate_fill_[pair.first]++] = pair.second;
+  }
+
+  // Pairs must be visited in the same order as the all-pairs loop
+  for (size_t particle = 0; particle < num_particles; ++particle) {
+    std::sort(candidates_.begin() + candidate_starts_[particle],
+              candidates_.begin() + candidate_starts_[particle + 1]);
+  }
+}
+
+void CandidatePairs::GatherNeighbourCandidates(
+    size_t particle_idx, std::vector<size_t>* candidates) const {
+  candidates->assign(candidates_.begin() + candidate_starts_[particle_idx],
+                     candidates_.begin() + candidate_starts_[particle_idx + 1]);
+}
+
+size_t CandidatePairs::Size() const {
+  return pairs_.size();
+}
+
+}  // namespace idealgas
@@ -1,7 +1,63 @@
 #include "physics/collision_physics.h"
 
+#include <cmath>
+
 namespace idealgas {
 
+namespace {
+
+/**
+ * Shared overlap test so every pair test gives bit-identical answers
+ */
+bool AreTouching(float delta_x, float delta_y, float radius_sum) {
+  float particle_distances = std::sqrt(delta_x * delta_x + delta_y * delta_y);
+
+  return particle_distances <= radius_sum;
+}
+
+/**
+ * Shared pair test so particles and store slots give bit-identical answers
+ */
+bool AreTouchingAndApproaching(float delta_x, float delta_y,
+                               float delta_x_velocity, float delta_y_velocity,
+                               float radius_sum) {
+  bool are_touching = AreTouching(delta_x, delta_y, radius_sum);
+
+  bool are_moving_toward_each_other =
+      delta_x_velocity * delta_x + delta_y_velocity * delta_y < 0;
+
+  return are_touching && are_moving_toward_each_other;
+}
+
+/**
+ * Shared elastic collision response used by both particles and store slots
+ */
+void CalculateCollidedVelocities(const glm::vec2& position1,
+                                 const glm::vec2& velocity1,
+                                 float mass_proportion1,
+                                 const glm::vec2& position2,
+                                 const glm::vec2& velocity2,
+                                 float mass_proportion2,
+                                 glm::vec2* new_velocity1,
+                                 glm::vec2* new_velocity2) {
+  glm::vec2 delta_position = position1 - position2;
+  glm::vec2 delta_velocity = velocity1 - velocity2;
+
+  // Calculates the new velocity of particle 1 based on the collision
+  *new_velocity1 =
+      velocity1 -
+      mass_proportion1 * glm::dot(delta_velocity, (delta_position)) /
+          glm::pow(glm::length(delta_position), 2) * delta_position;
+
+  // Calculates the new velocity of particle 2 based on the collision
+  *new_velocity2 =
+      velocity2 -
+      mass_proportion2 * glm::dot(-delta_velocity, -delta_position) /
+          glm::pow(glm::length(-delta_position), 2) * -delta_position;
+}
+
+}  // namespace
+
 CollisionPhysics::CollisionPhysics(const glm::vec2& top_left_corner,
                                    const glm::vec2& bottom_right_corner) {
   left_wall_ = top_left_corner.x;
@@ -14,84 +70,144 @@ CollisionPhysics::CollisionPhysics() = default;
 
 bool CollisionPhysics::DidParticlesCollide(const Particle& particle1,
                                            const Particle& particle2) const {
-  float particle_distances =
-      glm::distance(particle1.GetPosition(), particle2.GetPosition());
+  glm::vec2 delta_position = particle1.GetPosition() - particle2.GetPosition();
+  glm::vec2 delta_velocity = particle1.GetVelocity() - particle2.GetVelocity();
 
-  bool are_touching =
-      particle_distances <= particle1.GetRadius() + particle2.GetRadius();
+  return AreTouchingAndApproaching(
+      delta_position.x, delta_position.y, delta_velocity.x, delta_velocity.y,
+      particle1.GetRadius() + particle2.GetRadius());
+}
 
-  glm::vec2 delta_velocity = particle1.GetVelocity() - particle2.GetVelocity();
-  glm::vec2 delta_position = particle1.GetPosition() - particle2.GetPosition();
+bool CollisionPhysics::DidParticlesCollide(const ParticleStore& store,
+                                           size_t slot1, size_t slot2) const {
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+  const float* x_velocities = store.GetXVelocities();
+  const float* y_velocities = store.GetYVelocities();
+  const float* radii = store.GetRadii();
+
+  return AreTouchingAndApproaching(
+      x_positions[slot1] - x_positions[slot2],
+      y_positions[slot1] - y_positions[slot2],
+      x_velocities[slot1] - x_velocities[slot2],
+      y_velocities[slot1] - y_velocities[slot2], radii[slot1] + radii[slot2]);
+}
 
-  bool are_moving_toward_each_other =
-      glm::dot(delta_velocity, delta_position) < 0;
+bool CollisionPhysics::AreParticlesTouching(const ParticleStore& store,
+                                            size_t slot1, size_t slot2) const {
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+  const float* radii = store.GetRadii();
 
-  return are_touching && are_moving_toward_each_other;
+  return AreTouching(x_positions[slot1] - x_positions[slot2],
+                     y_positions[slot1] - y_positions[slot2],
+                     radii[slot1] + radii[slot2]);
 }
 
 void CollisionPhysics::UpdateCollidedParticleVelocities(Particle* particle1,
                                                         Particle* particle2) {
-  glm::vec2 delta_position =
-      particle1->GetPosition() - particle2->GetPosition();
-  glm::vec2 delta_velocity =
-      particle1->GetVelocity() - particle2->GetVelocity();
-
-  float mass_sum = particle1->GetMass() + particle2->GetMass();
-
-  float mass_proportion1 = 2 * particle2->GetMass() / mass_sum;
-
-  // Calculates the new velocity of particle 1 based on the collision
-  glm::vec2 new_velocity1 =
-      particle1->GetVelocity() -
-      mass_proportion1 * glm::dot(delta_velocity, (delta_position)) /
-          glm::pow(glm::length(delta_position), 2) * delta_position;
-
-  float mass_proportion2 = 2 * particle1->GetMass() / mass_sum;
-
-  // Calculates the new velocity of particle 2 based on the collision
-  glm::vec2 new_velocity2 =
-      particle2->GetVelocity() -
-      mass_proportion2 * glm::dot(-delta_velocity, -delta_position) /
-          glm::pow(glm::length(-delta_position), 2) * -delta_position;
+  glm::vec2 new_velocity1;
+  glm::vec2 new_velocity2;
+  float mass1 = particle1->GetMass();
+  float mass2 = particle2->GetMass();
+  CalculateCollidedVelocities(
+      particle1->GetPosition(), particle1->GetVelocity(),
+      SpeciesTable::CalculateMassFactor(mass1, mass2),
+      particle2->GetPosition(), particle2->GetVelocity(),
+      SpeciesTable::CalculateMassFactor(mass2, mass1), &new_velocity1,
+      &new_velocity2);
 
   particle1->SetVelocity(new_velocity1);
   particle2->SetVelocity(new_velocity2);
 }
 
+void CollisionPhysics::UpdateCollidedParticleVelocities(ParticleStore* store,
+                                                        size_t slot1,
+                                                        size_t slot2) const {
+  // The mass factors of every pair of species are worked out ahead of time
+  const SpeciesTable& species_table = store->GetSpeciesTable();
+  SpeciesId species1 = store->GetSpecies(slot1);
+  SpeciesId species2 = store->GetSpecies(slot2);
+
+  glm::vec2 new_velocity1;
+  glm::vec2 new_velocity2;
+  CalculateCollidedVelocities(
+      store->GetPosition(slot1), store->GetVelocity(slot1),
+      species_table.GetMassFactor(species1, species2),
+      store->GetPosition(slot2), store->GetVelocity(slot2),
+      species_table.GetMassFactor(species2, species1), &new_velocity1,
+      &new_velocity2);
+
+  store->SetVelocity(slot1, new_velocity1);
+  store->SetVelocity(slot2, new_velocity2);
+}
+
 bool CollisionPhysics::IsParticleCollidingWithTopWall(
     const Particle& particle) const {
-  float y_pos = particle.GetPosition().y;
-  float y_velocity = particle.GetVelocity().y;
-  float radius = particle.GetRadius();
+  return IsParticleCollidingWithTopWall(particle.GetPosition().y,
+                                        particle.GetVelocity().y,
+                                        particle.GetRadius());
+}
 
+bool CollisionPhysics::IsParticleCollidingWithTopWall(float y_pos,
+                                                      float y_velocity,
+                                                      float radius) const {
   return y_pos - radius <= top_wall_ && y_velocity < 0;
 }
 
 bool CollisionPhysics::IsParticleCollidingWithBottomWall(
     const Particle& particle) const {
-  float y_pos = particle.GetPosition().y;
-  float y_velocity = particle.GetVelocity().y;
-  float radius = particle.GetRadius();
+  return IsParticleCollidingWithBottomWall(particle.GetPosition().y,
+                                           particle.GetVelocity().y,
+                                           particle.GetRadius());
+}
 
+bool CollisionPhysics::IsParticleCollidingWithBottomWall(float y_pos,
+                                                         float y_velocity,
+                                                         float radius) const {
   return y_pos + radius >= bottom_wall_ && y_velocity > 0;
 }
 
 bool CollisionPhysics::IsParticleCollidingWithLeftWall(
     const Particle& particle) const {
-  float x_pos = particle.GetPosition().x;
-  float x_velocity = particle.GetVelocity().x;
-  float radius = particle.GetRadius();
+  return IsParticleCollidingWithLeftWall(particle.GetPosition().x,
+                                         particle.GetVelocity().x,
+                                         particle.GetRadius());
+}
 
+bool CollisionPhysics::IsParticleCollidingWithLeftWall(float x_pos,
+                                                       float x_velocity,
+                                                       float radius) const {
   return x_pos - radius <= left_wall_ && x_velocity < 0;
 }
 
 bool CollisionPhysics::IsParticleCollidingWithRightWall(
     const Particle& particle) const {
-  float x_pos = particle.GetPosition().x;
-  float x_velocity = particle.GetVelocity().x;
-  float radius = particle.GetRadius();
+  return IsParticleCollidingWithRightWall(particle.GetPosition().x,
+                                          particle.GetVelocity().x,
+                                          particle.GetRadius());
+}
 
+bool CollisionPhysics::IsParticleCollidingWithRightWall(float x_pos,
+                                                        float x_velocity,
+                                                        float radius) const {
   return x_pos + radius >= right_wall_ && x_velocity > 0;
 }
 
-}  // namespace idealgas
\ No newline at end of file
+size_t CollisionPhysics::ReflectWallCollisions(ParticleStore* store) const {
+  return ReflectWallCollisions(store, 0, store->Size());
+}
+
+size_t CollisionPhysics::ReflectWallCollisions(ParticleStore* store,
+                                               size_t begin,
+                                               size_t end) const {
+  size_t num_bounces = wall_kernel_.Reflect(
+      store->GetYPositions() + begin, store->GetYVelocities() + begin,
+      store->GetRadii() + begin, end - begin, top_wall_, bottom_wall_);
+  num_bounces += wall_kernel_.Reflect(
+      store->GetXPositions() + begin, store->GetXVelocities() + begin,
+      store->GetRadii() + begin, end - begin, left_wall_, right_wall_);
+  return num_bounces;
+}
+
+}  // namespace idealgas
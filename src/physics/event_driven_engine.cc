@@ -0,0 +1,418 @@
+#include "physics/event_driven_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace idealgas {
+
+namespace {
+
+// Overlaps shallower than this fraction of the radii are rounding error at the
+// moment of contact, so those pairs still collide. Deeper overlaps, such as
+// particles spawned on top of each other, pass through until they separate.
+const double kContactTolerance = 1e-3;
+
+}  // namespace
+
+const size_t EventDrivenEngine::kMaxEventsPerParticle;
+const int EventDrivenEngine::kMaxCellsPerAxis;
+const size_t EventDrivenEngine::kNoParticle;
+
+bool EventDrivenEngine::Event::operator>(const Event& other) const {
+  if (time != other.time) {
+    return time > other.time;
+  }
+  if (particle1 != other.particle1) {
+    return particle1 > other.particle1;
+  }
+  if (particle2 != other.particle2) {
+    return particle2 > other.particle2;
+  }
+  return type > other.type;
+}
+
+EventDrivenEngine::EventDrivenEngine()
+    : EventDrivenEngine(glm::vec2(0, 0), glm::vec2(0, 0)) {
+}
+
+EventDrivenEngine::EventDrivenEngine(const glm::vec2& top_left_corner,
+                                     const glm::vec2& bottom_right_corner)
+    : top_left_corner_(top_left_corner),
+      bottom_right_corner_(bottom_right_corner),
+      needs_rebuild_(true),
+      num_collisions_(0),
+      num_wall_bounces_(0),
+      time_(0),
+      cell_size_(1.0f),
+      num_cells_{1, 1} {
+}
+
+void EventDrivenEngine::Advance(ParticleStore* store,
+                                const CollisionPhysics& physics,
+                                float duration) {
+  size_t num_particles = store->Size();
+  if (needs_rebuild_ || num_particles != particle_times_.size() ||
+      events_.size() > kMaxEventsPerParticle * (num_particles + 1)) {
+    Rebuild(store);
+  }
+
+  double end_time = time_ + duration;
+  ProcessEvents(store, physics, end_time);
+
+  // Sample every particle at the end of the frame for drawing and binning
+  time_ = end_time;
+  for (size_t particle = 0; particle < num_particles; ++particle) {
+    Drift(store, particle);
+  }
+}
+
+void EventDrivenEngine::Invalidate() {
+  needs_rebuild_ = true;
+}
+
+size_t EventDrivenEngine::GetNumCollisions() const {
+  return num_collisions_;
+}
+
+size_t EventDrivenEngine::GetNumWallBounces() const {
+  return num_wall_bounces_;
+}
+
+void EventDrivenEngine::Rebuild(ParticleStore* store) {
+  size_t num_particles = store->Size();
+
+  // Particles added since the last frame are already at the current time
+  particle_times_.resize(num_particles, time_);
+  float max_radius = 0;
+  for (size_t particle = 0; particle < num_particles; ++particle) {
+    Drift(store, particle);
+    max_radius = std::max(store->GetRadii()[particle], max_radius);
+  }
+
+  // A cell must span a whole diameter so touching particles are neighbours,
+  // with a little slack so rounding can never push them two cells apart
+  glm::vec2 extent = bottom_right_corner_ - top_left_corner_;
+  float max_extent = std::max(std::max(extent.x, extent.y), 1.0f);
+  cell_size_ = std::max(2 * max_radius * 1.001f, 1.0f);
+  cell_size_ = std::max(cell_size_, max_extent / kMaxCellsPerAxis);
+  for (int axis = 0; axis < 2; ++axis) {
+    num_cells_[axis] = int(std::max(extent[axis], 0.0f) / cell_size_) + 1;
+  }
+
+  cell_heads_.assign(size_t(num_cells_[0]) * num_cells_[1], kNoParticle);
+  particle_cells_.resize(2 * num_particles);
+  next_in_cell_.resize(num_particles);
+  previous_in_cell_.resize(num_particles);
+  for (size_t particle = 0; particle < num_particles; ++particle) {
+    for (int axis = 0; axis < 2; ++axis) {
+      double cell = std::floor(
+          (CalculateCurrentPosition(*store, particle, axis) -
+           top_left_corner_[axis]) /
+          cell_size_);
+      cell = std::min(std::max(cell, 0.0), double(num_cells_[axis] - 1));
+      particle_cells_[2 * particle + axis] = int(cell);
+    }
+    AddToCell(particle);
+  }
+
+  // Room for as many events as the queue may hold before the next rebuild,
+  // plus slack for the frame that crosses the limit, so steady frames don't
+  // grow it
+  events_.clear();
+  size_t max_events = kMaxEventsPerParticle * (num_particles + 1);
+  events_.reserve(max_events + max_events / 4);
+  collision_counts_.assign(num_particles, 0);
+  for (size_t particle = 0; particle < num_particles; ++particle) {
+    PredictWallCollisions(*store, particle);
+    PredictCellCrossing(*store, particle, 0);
+    PredictCellCrossing(*store, particle, 1);
+
+    // Each pair is predicted once, from its lower slot
+    int column = particle_cells_[2 * particle];
+    int row = particle_cells_[2 * particle + 1];
+    for (int neighbour_row = std::max(row - 1, 0);
+         neighbour_row <= std::min(row + 1, num_cells_[1] - 1);
+         ++neighbour_row) {
+      for (int neighbour_column = std::max(column - 1, 0);
+           neighbour_column <= std::min(column + 1, num_cells_[0] - 1);
+           ++neighbour_column) {
+        size_t cell = neighbour_row * num_cells_[0] + neighbour_column;
+        for (size_t other_particle = cell_heads_[cell];
+             other_particle != kNoParticle;
+             other_particle = next_in_cell_[other_particle]) {
+          if (other_particle > particle) {
+            PredictParticleCollision(*store, particle, other_particle);
+          }
+        }
+      }
+    }
+  }
+
+  needs_rebuild_ = false;
+}
+
+void EventDrivenEngine::ProcessEvents(ParticleStore* store,
+                                      const CollisionPhysics& physics,
+                                      double end_time) {
+  while (!events_.empty() && events_.front().time <= end_time) {
+    std::pop_heap(events_.begin(), events_.end(), std::greater<Event>());
+    Event event = events_.back();
+    events_.pop_back();
+
+    // A particle that collided since this was predicted has moved on
+    if (collision_counts_[event.particle1] != event.particle1_count ||
+        (event.type == kParticleCollision &&
+         collision_counts_[event.particle2] != event.particle2_count)) {
+      continue;
+    }
+
+    time_ = event.time;
+    switch (event.type) {
+      case kParticleCollision:
+        Drift(store, event.particle1);
+        Drift(store, event.particle2);
+        physics.UpdateCollidedParticleVelocities(store, event.particle1,
+                                                 event.particle2);
+        ++collision_counts_[event.particle1];
+        ++collision_counts_[event.particle2];
+        ++num_collisions_;
+        PredictEvents(*store, event.particle1);
+        PredictEvents(*store, event.particle2);
+        break;
+      case kVerticalWall:
+      case kHorizontalWall: {
+        Drift(store, event.particle1);
+        float* velocities = event.type == kVerticalWall
+                                ? store->GetXVelocities()
+                                : store->GetYVelocities();
+        velocities[event.particle1] = -velocities[event.particle1];
+        ++collision_counts_[event.particle1];
+        ++num_collisions_;
+        ++num_wall_bounces_;
+        PredictEvents(*store, event.particle1);
+        break;
+      }
+      case kColumnCrossing:
+        CrossCell(*store, event.particle1, 0);
+        break;
+      case kRowCrossing:
+        CrossCell(*store, event.particle1, 1);
+        break;
+    }
+  }
+}
+
+void EventDrivenEngine::CrossCell(const ParticleStore& store, size_t particle,
+                                  int axis) {
+  float velocity = store.GetVelocity(particle)[axis];
+  int step = velocity > 0 ? 1 : -1;
+
+  RemoveFromCell(particle);
+  particle_cells_[2 * particle + axis] += step;
+  AddToCell(particle);
+
+  // Only the strip of cells one further along just became neighbours
+  int column = particle_cells_[2 * particle];
+  int row = particle_cells_[2 * particle + 1];
+  if (axis == 0) {
+    PredictCellCollisions(store, particle, column + step, column + step,
+                          row - 1, row + 1);
+  } else {
+    PredictCellCollisions(store, particle, column - 1, column + 1, row + step,
+                          row + step);
+  }
+
+  PredictCellCrossing(store, particle, axis);
+}
+
+void EventDrivenEngine::PredictEvents(const ParticleStore& store,
+                                      size_t particle) {
+  PredictWallCollisions(store, particle);
+  PredictCellCrossing(store, particle, 0);
+  PredictCellCrossing(store, particle, 1);
+
+  int column = particle_cells_[2 * particle];
+  int row = particle_cells_[2 * particle + 1];
+  PredictCellCollisions(store, particle, column - 1, column + 1, row - 1,
+                        row + 1);
+}
+
+void EventDrivenEngine::PredictCellCollisions(const ParticleStore& store,
+                                              size_t particle,
+                                              int first_column,
+                                              int last_column, int first_row,
+                                              int last_row) {
+  first_column = std::max(first_column, 0);
+  last_column = std::min(last_column, num_cells_[0] - 1);
+  first_row = std::max(first_row, 0);
+  last_row = std::min(last_row, num_cells_[1] - 1);
+
+  for (int row = first_row; row <= last_row; ++row) {
+    for (int column = first_column; column <= last_column; ++column) {
+      for (size_t other_particle = cell_heads_[row * num_cells_[0] + column];
+           other_particle != kNoParticle;
+           other_particle = next_in_cell_[other_particle]) {
+        if (other_particle != particle) {
+          PredictParticleCollision(store, particle, other_particle);
+        }
+      }
+    }
+  }
+}
+
+void EventDrivenEngine::PredictParticleCollision(const ParticleStore& store,
+                                                 size_t particle1,
+                                                 size_t particle2) {
+  double delta_x = CalculateCurrentPosition(store, particle2, 0) -
+                   CalculateCurrentPosition(store, particle1, 0);
+  double delta_y = CalculateCurrentPosition(store, particle2, 1) -
+                   CalculateCurrentPosition(store, particle1, 1);
+  const float* x_velocities = store.GetXVelocities();
+  const float* y_velocities = store.GetYVelocities();
+  double delta_x_velocity =
+      double(x_velocities[particle2]) - x_velocities[particle1];
+  double delta_y_velocity =
+      double(y_velocities[particle2]) - y_velocities[particle1];
+
+  double approach = delta_x * delta_x_velocity + delta_y * delta_y_velocity;
+  if (approach >= 0) {
+    return;
+  }
+
+  const float* radii = store.GetRadii();
+  double radius_sum = double(radii[particle1]) + radii[particle2];
+  double distance_squared = delta_x * delta_x + delta_y * delta_y;
+  double radius_sum_squared = radius_sum * radius_sum;
+
+  double collision_time = time_;
+  if (distance_squared <= radius_sum_squared) {
+    double contact_distance = radius_sum * (1 - kContactTolerance);
+    if (distance_squared < contact_distance * contact_distance) {
+      return;
+    }
+  } else {
+    double speed_squared = delta_x_velocity * delta_x_velocity +
+                           delta_y_velocity * delta_y_velocity;
+    double discriminant =
+        approach * approach -
+        speed_squared * (distance_squared - radius_sum_squared);
+    if (discriminant < 0) {
+      return;
+    }
+
+    collision_time += -(approach + std::sqrt(discriminant)) / speed_squared;
+  }
+
+  Event event = {collision_time,
+                 kParticleCollision,
+                 particle1,
+                 particle2,
+                 collision_counts_[particle1],
+                 collision_counts_[particle2]};
+  PushEvent(event);
+}
+
+void EventDrivenEngine::PredictWallCollisions(const ParticleStore& store,
+                                              size_t particle) {
+  float radius = store.GetRadii()[particle];
+  glm::vec2 velocity = store.GetVelocity(particle);
+
+  const EventType wall_types[2] = {kVerticalWall, kHorizontalWall};
+  for (int axis = 0; axis < 2; ++axis) {
+    double position = CalculateCurrentPosition(store, particle, axis);
+
+    // Same contact rule as stepping by frames: touching and moving outwards
+    double wall;
+    if (velocity[axis] < 0) {
+      wall = double(top_left_corner_[axis]) + radius;
+    } else if (velocity[axis] > 0) {
+      wall = double(bottom_right_corner_[axis]) - radius;
+    } else {
+      continue;
+    }
+
+    double time_to_wall = std::max((wall - position) / velocity[axis], 0.0);
+    Event event = {time_ + time_to_wall, wall_types[axis], particle, particle,
+                   collision_counts_[particle], 0};
+    PushEvent(event);
+  }
+}
+
+void EventDrivenEngine::PredictCellCrossing(const ParticleStore& store,
+                                            size_t particle, int axis) {
+  float velocity = store.GetVelocity(particle)[axis];
+  int cell = particle_cells_[2 * particle + axis];
+
+  // The border cells stretch out forever, so nothing leaves them outwards
+  double boundary;
+  if (velocity > 0 && cell < num_cells_[axis] - 1) {
+    boundary = top_left_corner_[axis] + double(cell + 1) * cell_size_;
+  } else if (velocity < 0 && cell > 0) {
+    boundary = top_left_corner_[axis] + double(cell) * cell_size_;
+  } else {
+    return;
+  }
+
+  double position = CalculateCurrentPosition(store, particle, axis);
+  double time_to_boundary = std::max((boundary - position) / velocity, 0.0);
+  Event event = {time_ + time_to_boundary,
+                 axis == 0 ? kColumnCrossing : kRowCrossing,
+                 particle,
+                 particle,
+                 collision_counts_[particle],
+                 0};
+  PushEvent(event);
+}
+
+double EventDrivenEngine::CalculateCurrentPosition(const ParticleStore& store,
+                                                   size_t particle,
+                                                   int axis) const {
+  return store.GetPosition(particle)[axis] +
+         store.GetVelocity(particle)[axis] *
+             (time_ - particle_times_[particle]);
+}
+
+void EventDrivenEngine::Drift(ParticleStore* store, size_t particle) {
+  float delta_time = float(time_ - particle_times_[particle]);
+  if (delta_time != 0) {
+    store->GetXPositions()[particle] +=
+        store->GetXVelocities()[particle] * delta_time;
+    store->GetYPositions()[particle] +=
+        store->GetYVelocities()[particle] * delta_time;
+  }
+
+  particle_times_[particle] = time_;
+}
+
+void EventDrivenEngine::AddToCell(size_t particle) {
+  size_t& head = cell_heads_[particle_cells_[2 * particle + 1] * num_cells_[0] +
+                             particle_cells_[2 * particle]];
+  previous_in_cell_[particle] = kNoParticle;
+  next_in_cell_[particle] = head;
+  if (head != kNoParticle) {
+    previous_in_cell_[head] = particle;
+  }
+  head = particle;
+}
+
+void EventDrivenEngine::RemoveFromCell(size_t particle) {
+  size_t previous = previous_in_cell_[particle];
+  size_t next = next_in_cell_[particle];
+  if (previous == kNoParticle) {
+    cell_heads_[particle_cells_[2 * particle + 1] * num_cells_[0] +
+                particle_cells_[2 * particle]] = next;
+  } else {
+    next_in_cell_[previous] = next;
+  }
+  if (next != kNoParticle) {
+    previous_in_cell_[next] = previous;
+  }
+}
+
+void EventDrivenEngine::PushEvent(const Event& event) {
+  events_.push_back(event);
+  std::push_heap(events_.begin(), events_.end(), std::greater<Event>());
+}
+
+}  // namespace idealgas
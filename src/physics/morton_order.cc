@@ -0,0 +1,86 @@
+#include "physics/morton_order.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+
+namespace {
+
+// The number of cells along each side of the container
+const float kNumCells = 65536.0f;
+
+/**
+ * Quantizes a coordinate to a cell, clamping particles that have strayed past
+ * the walls into the edge cells
+ */
+uint16_t CalculateCell(float coordinate, float min, float max) {
+  float cell = (coordinate - min) / (max - min) * kNumCells;
+  if (!(cell > 0)) {
+    return 0;
+  }
+
+  return uint16_t(std::min(cell, kNumCells - 1));
+}
+
+}  // namespace
+
+MortonOrder::MortonOrder() = default;
+
+const std::vector<size_t>& MortonOrder::Sort(
+    const ParticleStore& store, const glm::vec2& top_left_corner,
+    const glm::vec2& bottom_right_corner) {
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+
+  coded_slots_.resize(store.Size());
+  for (size_t slot = 0; slot < store.Size(); ++slot) {
+    uint16_t column = CalculateCell(x_positions[slot], top_left_corner.x,
+                                    bottom_right_corner.x);
+    uint16_t row = CalculateCell(y_positions[slot], top_left_corner.y,
+                                 bottom_right_corner.y);
+    coded_slots_[slot] = std::make_pair(CalculateCode(column, row), slot);
+  }
+
+  std::sort(coded_slots_.begin(), coded_slots_.end());
+
+  order_.resize(coded_slots_.size());
+  for (size_t slot = 0; slot < coded_slots_.size(); ++slot) {
+    order_[slot] = coded_slots_[slot].second;
+  }
+
+  return order_;
+}
+
+uint32_t MortonOrder::CalculateCode(uint16_t column, uint16_t row) {
+  return SpreadBits(column) | (SpreadBits(row) << 1);
+}
+
+float MortonOrder::CalculateSpread(const ParticleStore& store) {
+  if (store.Size() < 2) {
+    return 0;
+  }
+
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+  float total_distance = 0;
+  for (size_t slot = 1; slot < store.Size(); ++slot) {
+    float x_distance = x_positions[slot] - x_positions[slot - 1];
+    float y_distance = y_positions[slot] - y_positions[slot - 1];
+    total_distance +=
+        std::sqrt(x_distance * x_distance + y_distance * y_distance);
+  }
+
+  return total_distance / float(store.Size() - 1);
+}
+
+uint32_t MortonOrder::SpreadBits(uint16_t value) {
+  uint32_t bits = value;
+  bits = (bits | (bits << 8)) & 0x00FF00FF;
+  bits = (bits | (bits << 4)) & 0x0F0F0F0F;
+  bits = (bits | (bits << 2)) & 0x33333333;
+  bits = (bits | (bits << 1)) & 0x55555555;
+  return bits;
+}
+
+}  // namespace idealgas
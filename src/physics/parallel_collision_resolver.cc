@@ -0,0 +1,240 @@
+#include "physics/parallel_collision_resolver.h"
+
+#include <algorithm>
+
+#include "physics/aabb_tree.h"
+#include "physics/sweep_and_prune.h"
+#include "physics/uniform_grid.h"
+#include "physics/verlet_neighbour_list.h"
+
+namespace idealgas {
+
+namespace {
+
+// The fewest particles or pairs worth handing out as one chunk
+const size_t kMinParticlesPerChunk = 64;
+const size_t kMinPairsPerChunk = 256;
+
+/**
+ * Grows every buffer to the capacity of the largest one. Which thread or chunk
+ * meets the most crowded particles changes from frame to frame, so sharing
+ * the high water mark keeps the buffers from growing again every time it
+ * moves.
+ * @param buffers the buffers to grow
+ */
+template <typename T>
+void ReserveToLargest(std::vector<std::vector<T>>* buffers) {
+  size_t capacity = 0;
+  for (const std::vector<T>& buffer : *buffers) {
+    capacity = std::max(buffer.capacity(), capacity);
+  }
+
+  for (std::vector<T>& buffer : *buffers) {
+    buffer.reserve(capacity);
+  }
+}
+
+}  // namespace
+
+ParallelCollisionResolver::ParallelCollisionResolver()
+    : ParallelCollisionResolver(nullptr) {
+}
+
+ParallelCollisionResolver::ParallelCollisionResolver(
+    WorkStealingPool* task_pool)
+    : color_starts_(1, 0) {
+  SetTaskPool(task_pool);
+}
+
+template <typename Task>
+void ParallelCollisionResolver::ParallelFor(size_t count, size_t grain_size,
+                                            const Task& task) {
+  if (task_pool_ == nullptr) {
+    for (size_t begin = 0; begin < count; begin += grain_size) {
+      task(begin, std::min(begin + grain_size, count), 0);
+    }
+    return;
+  }
+
+  task_pool_->ParallelFor(count, grain_size, task);
+}
+
+template <typename NeighbourSource>
+size_t ParallelCollisionResolver::ResolveCollisions(
+    ParticleStore* store, const NeighbourSource& neighbour_source,
+    const CollisionPhysics& physics) {
+  FindTouchingPairs(*store, neighbour_source, physics);
+  return ResolveTouchingPairs(store, physics);
+}
+
+size_t ParallelCollisionResolver::ResolveTouchingPairs(
+    ParticleStore* store, const CollisionPhysics& physics) {
+  BuildColorClasses(store->Size());
+
+  // No two pairs of a color share a particle, so a color's pairs can be
+  // resolved in any order and on any thread with the same result
+  std::fill(thread_collisions_.begin(), thread_collisions_.end(), 0);
+  for (size_t color = 0; color + 1 < color_starts_.size(); ++color) {
+    size_t first_pair = color_starts_[color];
+    size_t num_pairs = color_starts_[color + 1] - first_pair;
+    auto resolve_pairs = [&](size_t begin, size_t end, size_t thread) {
+      size_t num_collisions = 0;
+      for (size_t pair = first_pair + begin; pair < first_pair + end; ++pair) {
+        size_t slot1 = color_pairs_[pair].first;
+        size_t slot2 = color_pairs_[pair].second;
+        if (physics.DidParticlesCollide(*store, slot1, slot2)) {
+          physics.UpdateCollidedParticleVelocities(store, slot1, slot2);
+          ++num_collisions;
+        }
+      }
+      thread_collisions_[thread] += num_collisions;
+    };
+
+    ParallelFor(num_pairs, CalculateGrainSize(num_pairs, kMinPairsPerChunk),
+                resolve_pairs);
+  }
+
+  size_t num_collisions = 0;
+  for (size_t thread_collisions : thread_collisions_) {
+    num_collisions += thread_collisions;
+  }
+
+  return num_collisions;
+}
+
+void ParallelCollisionResolver::SetTaskPool(WorkStealingPool* task_pool) {
+  task_pool_ = task_pool;
+  thread_candidates_.resize(GetNumThreads());
+  thread_pair_tests_.assign(GetNumThreads(), 0);
+  thread_collisions_.assign(GetNumThreads(), 0);
+}
+
+size_t ParallelCollisionResolver::GetNumThreads() const {
+  return task_pool_ == nullptr ? 1 : task_pool_->GetNumThreads();
+}
+
+size_t ParallelCollisionResolver::CalculateGrainSize(
+    size_t count, size_t min_grain_size) const {
+  if (task_pool_ == nullptr) {
+    return std::max(count, size_t(1));
+  }
+
+  return task_pool_->CalculateGrainSize(count, min_grain_size);
+}
+
+const std::vector<std::pair<size_t, size_t>>&
+ParallelCollisionResolver::GetTouchingPairs() const {
+  return touching_pairs_;
+}
+
+size_t ParallelCollisionResolver::GetNumColors() const {
+  return color_starts_.size() - 1;
+}
+
+size_t ParallelCollisionResolver::GetNumPairTests() const {
+  size_t num_pair_tests = 0;
+  for (size_t thread_pair_tests : thread_pair_tests_) {
+    num_pair_tests += thread_pair_tests;
+  }
+
+  return num_pair_tests;
+}
+
+template <typename NeighbourSource>
+void ParallelCollisionResolver::FindTouchingPairs(
+    const ParticleStore& store, const NeighbourSource& neighbour_source,
+    const CollisionPhysics& physics) {
+  size_t num_particles = store.Size();
+
+  // Each chunk is a contiguous run of particles, so joining the chunks' pairs
+  // in chunk order keeps the pairs in serial order whichever thread ran them
+  size_t grain_size =
+      CalculateGrainSize(num_particles, kMinParticlesPerChunk);
+  size_t num_chunks = (num_particles + grain_size - 1) / grain_size;
+  if (chunk_pairs_.size() < num_chunks) {
+    chunk_pairs_.resize(num_chunks);
+  }
+
+  auto find_chunk_pairs = [&](size_t first_particle, size_t end_particle,
+                              size_t thread) {
+    std::vector<std::pair<size_t, size_t>>& pairs =
+        chunk_pairs_[first_particle / grain_size];
+    std::vector<size_t>& candidates = thread_candidates_[thread];
+    pairs.clear();
+    size_t num_pair_tests = 0;
+
+    for (size_t particle_1_idx = first_particle; particle_1_idx < end_particle;
+         ++particle_1_idx) {
+      neighbour_source.GatherNeighbourCandidates(particle_1_idx, &candidates);
+      num_pair_tests += candidates.size();
+
+      for (size_t particle_2_idx : candidates) {
+        if (physics.AreParticlesTouching(store, particle_1_idx,
+                                         particle_2_idx)) {
+          pairs.push_back(std::make_pair(particle_1_idx, particle_2_idx));
+        }
+      }
+    }
+    thread_pair_tests_[thread] += num_pair_tests;
+  };
+
+  std::fill(thread_pair_tests_.begin(), thread_pair_tests_.end(), 0);
+  ParallelFor(num_particles, grain_size, find_chunk_pairs);
+  ReserveToLargest(&chunk_pairs_);
+  ReserveToLargest(&thread_candidates_);
+
+  touching_pairs_.clear();
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    touching_pairs_.insert(touching_pairs_.end(), chunk_pairs_[chunk].begin(),
+                           chunk_pairs_[chunk].end());
+  }
+}
+
+void ParallelCollisionResolver::BuildColorClasses(size_t num_particles) {
+  // Each pair takes the first color after every earlier pair sharing one of
+  // its particles, so every particle still meets its pairs in serial order
+  particle_next_colors_.assign(num_particles, 0);
+  pair_colors_.resize(touching_pairs_.size());
+  color_starts_.assign(1, 0);
+  for (size_t pair = 0; pair < touching_pairs_.size(); ++pair) {
+    size_t slot1 = touching_pairs_[pair].first;
+    size_t slot2 = touching_pairs_[pair].second;
+    size_t color =
+        std::max(particle_next_colors_[slot1], particle_next_colors_[slot2]);
+    particle_next_colors_[slot1] = color + 1;
+    particle_next_colors_[slot2] = color + 1;
+    pair_colors_[pair] = color;
+
+    if (color + 1 == color_starts_.size()) {
+      color_starts_.push_back(0);
+    }
+    ++color_starts_[color + 1];
+  }
+
+  for (size_t color = 1; color < color_starts_.size(); ++color) {
+    color_starts_[color] += color_starts_[color - 1];
+  }
+
+  // Scattering in serial order keeps every color's pairs in serial order
+  color_fill_.assign(color_starts_.begin(), color_starts_.end() - 1);
+  color_pairs_.resize(touching_pairs_.size());
+  for (size_t pair = 0; pair < touching_pairs_.size(); ++pair) {
+    color_pairs_[color_fill_[pair_colors_[pair]]++] = touching_pairs_[pair];
+  }
+}
+
+// The broad phases the resolver can be handed
+template size_t ParallelCollisionResolver::ResolveCollisions(
+    ParticleStore* store, const UniformGrid& grid,
+    const CollisionPhysics& physics);
+template size_t ParallelCollisionResolver::ResolveCollisions(
+    ParticleStore* store, const VerletNeighbourList& neighbours,
+    const CollisionPhysics& physics);
+template size_t ParallelCollisionResolver::ResolveCollisions(
+    ParticleStore* store, const SweepAndPrune& sweep_and_prune,
+    const CollisionPhysics& physics);
+template size_t ParallelCollisionResolver::ResolveCollisions(
+    ParticleStore* store, const AabbTree& tree,
+    const CollisionPhysics& physics);
+
+}  // namespace idealgas
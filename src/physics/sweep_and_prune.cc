@@ -0,0 +1,114 @@
+#include "physics/sweep_and_prune.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace idealgas {
+
+namespace {
+
+// Intervals are padded a little so rounding can never drop a touching pair
+const float kIntervalSlack = 1.001f;
+
+}  // namespace
+
+SweepAndPrune::SweepAndPrune() : is_valid_(false), num_swaps_(0) {
+}
+
+void SweepAndPrune::Update(const ParticleStore& store) {
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+  const float* radii = store.GetRadii();
+  size_t num_particles = store.Size();
+
+  if (intervals_.size() != num_particles) {
+    is_valid_ = false;
+  }
+
+  if (!is_valid_) {
+    intervals_.resize(num_particles);
+    for (size_t slot = 0; slot < num_particles; ++slot) {
+      intervals_[slot].slot = slot;
+    }
+  }
+
+  for (Interval& interval : intervals_) {
+    float half_width = radii[interval.slot] * kIntervalSlack;
+    interval.min_x = x_positions[interval.slot] - half_width;
+    interval.max_x = x_positions[interval.slot] + half_width;
+
+    // A NaN can't be ordered, which would break both sorts, and can't touch
+    // anything either, so it is put past every other interval
+    if (std::isnan(interval.min_x) || std::isnan(interval.max_x)) {
+      interval.min_x = std::numeric_limits<float>::infinity();
+      interval.max_x = interval.min_x;
+    }
+  }
+
+  if (is_valid_) {
+    InsertionSort();
+  } else {
+    std::sort(intervals_.begin(), intervals_.end(),
+              [](const Interval& interval1, const Interval& interval2) {
+                return interval1.min_x < interval2.min_x;
+              });
+    num_swaps_ = 0;
+    is_valid_ = true;
+  }
+
+  // Sweep along x, pruning pairs whose y-intervals are apart
+  pairs_.Clear();
+  for (size_t first = 0; first < intervals_.size(); ++first) {
+    const Interval& interval1 = intervals_[first];
+    for (size_t second = first + 1; second < intervals_.size(); ++second) {
+      // Every later interval starts further right, so none of them overlap
+      if (intervals_[second].min_x > interval1.max_x) {
+        break;
+      }
+
+      size_t slot1 = interval1.slot;
+      size_t slot2 = intervals_[second].slot;
+      float reach = (radii[slot1] + radii[slot2]) * kIntervalSlack;
+      if (std::abs(y_positions[slot1] - y_positions[slot2]) <= reach) {
+        pairs_.Add(slot1, slot2);
+      }
+    }
+  }
+
+  pairs_.Group(num_particles);
+}
+
+void SweepAndPrune::Invalidate() {
+  is_valid_ = false;
+}
+
+void SweepAndPrune::GatherNeighbourCandidates(
+    size_t particle_idx, std::vector<size_t>* candidates) const {
+  pairs_.GatherNeighbourCandidates(particle_idx, candidates);
+}
+
+size_t SweepAndPrune::GetNumSwaps() const {
+  return num_swaps_;
+}
+
+size_t SweepAndPrune::GetNumPairs() const {
+  return pairs_.Size();
+}
+
+void SweepAndPrune::InsertionSort() {
+  num_swaps_ = 0;
+  for (size_t next = 1; next < intervals_.size(); ++next) {
+    Interval interval = intervals_[next];
+    size_t position = next;
+    while (position > 0 && intervals_[position - 1].min_x > interval.min_x) {
+      intervals_[position] = intervals_[position - 1];
+      --position;
+    }
+
+    intervals_[position] = interval;
+    num_swaps_ += next - position;
+  }
+}
+
+}  // namespace idealgas
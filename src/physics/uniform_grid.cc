@@ -0,0 +1,289 @@
+#include "physics/uniform_grid.h"
+
+#include <algorithm>
+
+namespace idealgas {
+
+const size_t UniformGrid::kMaxCellsPerAxis;
+const size_t UniformGrid::kMinParticlesPerPart;
+const size_t UniformGrid::kBucketsPerPart;
+
+UniformGrid::UniformGrid()
+    : origin_(0, 0),
+      cell_size_(1.0f),
+      num_columns_(0),
+      num_rows_(0),
+      task_pool_(nullptr),
+      num_parts_(1) {
+}
+
+template <typename Task>
+void UniformGrid::RunParts(const Task& task) {
+  if (num_parts_ == 1) {
+    task(0);
+    return;
+  }
+
+  task_pool_->RunTasks(num_parts_, task);
+}
+
+void UniformGrid::Rebuild(const ParticleStore& store,
+                          const glm::vec2& top_left_corner,
+                          const glm::vec2& bottom_right_corner) {
+  Rebuild(store, top_left_corner, bottom_right_corner, 0);
+}
+
+void UniformGrid::Rebuild(const ParticleStore& store,
+                          const glm::vec2& top_left_corner,
+                          const glm::vec2& bottom_right_corner, float skin) {
+  const float* radii = store.GetRadii();
+  size_t num_particles = store.Size();
+
+  // Each part is a contiguous run of the particles. Every particle costs the
+  // same to bin, so one part per thread balances, but small runs aren't worth
+  // waking a thread for.
+  size_t num_threads = task_pool_ == nullptr ? 1 : task_pool_->GetNumThreads();
+  num_parts_ = std::max(
+      std::min(num_threads, num_particles / kMinParticlesPerPart), size_t(1));
+  part_max_radii_.resize(num_parts_);
+
+  RunParts([&](size_t part) {
+    float max_radius = 0;
+    size_t first_idx = num_particles * part / num_parts_;
+    size_t last_idx = num_particles * (part + 1) / num_parts_;
+    for (size_t idx = first_idx; idx < last_idx; ++idx) {
+      max_radius = std::max(radii[idx], max_radius);
+    }
+    part_max_radii_[part] = max_radius;
+  });
+
+  float max_radius = 0;
+  for (float part_max_radius : part_max_radii_) {
+    max_radius = std::max(part_max_radius, max_radius);
+  }
+
+  float width = std::max(bottom_right_corner.x - top_left_corner.x, 1.0f);
+  float height = std::max(bottom_right_corner.y - top_left_corner.y, 1.0f);
+
+  // A cell must span a whole diameter plus the skin so touching particles are
+  // neighbours, with a little slack so rounding can never push them two cells
+  // apart
+  cell_size_ = std::max((2 * max_radius + skin) * 1.001f, 1.0f);
+  cell_size_ = std::max(cell_size_, width / kMaxCellsPerAxis);
+  cell_size_ = std::max(cell_size_, height / kMaxCellsPerAxis);
+
+  origin_ = top_left_corner;
+  num_columns_ = size_t(width / cell_size_) + 1;
+  num_rows_ = size_t(height / cell_size_) + 1;
+
+  // Counting sort of the particles by cell so each cell is a contiguous range.
+  // The particles are first split into runs of cells holding about as many
+  // particles each, so each part then sorts only its own cells and particles.
+  size_t num_cells = num_columns_ * num_rows_;
+  cell_starts_.resize(num_cells + 1);
+  particle_cells_.resize(num_particles);
+  cell_entries_.resize(num_particles);
+  // A single part sorts every cell, so it needs no buckets to cut them by
+  size_t num_buckets = num_parts_ == 1 ? 0 : num_parts_ * kBucketsPerPart;
+  part_bucket_counts_.resize(num_parts_ * num_buckets);
+  bucket_ranges_.resize(num_buckets);
+  part_range_counts_.resize(num_parts_ * num_parts_);
+  range_first_cells_.resize(num_parts_ + 1);
+  range_starts_.resize(num_parts_ + 1);
+  SplitParticlesByCellRange(store);
+  SortCellRanges();
+  cell_starts_[num_cells] = num_particles;
+}
+
+void UniformGrid::GatherNeighbourCandidates(
+    size_t particle_idx, std::vector<size_t>* candidates) const {
+  candidates->clear();
+
+  size_t cell = particle_cells_[particle_idx];
+  size_t column = cell % num_columns_;
+  size_t row = cell / num_columns_;
+
+  size_t first_row = row == 0 ? 0 : row - 1;
+  size_t last_row = std::min(row + 1, num_rows_ - 1);
+  size_t first_column = column == 0 ? 0 : column - 1;
+  size_t last_column = std::min(column + 1, num_columns_ - 1);
+
+  for (size_t neighbour_row = first_row; neighbour_row <= last_row;
+       ++neighbour_row) {
+    for (size_t neighbour_column = first_column;
+         neighbour_column <= last_column; ++neighbour_column) {
+      size_t neighbour_cell = neighbour_row * num_columns_ + neighbour_column;
+
+      for (size_t entry = cell_starts_[neighbour_cell];
+           entry < cell_starts_[neighbour_cell + 1]; ++entry) {
+        if (cell_entries_[entry] > particle_idx) {
+          candidates->push_back(cell_entries_[entry]);
+        }
+      }
+    }
+  }
+
+  // Pairs must be visited in the same order as the all-pairs loop
+  std::sort(candidates->begin(), candidates->end());
+}
+
+float UniformGrid::GetCellSize() const {
+  return cell_size_;
+}
+
+size_t UniformGrid::GetNumColumns() const {
+  return num_columns_;
+}
+
+size_t UniformGrid::GetNumRows() const {
+  return num_rows_;
+}
+
+void UniformGrid::SetTaskPool(WorkStealingPool* task_pool) {
+  task_pool_ = task_pool;
+}
+
+size_t UniformGrid::CalculateCellBucket(size_t cell) const {
+  return cell * bucket_ranges_.size() / (num_columns_ * num_rows_);
+}
+
+size_t UniformGrid::CalculateFirstBucketCell(size_t bucket) const {
+  // The first cell CalculateCellBucket puts in the bucket
+  size_t num_buckets = bucket_ranges_.size();
+  return (bucket * num_columns_ * num_rows_ + num_buckets - 1) / num_buckets;
+}
+
+void UniformGrid::SplitParticlesByCellRange(const ParticleStore& store) {
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+  size_t num_particles = store.Size();
+  size_t num_parts = num_parts_;
+  size_t num_cells = num_columns_ * num_rows_;
+  size_t num_buckets = bucket_ranges_.size();
+
+  // Row p of part_bucket_counts_ counts part p's particles in each bucket of
+  // cells, which are far narrower than a part's eventual run of cells
+  RunParts([&](size_t part) {
+    size_t* bucket_counts = part_bucket_counts_.data() + part * num_buckets;
+    std::fill(bucket_counts, bucket_counts + num_buckets, 0);
+
+    size_t first_idx = num_particles * part / num_parts;
+    size_t last_idx = num_particles * (part + 1) / num_parts;
+    for (size_t idx = first_idx; idx < last_idx; ++idx) {
+      size_t column =
+          CalculateCellCoordinate(x_positions[idx], origin_.x, num_columns_);
+      size_t row =
+          CalculateCellCoordinate(y_positions[idx], origin_.y, num_rows_);
+      particle_cells_[idx] = row * num_columns_ + column;
+      if (num_buckets > 0) {
+        ++bucket_counts[CalculateCellBucket(particle_cells_[idx])];
+      }
+    }
+  });
+
+  // A single range already holds every particle in container order
+  range_first_cells_[0] = 0;
+  range_first_cells_[num_parts] = num_cells;
+  range_starts_[0] = 0;
+  range_starts_[num_parts] = num_particles;
+  if (num_parts == 1) {
+    return;
+  }
+
+  // Cuts the runs of cells between buckets by how many particles come before
+  // each bucket, so a crowded corner is shared out between several parts.
+  // There are only parts squared times kBucketsPerPart counts, so this is done
+  // serially.
+  std::fill(part_range_counts_.begin(), part_range_counts_.end(), 0);
+  size_t num_before = 0;
+  size_t range = 0;
+  for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+    size_t bucket_range =
+        std::min(num_before * num_parts / num_particles, num_parts - 1);
+    while (range < bucket_range) {
+      range_first_cells_[++range] = CalculateFirstBucketCell(bucket);
+    }
+    bucket_ranges_[bucket] = range;
+
+    for (size_t part = 0; part < num_parts; ++part) {
+      size_t count = part_bucket_counts_[part * num_buckets + bucket];
+      part_range_counts_[part * num_parts + range] += count;
+      num_before += count;
+    }
+  }
+  while (range + 1 < num_parts) {
+    range_first_cells_[++range] = num_cells;
+  }
+
+  // Within a range the earlier parts' particles go first
+  size_t start = 0;
+  for (range = 0; range < num_parts; ++range) {
+    range_starts_[range] = start;
+    for (size_t part = 0; part < num_parts; ++part) {
+      size_t& count = part_range_counts_[part * num_parts + range];
+      size_t part_start = start;
+      start += count;
+      count = part_start;
+    }
+  }
+
+  range_entries_.resize(num_particles);
+  RunParts([&](size_t part) {
+    size_t* range_fill = &part_range_counts_[part * num_parts];
+    size_t first_idx = num_particles * part / num_parts;
+    size_t last_idx = num_particles * (part + 1) / num_parts;
+    for (size_t idx = first_idx; idx < last_idx; ++idx) {
+      size_t cell_range =
+          bucket_ranges_[CalculateCellBucket(particle_cells_[idx])];
+      range_entries_[range_fill[cell_range]++] = idx;
+    }
+  });
+}
+
+void UniformGrid::SortCellRanges() {
+  const size_t* range_entries =
+      num_parts_ == 1 ? nullptr : range_entries_.data();
+
+  RunParts([&](size_t part) {
+    size_t first_cell = range_first_cells_[part];
+    size_t last_cell = range_first_cells_[part + 1];
+    size_t first_entry = range_starts_[part];
+    size_t last_entry = range_starts_[part + 1];
+
+    // Counts each cell in its own start, then moves every start to the end
+    // of its cell
+    std::fill(&cell_starts_[first_cell], &cell_starts_[last_cell], 0);
+    for (size_t entry = first_entry; entry < last_entry; ++entry) {
+      size_t idx = range_entries == nullptr ? entry : range_entries[entry];
+      ++cell_starts_[particle_cells_[idx]];
+    }
+
+    size_t end = first_entry;
+    for (size_t cell = first_cell; cell < last_cell; ++cell) {
+      end += cell_starts_[cell];
+      cell_starts_[cell] = end;
+    }
+
+    // Filling each cell from its end while walking the particles backwards
+    // keeps every cell sorted by index and leaves each start where it belongs
+    for (size_t entry = last_entry; entry > first_entry; --entry) {
+      size_t idx =
+          range_entries == nullptr ? entry - 1 : range_entries[entry - 1];
+      cell_entries_[--cell_starts_[particle_cells_[idx]]] = idx;
+    }
+  });
+}
+
+size_t UniformGrid::CalculateCellCoordinate(float coordinate, float origin,
+                                            size_t num_cells) const {
+  // Clamped while still a float, since converting a NaN, negative or huge
+  // float to an integer is undefined; NaN fails the first test
+  float cell = (coordinate - origin) / cell_size_;
+  if (!(cell > 0)) {
+    return 0;
+  }
+
+  return size_t(std::min(cell, float(num_cells - 1)));
+}
+
+}  // namespace idealgas
@@ -0,0 +1,123 @@
+#include "physics/verlet_neighbour_list.h"
+
+#include <algorithm>
+
+namespace idealgas {
+
+namespace {
+
+// The reach is padded a little so rounding can never drop a touching pair
+const float kReachSlack = 1.001f;
+
+}  // namespace
+
+const float VerletNeighbourList::kDefaultSkin = 2.0f;
+
+VerletNeighbourList::VerletNeighbourList()
+    : VerletNeighbourList(kDefaultSkin) {
+}
+
+VerletNeighbourList::VerletNeighbourList(float skin)
+    : skin_(std::max(skin, 0.0f)), is_valid_(false), num_rebuilds_(0) {
+}
+
+bool VerletNeighbourList::Update(const ParticleStore& store,
+                                 const glm::vec2& top_left_corner,
+                                 const glm::vec2& bottom_right_corner) {
+  if (is_valid_ && built_x_positions_.size() == store.Size() &&
+      !HasMovedTooFar(store)) {
+    return false;
+  }
+
+  Rebuild(store, top_left_corner, bottom_right_corner);
+  return true;
+}
+
+void VerletNeighbourList::Invalidate() {
+  is_valid_ = false;
+}
+
+void VerletNeighbourList::SetSkin(float skin) {
+  skin_ = std::max(skin, 0.0f);
+  Invalidate();
+}
+
+float VerletNeighbourList::GetSkin() const {
+  return skin_;
+}
+
+void VerletNeighbourList::GatherNeighbourCandidates(
+    size_t particle_idx, std::vector<size_t>* candidates) const {
+  const size_t* neighbours = GetNeighbours(particle_idx);
+  candidates->assign(neighbours,
+                     neighbours + GetNumNeighbours(particle_idx));
+}
+
+const size_t* VerletNeighbourList::GetNeighbours(size_t particle_idx) const {
+  return neighbours_.data() + neighbour_starts_[particle_idx];
+}
+
+size_t VerletNeighbourList::GetNumNeighbours(size_t particle_idx) const {
+  return neighbour_starts_[particle_idx + 1] - neighbour_starts_[particle_idx];
+}
+
+size_t VerletNeighbourList::GetNumRebuilds() const {
+  return num_rebuilds_;
+}
+
+void VerletNeighbourList::Rebuild(const ParticleStore& store,
+                                  const glm::vec2& top_left_corner,
+                                  const glm::vec2& bottom_right_corner) {
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+  const float* radii = store.GetRadii();
+  size_t num_particles = store.Size();
+
+  grid_.Rebuild(store, top_left_corner, bottom_right_corner, skin_);
+  candidates_.reserve(num_particles);
+  neighbour_starts_.resize(num_particles + 1);
+  neighbours_.clear();
+
+  for (size_t particle_1_idx = 0; particle_1_idx < num_particles;
+       ++particle_1_idx) {
+    neighbour_starts_[particle_1_idx] = neighbours_.size();
+    grid_.GatherNeighbourCandidates(particle_1_idx, &candidates_);
+
+    for (size_t particle_2_idx : candidates_) {
+      float delta_x = x_positions[particle_1_idx] - x_positions[particle_2_idx];
+      float delta_y = y_positions[particle_1_idx] - y_positions[particle_2_idx];
+      float reach =
+          (radii[particle_1_idx] + radii[particle_2_idx] + skin_) * kReachSlack;
+      if (delta_x * delta_x + delta_y * delta_y <= reach * reach) {
+        neighbours_.push_back(particle_2_idx);
+      }
+    }
+  }
+  neighbour_starts_[num_particles] = neighbours_.size();
+
+  built_x_positions_.assign(x_positions, x_positions + num_particles);
+  built_y_positions_.assign(y_positions, y_positions + num_particles);
+  is_valid_ = true;
+  ++num_rebuilds_;
+}
+
+bool VerletNeighbourList::HasMovedTooFar(const ParticleStore& store) const {
+  const float* x_positions = store.GetXPositions();
+  const float* y_positions = store.GetYPositions();
+
+  // Two particles each moving half the skin towards each other is the most
+  // that can close a listed gap
+  float max_displacement = skin_ / 2;
+  float max_squared_displacement = max_displacement * max_displacement;
+  for (size_t slot = 0; slot < store.Size(); ++slot) {
+    float delta_x = x_positions[slot] - built_x_positions_[slot];
+    float delta_y = y_positions[slot] - built_y_positions_[slot];
+    if (delta_x * delta_x + delta_y * delta_y > max_squared_displacement) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,204 @@
+#include "physics/wall_collision_kernel.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define IDEALGAS_WALL_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles AVX2 intrinsics anywhere, GCC and Clang need them enabled per
+// function so the rest of the build stays runnable on older CPUs
+#if defined(IDEALGAS_WALL_KERNEL_X86) && !defined(_MSC_VER)
+#define IDEALGAS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define IDEALGAS_TARGET_AVX2
+#endif
+
+namespace idealgas {
+
+namespace {
+
+/**
+ * Reference kernel that also finishes the tail the vector kernels leave over
+ */
+size_t ReflectScalar(const float* positions, float* velocities,
+                     const float* radii, size_t begin, size_t end,
+                     float near_wall, float far_wall) {
+  size_t num_reflected = 0;
+  for (size_t idx = begin; idx < end; ++idx) {
+    float velocity = velocities[idx];
+    bool hits_near_wall = positions[idx] - radii[idx] <= near_wall &&
+                          velocity < 0;
+    bool hits_far_wall = positions[idx] + radii[idx] >= far_wall &&
+                         velocity > 0;
+    bool hits_wall = hits_near_wall || hits_far_wall;
+    velocities[idx] = hits_wall ? -velocity : velocity;
+    num_reflected += hits_wall;
+  }
+
+  return num_reflected;
+}
+
+#ifdef IDEALGAS_WALL_KERNEL_X86
+
+size_t ReflectSse(const float* positions, float* velocities,
+                  const float* radii, size_t count, float near_wall,
+                  float far_wall) {
+  const __m128 near_walls = _mm_set1_ps(near_wall);
+  const __m128 far_walls = _mm_set1_ps(far_wall);
+  const __m128 zeros = _mm_setzero_ps();
+  const __m128 sign_bits = _mm_set1_ps(-0.0f);
+  __m128i lane_reflections = _mm_setzero_si128();
+
+  size_t idx = 0;
+  for (; idx + 4 <= count; idx += 4) {
+    __m128 position = _mm_loadu_ps(positions + idx);
+    __m128 radius = _mm_loadu_ps(radii + idx);
+    __m128 velocity = _mm_loadu_ps(velocities + idx);
+
+    __m128 hits_near_wall =
+        _mm_and_ps(_mm_cmple_ps(_mm_sub_ps(position, radius), near_walls),
+                   _mm_cmplt_ps(velocity, zeros));
+    __m128 hits_far_wall =
+        _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(position, radius), far_walls),
+                   _mm_cmpgt_ps(velocity, zeros));
+
+    // Negating is flipping the sign bit of the lanes that hit a wall
+    __m128 hits_wall = _mm_or_ps(hits_near_wall, hits_far_wall);
+    __m128 flips = _mm_and_ps(hits_wall, sign_bits);
+    _mm_storeu_ps(velocities + idx, _mm_xor_ps(velocity, flips));
+
+    // A hit lane is all ones, which is minus one as an integer
+    lane_reflections =
+        _mm_sub_epi32(lane_reflections, _mm_castps_si128(hits_wall));
+  }
+
+  int lane_counts[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_counts), lane_reflections);
+  return size_t(lane_counts[0]) + lane_counts[1] + lane_counts[2] +
+         lane_counts[3] +
+         ReflectScalar(positions, velocities, radii, idx, count, near_wall,
+                       far_wall);
+}
+
+IDEALGAS_TARGET_AVX2
+size_t ReflectAvx2(const float* positions, float* velocities,
+                   const float* radii, size_t count, float near_wall,
+                   float far_wall) {
+  const __m256 near_walls = _mm256_set1_ps(near_wall);
+  const __m256 far_walls = _mm256_set1_ps(far_wall);
+  const __m256 zeros = _mm256_setzero_ps();
+  const __m256 sign_bits = _mm256_set1_ps(-0.0f);
+  __m256i lane_reflections = _mm256_setzero_si256();
+
+  size_t idx = 0;
+  for (; idx + 8 <= count; idx += 8) {
+    __m256 position = _mm256_loadu_ps(positions + idx);
+    __m256 radius = _mm256_loadu_ps(radii + idx);
+    __m256 velocity = _mm256_loadu_ps(velocities + idx);
+
+    __m256 hits_near_wall = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_sub_ps(position, radius), near_walls,
+                      _CMP_LE_OQ),
+        _mm256_cmp_ps(velocity, zeros, _CMP_LT_OQ));
+    __m256 hits_far_wall = _mm256_and_ps(
+        _mm256_cmp_ps(_mm256_add_ps(position, radius), far_walls,
+                      _CMP_GE_OQ),
+        _mm256_cmp_ps(velocity, zeros, _CMP_GT_OQ));
+
+    __m256 hits_wall = _mm256_or_ps(hits_near_wall, hits_far_wall);
+    __m256 flips = _mm256_and_ps(hits_wall, sign_bits);
+    _mm256_storeu_ps(velocities + idx, _mm256_xor_ps(velocity, flips));
+
+    lane_reflections =
+        _mm256_sub_epi32(lane_reflections, _mm256_castps_si256(hits_wall));
+  }
+
+  int lane_counts[8];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lane_counts),
+                      lane_reflections);
+  size_t num_reflected = 0;
+  for (int lane_count : lane_counts) {
+    num_reflected += lane_count;
+  }
+
+  return num_reflected + ReflectScalar(positions, velocities, radii, idx,
+                                       count, near_wall, far_wall);
+}
+
+bool CpuSupportsAvx2() {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+
+  // The OS must also save the AVX registers across context switches
+  __cpuid(info, 1);
+  bool has_os_xsave = (info[2] & (1 << 27)) != 0;
+  if (!has_os_xsave || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif  // IDEALGAS_WALL_KERNEL_X86
+
+}  // namespace
+
+WallCollisionKernel::WallCollisionKernel()
+    : instruction_set_(DetectInstructionSet()) {
+}
+
+WallCollisionKernel::WallCollisionKernel(InstructionSet instruction_set)
+    : instruction_set_(instruction_set) {
+  if (instruction_set_ > DetectInstructionSet()) {
+    instruction_set_ = DetectInstructionSet();
+  }
+}
+
+size_t WallCollisionKernel::Reflect(const float* positions,
+                                    float* velocities, const float* radii,
+                                    size_t count, float near_wall,
+                                    float far_wall) const {
+  switch (instruction_set_) {
+#ifdef IDEALGAS_WALL_KERNEL_X86
+    case InstructionSet::kAvx2:
+      return ReflectAvx2(positions, velocities, radii, count, near_wall,
+                         far_wall);
+    case InstructionSet::kSse:
+      return ReflectSse(positions, velocities, radii, count, near_wall,
+                        far_wall);
+#endif
+    default:
+      return ReflectScalar(positions, velocities, radii, 0, count, near_wall,
+                           far_wall);
+  }
+}
+
+WallCollisionKernel::InstructionSet WallCollisionKernel::GetInstructionSet()
+    const {
+  return instruction_set_;
+}
+
+WallCollisionKernel::InstructionSet
+WallCollisionKernel::DetectInstructionSet() {
+#ifdef IDEALGAS_WALL_KERNEL_X86
+  // SSE2 is part of every x86-64 CPU, so only AVX2 needs checking
+  static const InstructionSet detected =
+      CpuSupportsAvx2() ? InstructionSet::kAvx2 : InstructionSet::kSse;
+  return detected;
+#else
+  return InstructionSet::kScalar;
+#endif
+}
+
+}  // namespace idealgas
@@ -0,0 +1,135 @@
+#include "physics/aabb_tree.h"
+
+#include <catch2/catch.hpp>
+
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+TEST_CASE("Bounding box tree finds overlapping particles") {
+  glm::vec2 velocity(0, 0);
+  float mass = 1.0f;
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  idealgas::AabbTree tree;
+  std::vector<size_t> candidates;
+
+  // A large particle among a line of small ones, enough for several leaves
+  store.Add(glm::vec2(50, 50), velocity, color, 20, mass);
+  for (size_t idx = 0; idx < 20; ++idx) {
+    store.Add(glm::vec2(5 + 10 * float(idx), 90), velocity, color, 1, mass);
+  }
+  store.Add(glm::vec2(65, 65), velocity, color, 1, mass);
+  REQUIRE(tree.Update(store));
+
+  SECTION("Only later particles with overlapping boxes are candidates") {
+    tree.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({21}));
+    tree.GatherNeighbourCandidates(1, &candidates);
+    REQUIRE(candidates.empty());
+    REQUIRE(tree.GetNumNodes() > 1);
+  }
+
+  SECTION("Small moves refit the tree instead of rebuilding it") {
+    store.SetPosition(3, glm::vec2(17, 91));
+    REQUIRE_FALSE(tree.Update(store));
+
+    tree.GatherNeighbourCandidates(2, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({3}));
+    REQUIRE(tree.GetNumRebuilds() == 1);
+  }
+
+  SECTION("Scattering the particles rebuilds the tree") {
+    for (size_t slot = 1; slot < store.Size(); ++slot) {
+      store.SetPosition(slot,
+                        glm::vec2(float(slot % 2) * 200, float(slot) * 10));
+    }
+
+    REQUIRE(tree.Update(store));
+    REQUIRE(tree.GetNumRebuilds() == 2);
+  }
+
+  SECTION("Invalidating or changing the particles rebuilds the tree") {
+    tree.Invalidate();
+    REQUIRE(tree.Update(store));
+
+    store.Add(glm::vec2(40, 40), velocity, color, 1, mass);
+    REQUIRE(tree.Update(store));
+    tree.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({21, 22}));
+  }
+}
+
+TEST_CASE("Automatic broad phase picks the tree for mixed particle sizes") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(400, 400);
+  std::vector<idealgas::Particle> particles;
+  srand(3);
+  // Radii 25 times apart, so a grid would crowd the small particles together
+  for (size_t idx = 0; idx < 500; ++idx) {
+    float radius = idx % 25 == 0 ? 25.0f : 1.0f;
+    glm::vec2 position(rand() % 400, rand() % 400);
+    glm::vec2 velocity(float(rand() % 5) - 2, float(rand() % 5) - 2);
+    particles.push_back(idealgas::Particle(position, velocity,
+                                           ci::Color("white"), radius,
+                                           radius));
+  }
+  std::vector<idealgas::Particle*> initial_particles;
+  for (idealgas::Particle& particle : particles) {
+    initial_particles.push_back(&particle);
+  }
+
+  idealgas::GasContainer tree_container(initial_particles, 0, top_left_corner,
+                                        bottom_right_corner, 1, 1,
+                                        ci::Color("white"));
+  idealgas::GasContainer grid_container(tree_container);
+  grid_container.SetBroadPhase(idealgas::BroadPhase::kUniformGrid);
+
+  SECTION("Only mixes past the radius ratio use the tree") {
+    REQUIRE(tree_container.GetBroadPhase() ==
+            idealgas::BroadPhase::kAutomatic);
+    REQUIRE(tree_container.GetActiveBroadPhase() ==
+            idealgas::BroadPhase::kAabbTree);
+    REQUIRE(grid_container.GetActiveBroadPhase() ==
+            idealgas::BroadPhase::kUniformGrid);
+
+    idealgas::GasContainer even_container(
+        std::vector<idealgas::Particle*>(), 50, top_left_corner,
+        bottom_right_corner, 3, 1, ci::Color("white"));
+    REQUIRE(even_container.GetActiveBroadPhase() ==
+            idealgas::BroadPhase::kUniformGrid);
+
+    // Once the large particles are gone the sizes are even again
+    const idealgas::ParticleStore& store = tree_container.GetParticleStore();
+    for (size_t slot = store.Size(); slot-- > 0;) {
+      if (store.GetRadius(slot) > 1) {
+        tree_container.RemoveParticle(slot);
+      }
+    }
+    REQUIRE(tree_container.GetActiveBroadPhase() ==
+            idealgas::BroadPhase::kUniformGrid);
+  }
+
+  SECTION("The tree resolves the same collisions as the grid") {
+    size_t num_threads = GENERATE(1, 3);
+    tree_container.SetNumThreads(num_threads);
+
+    for (size_t frame = 0; frame < 50; ++frame) {
+      if (frame == 25) {
+        grid_container.RemoveParticle(3);
+        tree_container.RemoveParticle(3);
+      }
+      grid_container.AdvanceOneFrame();
+      tree_container.AdvanceOneFrame();
+    }
+
+    const idealgas::ParticleStore& grid_store =
+        grid_container.GetParticleStore();
+    const idealgas::ParticleStore& tree_store =
+        tree_container.GetParticleStore();
+    REQUIRE(tree_store.Size() == grid_store.Size());
+    for (size_t slot = 0; slot < grid_store.Size(); ++slot) {
+      REQUIRE(tree_store.GetPosition(slot) == grid_store.GetPosition(slot));
+      REQUIRE(tree_store.GetVelocity(slot) == grid_store.GetVelocity(slot));
+    }
+  }
+}
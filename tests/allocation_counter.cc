@@ -0,0 +1,95 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> is_counting(false);
+std::atomic<size_t> num_allocations(0);
+
+/**
+ * Counts an allocation if a counter is alive and makes it
+ * @return the memory, or null if there isn't enough
+ */
+void* AllocateOrNull(size_t size) {
+  if (is_counting.load(std::memory_order_relaxed)) {
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // A zero sized allocation still has to return a unique pointer
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void* Allocate(size_t size) {
+  void* memory = AllocateOrNull(size);
+  if (memory == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return memory;
+}
+
+}  // namespace
+
+// Replacing every form of these for the whole test binary is what lets the
+// counter see allocations made inside the standard library and on other
+// threads, and keeps each form's memory going back through the same pair
+void* operator new(size_t size) {
+  return Allocate(size);
+}
+
+void* operator new[](size_t size) {
+  return Allocate(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return AllocateOrNull(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return AllocateOrNull(size);
+}
+
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
+
+// The sized forms are only called from C++14 on, but are harmless before
+void operator delete(void* memory, size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+  std::free(memory);
+}
+
+namespace idealgas {
+
+AllocationCounter::AllocationCounter() {
+  num_allocations = 0;
+  is_counting = true;
+}
+
+AllocationCounter::~AllocationCounter() {
+  is_counting = false;
+}
+
+size_t AllocationCounter::GetNumAllocations() const {
+  return num_allocations;
+}
+
+}  // namespace idealgas
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace idealgas {
+
+/**
+ * Counts heap allocations made on any thread while it is alive, through the
+ * replacement global operator new defined in allocation_counter.cc. Tests use
+ * it to prove that a warmed up frame doesn't touch the heap. Only one counter
+ * should be alive at a time.
+ */
+class AllocationCounter {
+ public:
+  /**
+   * Starts counting allocations
+   */
+  AllocationCounter();
+
+  /**
+   * Stops counting allocations
+   */
+  ~AllocationCounter();
+
+  AllocationCounter(const AllocationCounter&) = delete;
+
+  AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+  /**
+   * Gets the number of allocations made since this counter was created
+   * @return the number of calls to operator new
+   */
+  size_t GetNumAllocations() const;
+};
+
+}  // namespace idealgas
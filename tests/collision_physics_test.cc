@@ -2,6 +2,8 @@
 
 #include <catch2/catch.hpp>
 
+#include "cinder/gl/gl.h"
+
 TEST_CASE("Check particle collision detector") {
   glm::vec2 top_left_corner(0, 0);
   glm::vec2 bottom_right_corner(100, 100);
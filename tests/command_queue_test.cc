@@ -0,0 +1,131 @@
+#include "display/command_queue.h"
+
+#include <catch2/catch.hpp>
+#include <thread>
+
+#include "cinder/gl/gl.h"
+
+TEST_CASE("Command queue hands commands over in order") {
+  idealgas::CommandQueue queue(6);
+
+  SECTION("Capacity rounds up to a power of two") {
+    REQUIRE(queue.GetCapacity() == 8);
+  }
+
+  SECTION("Commands come out in the order they went in") {
+    for (size_t id = 0; id < 5; ++id) {
+      REQUIRE(queue.TryPush(idealgas::SimulationCommand::RemoveParticle(id)));
+    }
+
+    idealgas::SimulationCommand command;
+    for (size_t id = 0; id < 5; ++id) {
+      REQUIRE(queue.TryPop(&command));
+      REQUIRE(command.particle_id == id);
+    }
+    REQUIRE_FALSE(queue.TryPop(&command));
+  }
+
+  SECTION("A full queue drops new commands until one is taken") {
+    for (size_t id = 0; id < 8; ++id) {
+      REQUIRE(queue.TryPush(idealgas::SimulationCommand::RemoveParticle(id)));
+    }
+    REQUIRE_FALSE(
+        queue.TryPush(idealgas::SimulationCommand::RemoveParticle(8)));
+
+    idealgas::SimulationCommand command;
+    REQUIRE(queue.TryPop(&command));
+    REQUIRE(queue.TryPush(idealgas::SimulationCommand::RemoveParticle(8)));
+  }
+
+  SECTION("Commands arrive intact across threads") {
+    const size_t num_commands = 100000;
+    std::thread producer([&queue, num_commands]() {
+      for (size_t id = 0; id < num_commands; ++id) {
+        while (!queue.TryPush(
+            idealgas::SimulationCommand::RemoveParticle(id))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+    size_t num_in_order = 0;
+    idealgas::SimulationCommand command;
+    for (size_t id = 0; id < num_commands; ++id) {
+      while (!queue.TryPop(&command)) {
+        std::this_thread::yield();
+      }
+      if (command.particle_id == id) {
+        ++num_in_order;
+      }
+    }
+    producer.join();
+
+    REQUIRE(num_in_order == num_commands);
+  }
+}
+
+TEST_CASE("Draining the queue applies every kind of command") {
+  const ci::Color color("orange");
+  idealgas::GasContainer container(std::vector<idealgas::Particle*>(), 0,
+                                   glm::vec2(0, 0), glm::vec2(100, 100), 3, 1,
+                                   color);
+  idealgas::CommandQueue queue(16);
+  idealgas::Particle particle(glm::vec2(50, 50), glm::vec2(1, -1), color, 3,
+                              1);
+
+  SECTION("Particles are added and sped up in order") {
+    queue.TryPush(idealgas::SimulationCommand::AddParticle(particle));
+    queue.TryPush(
+        idealgas::SimulationCommand::ModifySpeed(glm::vec2(1, 1), true));
+    queue.TryPush(idealgas::SimulationCommand::AddParticle(particle));
+
+    REQUIRE(queue.DrainInto(&container) == 3);
+    REQUIRE(container.GetParticles().size() == 2);
+    REQUIRE(container.GetParticles().at(0)->GetVelocity() ==
+            glm::vec2(2, -2));
+    REQUIRE(container.GetParticles().at(1)->GetVelocity() ==
+            glm::vec2(1, -1));
+  }
+
+  SECTION("Removing a particle that no longer exists is ignored") {
+    queue.TryPush(idealgas::SimulationCommand::AddParticle(particle));
+    queue.TryPush(idealgas::SimulationCommand::RemoveParticle(0));
+    queue.TryPush(idealgas::SimulationCommand::RemoveParticle(0));
+    queue.TryPush(idealgas::SimulationCommand::RemoveParticle(5));
+    queue.DrainInto(&container);
+
+    REQUIRE(container.GetParticles().empty());
+  }
+
+  SECTION("Removals follow particles that another removal moved") {
+    idealgas::Particle slow_particle(glm::vec2(20, 20), glm::vec2(0, 1), color,
+                                     3, 1);
+    idealgas::Particle fast_particle(glm::vec2(80, 80), glm::vec2(2, 0), color,
+                                     3, 1);
+    queue.TryPush(idealgas::SimulationCommand::AddParticle(particle));
+    queue.TryPush(idealgas::SimulationCommand::AddParticle(slow_particle));
+    queue.TryPush(idealgas::SimulationCommand::AddParticle(fast_particle));
+    // The fast particle fills slot 0 once the first particle is gone
+    queue.TryPush(idealgas::SimulationCommand::RemoveParticle(0));
+    queue.TryPush(idealgas::SimulationCommand::RemoveParticle(2));
+    queue.DrainInto(&container);
+
+    REQUIRE(container.GetParticles().size() == 1);
+    REQUIRE(container.GetParticles().at(0)->GetVelocity() ==
+            glm::vec2(0, 1));
+  }
+
+  SECTION("Clearing and parameter changes reach the container") {
+    queue.TryPush(idealgas::SimulationCommand::AddParticle(particle));
+    queue.TryPush(idealgas::SimulationCommand::ClearParticles());
+    queue.TryPush(idealgas::SimulationCommand::SetNumThreads(3));
+    queue.TryPush(idealgas::SimulationCommand::SetSteppingMode(
+        idealgas::SteppingMode::kEventDriven));
+    queue.DrainInto(&container);
+
+    REQUIRE(container.GetParticles().empty());
+    REQUIRE(container.GetNumThreads() == 3);
+    REQUIRE(container.GetSteppingMode() ==
+            idealgas::SteppingMode::kEventDriven);
+  }
+}
@@ -0,0 +1,114 @@
+#include "physics/event_driven_engine.h"
+
+#include <catch2/catch.hpp>
+
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+TEST_CASE("Event-driven engine collides at the exact collision time") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  float radius = 5.0f;
+  float mass = 1.0f;
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  idealgas::CollisionPhysics physics(top_left_corner, bottom_right_corner);
+  idealgas::EventDrivenEngine engine(top_left_corner, bottom_right_corner);
+
+  SECTION("Particle bounces off a wall part way through a frame") {
+    store.Add(glm::vec2(50, 50), glm::vec2(10, 0), color, radius, mass);
+
+    for (size_t frame = 0; frame < 5; ++frame) {
+      engine.Advance(&store, physics, 1.0f);
+    }
+
+    REQUIRE(store.GetPosition(0).x == Approx(90));
+    REQUIRE(store.GetPosition(0).y == Approx(50));
+    REQUIRE(store.GetVelocity(0) == glm::vec2(-10, 0));
+    REQUIRE(engine.GetNumCollisions() == 1);
+  }
+
+  SECTION("Fast particles collide instead of passing through each other") {
+    store.Add(glm::vec2(20, 50), glm::vec2(30, 0), color, radius, mass);
+    store.Add(glm::vec2(80, 50), glm::vec2(-30, 0), color, radius, mass);
+
+    engine.Advance(&store, physics, 1.0f);
+
+    REQUIRE(store.GetVelocity(0).x == Approx(-30));
+    REQUIRE(store.GetVelocity(1).x == Approx(30));
+    REQUIRE(store.GetPosition(0).x == Approx(40));
+    REQUIRE(store.GetPosition(1).x == Approx(60));
+    REQUIRE(engine.GetNumCollisions() == 1);
+  }
+
+  SECTION("Particles moving apart never collide") {
+    store.Add(glm::vec2(40, 50), glm::vec2(-1, 0), color, radius, mass);
+    store.Add(glm::vec2(60, 50), glm::vec2(1, 0), color, radius, mass);
+
+    engine.Advance(&store, physics, 1.0f);
+
+    REQUIRE(store.GetPosition(0) == glm::vec2(39, 50));
+    REQUIRE(store.GetPosition(1) == glm::vec2(61, 50));
+    REQUIRE(engine.GetNumCollisions() == 0);
+  }
+
+  SECTION("Particles crossing cells still find each other") {
+    store.Add(glm::vec2(10, 10), glm::vec2(3, 3), color, radius, mass);
+    store.Add(glm::vec2(90, 90), glm::vec2(-3, -3), color, radius, mass);
+
+    for (size_t frame = 0; frame < 14; ++frame) {
+      engine.Advance(&store, physics, 1.0f);
+    }
+
+    REQUIRE(store.GetVelocity(0).x == Approx(-3));
+    REQUIRE(store.GetVelocity(1).x == Approx(3));
+    REQUIRE(engine.GetNumCollisions() == 1);
+  }
+}
+
+TEST_CASE("Event-driven container keeps the gas physical") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(200, 200);
+
+  srand(7);
+  idealgas::GasContainer container(std::vector<idealgas::Particle*>(), 150,
+                                   top_left_corner, bottom_right_corner, 3, 1,
+                                   ci::Color("orange"));
+
+  SECTION("Stepping mode defaults to fixed steps and can be changed") {
+    REQUIRE(container.GetSteppingMode() ==
+            idealgas::SteppingMode::kFixedStep);
+    container.SetSteppingMode(idealgas::SteppingMode::kEventDriven);
+    REQUIRE(container.GetSteppingMode() ==
+            idealgas::SteppingMode::kEventDriven);
+  }
+
+  SECTION("Kinetic energy is conserved and particles stay inside") {
+    container.SetSteppingMode(idealgas::SteppingMode::kEventDriven);
+    const idealgas::ParticleStore& store = container.GetParticleStore();
+
+    float initial_energy = 0;
+    for (size_t slot = 0; slot < store.Size(); ++slot) {
+      initial_energy += store.GetMass(slot) * store.GetSpeed(slot) *
+                        store.GetSpeed(slot) / 2;
+    }
+
+    for (size_t frame = 0; frame < 200; ++frame) {
+      container.AdvanceOneFrame();
+    }
+
+    float final_energy = 0;
+    for (size_t slot = 0; slot < store.Size(); ++slot) {
+      final_energy += store.GetMass(slot) * store.GetSpeed(slot) *
+                      store.GetSpeed(slot) / 2;
+
+      glm::vec2 position = store.GetPosition(slot);
+      REQUIRE(position.x >= top_left_corner.x);
+      REQUIRE(position.x <= bottom_right_corner.x);
+      REQUIRE(position.y >= top_left_corner.y);
+      REQUIRE(position.y <= bottom_right_corner.y);
+    }
+
+    REQUIRE(final_energy == Approx(initial_energy).epsilon(1e-3));
+  }
+}
@@ -0,0 +1,142 @@
+#include "components/frame_profiler.h"
+
+#include <catch2/catch.hpp>
+
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+TEST_CASE("Frame profiler keeps rolling phase percentiles") {
+  idealgas::FrameProfiler profiler;
+
+  SECTION("A new profiler reports zeros") {
+    REQUIRE(profiler.GetNumFrames() == 0);
+    REQUIRE(profiler.CalculatePhasePercentile(
+                idealgas::ProfilePhase::kWallCollisions, 50) == 0);
+    REQUIRE(profiler.GetLastFrame().counts[0] == 0);
+  }
+
+  SECTION("Phase times and counts add up within a frame") {
+    profiler.BeginFrame();
+    profiler.AddPhaseTime(idealgas::ProfilePhase::kPositionUpdate, 0.25);
+    profiler.AddPhaseTime(idealgas::ProfilePhase::kPositionUpdate, 0.5);
+    profiler.AddCount(idealgas::ProfileCounter::kWallBounces, 3);
+    profiler.AddCount(idealgas::ProfileCounter::kWallBounces, 4);
+    profiler.EndFrame();
+
+    const idealgas::FrameProfile& frame = profiler.GetLastFrame();
+    REQUIRE(frame.phase_seconds[size_t(
+                idealgas::ProfilePhase::kPositionUpdate)] == 0.75);
+    REQUIRE(frame.counts[size_t(idealgas::ProfileCounter::kWallBounces)] ==
+            7);
+  }
+
+  SECTION("Percentiles are taken over the recorded frames") {
+    for (size_t frame = 1; frame <= 100; ++frame) {
+      profiler.BeginFrame();
+      profiler.AddPhaseTime(idealgas::ProfilePhase::kHistograms,
+                            double(frame));
+      profiler.AddCount(idealgas::ProfileCounter::kCollisions, frame * 2);
+      profiler.EndFrame();
+    }
+
+    REQUIRE(profiler.CalculatePhasePercentile(
+                idealgas::ProfilePhase::kHistograms, 50) == 50);
+    REQUIRE(profiler.CalculatePhasePercentile(
+                idealgas::ProfilePhase::kHistograms, 99) == 99);
+    REQUIRE(profiler.CalculatePhasePercentile(
+                idealgas::ProfilePhase::kHistograms, 100) == 100);
+    REQUIRE(profiler.CalculateCounterPercentile(
+                idealgas::ProfileCounter::kCollisions, 95) == 190);
+  }
+
+  SECTION("Only the newest frames are kept") {
+    size_t num_frames = idealgas::FrameProfiler::kHistorySize + 10;
+    for (size_t frame = 0; frame < num_frames; ++frame) {
+      profiler.BeginFrame();
+      profiler.AddPhaseTime(idealgas::ProfilePhase::kHistograms,
+                            double(frame));
+      profiler.EndFrame();
+    }
+
+    REQUIRE(profiler.GetNumFrames() == idealgas::FrameProfiler::kHistorySize);
+    REQUIRE(profiler.CalculatePhasePercentile(
+                idealgas::ProfilePhase::kHistograms, 0) == 10);
+    REQUIRE(profiler.GetLastFrame().phase_seconds[size_t(
+                idealgas::ProfilePhase::kHistograms)] == num_frames - 1);
+  }
+
+  SECTION("Frames recorded elsewhere are merged into the current frame") {
+    idealgas::FrameProfile frame = {};
+    frame.counts[size_t(idealgas::ProfileCounter::kPairTests)] = 5;
+
+    profiler.BeginFrame();
+    profiler.AddFrame(frame);
+    profiler.AddFrame(frame);
+    profiler.EndFrame();
+
+    REQUIRE(profiler.GetLastFrame()
+                .counts[size_t(idealgas::ProfileCounter::kPairTests)] == 10);
+  }
+}
+
+#ifdef IDEALGAS_PROFILING
+TEST_CASE("Container profiles every frame it advances") {
+  idealgas::Particle particle1(glm::vec2(20, 50), glm::vec2(2, 0),
+                               ci::Color("orange"), 5, 1);
+  idealgas::Particle particle2(glm::vec2(29, 50), glm::vec2(-2, 0),
+                               ci::Color("orange"), 5, 1);
+  idealgas::Particle particle3(glm::vec2(96, 96), glm::vec2(1, 1),
+                               ci::Color("orange"), 5, 1);
+  idealgas::GasContainer container({&particle1, &particle2, &particle3}, 0,
+                                   glm::vec2(0, 0), glm::vec2(100, 100), 5, 1,
+                                   ci::Color("orange"));
+
+  SECTION("Fixed steps count pair tests, collisions and wall bounces") {
+    container.AdvanceOneFrame();
+
+    const idealgas::FrameProfile& frame =
+        container.GetProfiler().GetLastFrame();
+    REQUIRE(container.GetProfiler().GetNumFrames() == 1);
+    REQUIRE(frame.counts[size_t(idealgas::ProfileCounter::kPairTests)] >= 1);
+    REQUIRE(frame.counts[size_t(idealgas::ProfileCounter::kCollisions)] == 1);
+    REQUIRE(frame.counts[size_t(idealgas::ProfileCounter::kWallBounces)] ==
+            2);
+    REQUIRE(frame.phase_seconds[size_t(
+                idealgas::ProfilePhase::kParticleCollisions)] > 0);
+  }
+
+  SECTION("Parallel collisions report the same counts") {
+    container.SetNumThreads(2);
+    container.AdvanceOneFrame();
+
+    const idealgas::FrameProfile& frame =
+        container.GetProfiler().GetLastFrame();
+    REQUIRE(frame.counts[size_t(idealgas::ProfileCounter::kCollisions)] == 1);
+    REQUIRE(frame.counts[size_t(idealgas::ProfileCounter::kWallBounces)] ==
+            2);
+  }
+
+  SECTION("Event-driven steps split collisions from wall bounces") {
+    // Exact collisions need the particles to start apart
+    idealgas::Particle approaching1(glm::vec2(20, 50), glm::vec2(2, 0),
+                                    ci::Color("orange"), 5, 1);
+    idealgas::Particle approaching2(glm::vec2(32, 50), glm::vec2(-2, 0),
+                                    ci::Color("orange"), 5, 1);
+    idealgas::Particle cornered(glm::vec2(93, 93), glm::vec2(4, 4),
+                                ci::Color("orange"), 5, 1);
+    idealgas::GasContainer event_container(
+        {&approaching1, &approaching2, &cornered}, 0, glm::vec2(0, 0),
+        glm::vec2(100, 100), 5, 1, ci::Color("orange"));
+    event_container.SetSteppingMode(idealgas::SteppingMode::kEventDriven);
+    event_container.AdvanceOneFrame();
+
+    const idealgas::FrameProfile& frame =
+        event_container.GetProfiler().GetLastFrame();
+    REQUIRE(frame.counts[size_t(idealgas::ProfileCounter::kCollisions)] == 1);
+    REQUIRE(frame.counts[size_t(idealgas::ProfileCounter::kWallBounces)] ==
+            2);
+    REQUIRE(frame.phase_seconds[size_t(
+                idealgas::ProfilePhase::kEventDriven)] > 0);
+  }
+}
+#endif  // IDEALGAS_PROFILING
@@ -2,6 +2,8 @@
 
 #include <catch2/catch.hpp>
 
+#include "cinder/gl/gl.h"
+
 TEST_CASE("Test constructor initializes particle container") {
   const glm::vec2 top_left_corner(0, 0);
   const glm::vec2 bottom_right_corner(100, 100);
@@ -604,3 +606,157 @@ TEST_CASE("Particles change speed on global modification") {
             expected_bottom_velocity);
   }
 }
+
+TEST_CASE("Broad phase resolves the same collisions as every pair check") {
+  const glm::vec2 top_left_corner(0, 0);
+  const glm::vec2 bottom_right_corner(200, 200);
+  float radius = 6.0f;
+  float mass = 1.0f;
+  const ci::Color color("orange");
+  idealgas::CollisionPhysics physics(top_left_corner, bottom_right_corner);
+
+  srand(7);
+  std::vector<idealgas::Particle*> initial_particles({});
+  idealgas::GasContainer container(initial_particles, 150, top_left_corner,
+                                   bottom_right_corner, radius, mass, color);
+
+  // Replays the original all-pairs frame on copies of the same particles
+  std::vector<idealgas::Particle> expected_particles;
+  for (idealgas::Particle* particle : container.GetParticles()) {
+    expected_particles.push_back(idealgas::Particle(
+        particle->GetPosition(), particle->GetVelocity(), particle->GetColor(),
+        particle->GetRadius(), particle->GetMass()));
+  }
+
+  for (size_t frame = 0; frame < 50; ++frame) {
+    container.AdvanceOneFrame();
+
+    for (idealgas::Particle& particle : expected_particles) {
+      glm::vec2 velocity = particle.GetVelocity();
+      if (physics.IsParticleCollidingWithTopWall(particle) ||
+          physics.IsParticleCollidingWithBottomWall(particle)) {
+        velocity.y = -velocity.y;
+      }
+      if (physics.IsParticleCollidingWithLeftWall(particle) ||
+          physics.IsParticleCollidingWithRightWall(particle)) {
+        velocity.x = -velocity.x;
+      }
+      particle.SetVelocity(velocity);
+    }
+
+    for (size_t idx1 = 0; idx1 < expected_particles.size(); ++idx1) {
+      for (size_t idx2 = idx1 + 1; idx2 < expected_particles.size(); ++idx2) {
+        if (physics.DidParticlesCollide(expected_particles[idx1],
+                                        expected_particles[idx2])) {
+          physics.UpdateCollidedParticleVelocities(&expected_particles[idx1],
+                                                   &expected_particles[idx2]);
+        }
+      }
+    }
+
+    for (idealgas::Particle& particle : expected_particles) {
+      particle.UpdatePosition();
+    }
+  }
+
+  idealgas::ParticleRange particles = container.GetParticles();
+  REQUIRE(particles.size() == expected_particles.size());
+  for (size_t idx = 0; idx < particles.size(); ++idx) {
+    REQUIRE(particles[idx]->GetPosition() ==
+            expected_particles[idx].GetPosition());
+    REQUIRE(particles[idx]->GetVelocity() ==
+            expected_particles[idx].GetVelocity());
+  }
+}
+
+TEST_CASE("Copied containers own their own particles") {
+  const glm::vec2 top_left_corner(0, 0);
+  const glm::vec2 bottom_right_corner(100, 100);
+  float radius = 10.0f;
+  float mass = 1.0f;
+  const ci::Color color("orange");
+
+  idealgas::Particle particle(glm::vec2(50, 50), glm::vec2(1, 0), color,
+                              radius, mass);
+  std::vector<idealgas::Particle*> initial_particles({&particle});
+  idealgas::GasContainer container(initial_particles, 0, top_left_corner,
+                                   bottom_right_corner, radius, mass, color);
+
+  idealgas::GasContainer copy;
+  copy = container;
+  copy.AdvanceOneFrame();
+
+  REQUIRE(copy.GetParticles().at(0)->GetPosition() == glm::vec2(51, 50));
+  REQUIRE(container.GetParticles().at(0)->GetPosition() == glm::vec2(50, 50));
+}
+
+TEST_CASE("Container reuses particle memory as particles come and go") {
+  const glm::vec2 top_left_corner(0, 0);
+  const glm::vec2 bottom_right_corner(100, 100);
+  const ci::Color color("orange");
+  idealgas::GasContainer container(std::vector<idealgas::Particle*>(), 0,
+                                   top_left_corner, bottom_right_corner, 3, 1,
+                                   color);
+
+  SECTION("Particles added by value are copied into the container") {
+    container.AddParticleToContainer(idealgas::Particle(
+        glm::vec2(10, 10), glm::vec2(1, 0), ci::Color("blue"), 3, 5));
+
+    REQUIRE(container.GetParticles().size() == 1);
+    REQUIRE(container.GetParticles().at(0)->GetMass() == 5.0f);
+  }
+
+  SECTION("Removing a particle moves the last particle into its slot") {
+    for (size_t idx = 0; idx < 3; ++idx) {
+      container.AddParticleToContainer(idealgas::Particle(
+          glm::vec2(10 + 10 * idx, 10), glm::vec2(1, 0), color, 3, 1));
+    }
+
+    container.RemoveParticle(0);
+
+    REQUIRE(container.GetParticles().size() == 2);
+    REQUIRE(container.GetParticles().at(0)->GetPosition() ==
+            glm::vec2(30, 10));
+    REQUIRE(container.GetParticles().at(1)->GetPosition() ==
+            glm::vec2(20, 10));
+  }
+
+  SECTION("Memory stays flat while particles are added and removed") {
+    idealgas::Particle particle(glm::vec2(50, 50), glm::vec2(1, 1), color, 3,
+                                1);
+    for (size_t idx = 0; idx < 64; ++idx) {
+      container.AddParticleToContainer(particle);
+    }
+    size_t capacity = container.GetParticleStore().Capacity();
+
+    for (size_t round = 0; round < 100; ++round) {
+      for (size_t idx = 0; idx < 32; ++idx) {
+        container.RemoveParticle(idx);
+      }
+      for (size_t idx = 0; idx < 32; ++idx) {
+        container.AddParticleToContainer(particle);
+      }
+      container.AdvanceOneFrame();
+    }
+
+    REQUIRE(container.GetParticles().size() == 64);
+    REQUIRE(container.GetParticleStore().Capacity() == capacity);
+  }
+
+  SECTION("Clearing releases every particle but keeps their memory") {
+    idealgas::Particle particle(glm::vec2(50, 50), glm::vec2(1, 1), color, 3,
+                                1);
+    for (size_t idx = 0; idx < 64; ++idx) {
+      container.AddParticleToContainer(particle);
+    }
+    size_t capacity = container.GetParticleStore().Capacity();
+
+    container.ClearParticles();
+    REQUIRE(container.GetParticles().empty());
+
+    for (size_t idx = 0; idx < 64; ++idx) {
+      container.AddParticleToContainer(particle);
+    }
+    REQUIRE(container.GetParticleStore().Capacity() == capacity);
+  }
+}
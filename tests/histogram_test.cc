@@ -2,6 +2,9 @@
 
 #include <catch2/catch.hpp>
 
+#include "allocation_counter.h"
+#include "cinder/gl/gl.h"
+
 TEST_CASE("Histogram updates with particles properly") {
   std::vector<idealgas::Particle*> particles({});
   glm::vec2 top_left_corner(0, 0);
@@ -138,4 +141,74 @@ TEST_CASE("Histogram updates with particles properly") {
     REQUIRE(histogram_vector.size() == 6);
     REQUIRE(expected_histogram1 == histogram_vector);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Histogram bins particles of its color straight from a store") {
+  std::vector<idealgas::Particle*> particles({});
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  ci::Color color("white");
+  ci::Color other_color("blue");
+  size_t num = 4;
+  float bin_width = 1;
+  float radius = 10.0f;
+  float mass = 1.0f;
+  glm::vec2 position(10, 10);
+  idealgas::Histogram histogram(particles, top_left_corner, bottom_right_corner,
+                                bin_width, color, num);
+
+  SECTION("Store with no particles") {
+    idealgas::ParticleStore store;
+
+    std::vector<size_t> histogram_vector = histogram.UpdateParticleBins(store);
+
+    REQUIRE(histogram_vector == std::vector<size_t>({0}));
+  }
+
+  SECTION("Particles of other colors are ignored") {
+    idealgas::ParticleStore store;
+    store.Add(position, glm::vec2(.1, 0), color, radius, mass);
+    store.Add(position, glm::vec2(9, 0), other_color, radius, mass);
+    store.Add(position, glm::vec2(2, 0), color, radius, mass);
+
+    std::vector<size_t> histogram_vector = histogram.UpdateParticleBins(store);
+
+    REQUIRE(histogram_vector == std::vector<size_t>({1, 0, 1}));
+  }
+
+  SECTION("Store and particle list give the same bins") {
+    idealgas::ParticleStore store;
+    store.Add(position, glm::vec2(.1, 0), color, radius, mass);
+    store.Add(position, glm::vec2(5, 0), color, radius, mass);
+    store.Add(position, glm::vec2(3, 4), color, radius, mass);
+
+    std::vector<idealgas::Particle> particles_copy;
+    for (size_t slot = 0; slot < store.Size(); ++slot) {
+      particles_copy.push_back(idealgas::Particle(
+          store.GetPosition(slot), store.GetVelocity(slot),
+          store.GetColor(slot), store.GetRadius(slot), store.GetMass(slot)));
+    }
+    std::vector<idealgas::Particle*> updated_particles(
+        {&particles_copy[0], &particles_copy[1], &particles_copy[2]});
+
+    std::vector<size_t> expected_histogram =
+        histogram.UpdateParticleBins(updated_particles);
+
+    REQUIRE(histogram.UpdateParticleBins(store) == expected_histogram);
+  }
+
+  SECTION("Rebinning the same speeds doesn't allocate") {
+    idealgas::ParticleStore store;
+    store.Add(position, glm::vec2(.1, 0), color, radius, mass);
+    store.Add(position, glm::vec2(5, 0), color, radius, mass);
+    idealgas::SpeedBins speed_bins(bin_width);
+    speed_bins.Update(store, color);
+    histogram.UpdateParticleBins(store);
+    histogram.UpdateParticleBins(speed_bins);
+
+    idealgas::AllocationCounter counter;
+    histogram.UpdateParticleBins(store);
+    histogram.UpdateParticleBins(speed_bins);
+    REQUIRE(counter.GetNumAllocations() == 0);
+  }
+}
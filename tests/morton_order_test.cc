@@ -0,0 +1,165 @@
+#include "physics/morton_order.h"
+
+#include <catch2/catch.hpp>
+
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+TEST_CASE("Morton order sorts particles along a Z-order curve") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  glm::vec2 velocity(0, 0);
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  idealgas::MortonOrder morton_order;
+
+  SECTION("Codes interleave the column and row bits") {
+    REQUIRE(idealgas::MortonOrder::CalculateCode(0, 0) == 0);
+    REQUIRE(idealgas::MortonOrder::CalculateCode(1, 0) == 1);
+    REQUIRE(idealgas::MortonOrder::CalculateCode(0, 1) == 2);
+    REQUIRE(idealgas::MortonOrder::CalculateCode(3, 5) == 39);
+    REQUIRE(idealgas::MortonOrder::CalculateCode(65535, 65535) ==
+            0xFFFFFFFF);
+  }
+
+  SECTION("Each quarter of the container is visited in turn") {
+    store.Add(glm::vec2(80, 80), velocity, color, 1, 1);
+    store.Add(glm::vec2(20, 20), velocity, color, 1, 1);
+    store.Add(glm::vec2(20, 80), velocity, color, 1, 1);
+    store.Add(glm::vec2(80, 20), velocity, color, 1, 1);
+
+    REQUIRE(morton_order.Sort(store, top_left_corner, bottom_right_corner) ==
+            std::vector<size_t>({1, 3, 2, 0}));
+  }
+
+  SECTION("Particles past the walls and in the same cell keep an order") {
+    store.Add(glm::vec2(150, -10), velocity, color, 1, 1);
+    store.Add(glm::vec2(50, 50), velocity, color, 1, 1);
+    store.Add(glm::vec2(-5, 50), velocity, color, 1, 1);
+    store.Add(glm::vec2(50, 50), velocity, color, 1, 1);
+
+    REQUIRE(morton_order.Sort(store, top_left_corner, bottom_right_corner) ==
+            std::vector<size_t>({0, 2, 1, 3}));
+  }
+
+  SECTION("Sorting brings neighbouring particles closer together") {
+    srand(3);
+    for (size_t idx = 0; idx < 500; ++idx) {
+      store.Add(glm::vec2(rand() % 100, rand() % 100), velocity, color, 1, 1);
+    }
+    float spread = idealgas::MortonOrder::CalculateSpread(store);
+
+    idealgas::ParticleStore sorted_store;
+    sorted_store.GatherFrom(store, morton_order.Sort(store, top_left_corner,
+                                                     bottom_right_corner));
+
+    REQUIRE(sorted_store.Size() == store.Size());
+    REQUIRE(idealgas::MortonOrder::CalculateSpread(sorted_store) <
+            spread / 4);
+  }
+
+  SECTION("Fewer than two particles have no spread") {
+    REQUIRE(idealgas::MortonOrder::CalculateSpread(store) == 0);
+    store.Add(glm::vec2(50, 50), velocity, color, 1, 1);
+    REQUIRE(idealgas::MortonOrder::CalculateSpread(store) == 0);
+  }
+}
+
+TEST_CASE("Reordering a container keeps each particle's id") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(200, 200);
+
+  srand(5);
+  idealgas::GasContainer container(std::vector<idealgas::Particle*>(), 300,
+                                   top_left_corner, bottom_right_corner, 3, 1,
+                                   ci::Color("orange"));
+  idealgas::Particle particle(glm::vec2(100, 100), glm::vec2(1, 0),
+                              ci::Color("blue"), 4, 2);
+  container.AddParticleToContainer(particle);
+
+  SECTION("Ids still find the same particles after sorting") {
+    idealgas::ParticleStore unsorted_store = container.GetParticleStore();
+    container.ReorderParticles();
+    const idealgas::ParticleStore& store = container.GetParticleStore();
+
+    REQUIRE(store.Size() == unsorted_store.Size());
+    for (size_t id = 0; id < store.Size(); ++id) {
+      size_t slot = container.GetParticleSlot(id);
+      REQUIRE(container.GetParticleId(slot) == id);
+      REQUIRE(store.GetPosition(slot) == unsorted_store.GetPosition(id));
+      REQUIRE(store.GetVelocity(slot) == unsorted_store.GetVelocity(id));
+    }
+  }
+
+  SECTION("Color and species views are rebuilt for the new slots") {
+    container.ReorderParticles();
+    size_t slot = container.GetParticleSlot(300);
+
+    REQUIRE(container.GetParticlesByColor(ci::Color("blue")).size() == 1);
+    REQUIRE(container.GetParticlesByColor(ci::Color("blue")).at(0) ==
+            container.GetParticles().at(slot));
+    REQUIRE(container.GetParticlesBySpecies(1).at(0)->GetMass() == 2.0f);
+    REQUIRE(container.GetParticlesByColor(ci::Color("orange")).size() ==
+            300);
+  }
+
+  SECTION("Removing a particle frees its id and moves another's") {
+    container.ReorderParticles();
+    size_t slot = container.GetParticleSlot(300);
+    container.RemoveParticle(slot);
+
+    REQUIRE(container.GetParticleSlot(300) ==
+            idealgas::ParticleIds::kNoSlot);
+    REQUIRE(container.GetParticleSlot(container.GetParticleId(slot)) == slot);
+  }
+
+  SECTION("The interval sorts the particles every few frames") {
+    container.SetReorderInterval(10);
+    idealgas::GasContainer copied_container(container);
+
+    size_t num_reorders = 0;
+    for (size_t frame = 0; frame < 25; ++frame) {
+      container.AdvanceOneFrame();
+      num_reorders += container.GetProfiler().GetLastFrame().counts[size_t(
+          idealgas::ProfileCounter::kReorders)];
+    }
+
+    REQUIRE(copied_container.GetReorderInterval() == 10);
+    REQUIRE(container.GetParticleSlot(300) != idealgas::ParticleIds::kNoSlot);
+    REQUIRE(container.GetParticles()
+                .at(container.GetParticleSlot(300))
+                ->GetColor() == ci::Color("blue"));
+#ifdef IDEALGAS_PROFILING
+    REQUIRE(num_reorders >= 2);
+#endif
+  }
+
+  SECTION("Particles already out of order wait for the interval") {
+    float spread =
+        idealgas::MortonOrder::CalculateSpread(container.GetParticleStore());
+    container.SetReorderInterval(1000);
+    for (size_t frame = 0; frame < 64; ++frame) {
+      container.AdvanceOneFrame();
+    }
+
+    REQUIRE(idealgas::MortonOrder::CalculateSpread(
+                container.GetParticleStore()) > spread / 2);
+  }
+
+  SECTION("Particles that drift far out of order are sorted early") {
+    container.ReorderParticles();
+    container.SetReorderInterval(1000);
+
+    size_t num_reorders = 0;
+    for (size_t frame = 0; frame < 200; ++frame) {
+      container.AdvanceOneFrame();
+      num_reorders += container.GetProfiler().GetLastFrame().counts[size_t(
+          idealgas::ProfileCounter::kReorders)];
+    }
+
+    REQUIRE(container.GetReorderInterval() == 1000);
+#ifdef IDEALGAS_PROFILING
+    REQUIRE(num_reorders >= 1);
+#endif
+  }
+}
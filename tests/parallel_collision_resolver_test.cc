@@ -0,0 +1,154 @@
+#include "physics/parallel_collision_resolver.h"
+
+#include <catch2/catch.hpp>
+
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+TEST_CASE("Parallel resolver finds touching pairs in serial order") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  float radius = 5.0f;
+  float mass = 1.0f;
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  idealgas::CollisionPhysics physics(top_left_corner, bottom_right_corner);
+
+  store.Add(glm::vec2(20, 20), glm::vec2(1, 0), color, radius, mass);
+  store.Add(glm::vec2(80, 80), glm::vec2(0, 0), color, radius, mass);
+  store.Add(glm::vec2(28, 20), glm::vec2(-1, 0), color, radius, mass);
+  store.Add(glm::vec2(75, 80), glm::vec2(1, 0), color, radius, mass);
+
+  idealgas::UniformGrid grid;
+  grid.Rebuild(store, top_left_corner, bottom_right_corner);
+  idealgas::WorkStealingPool pool(3);
+  idealgas::ParallelCollisionResolver resolver(&pool);
+  resolver.ResolveCollisions(&store, grid, physics);
+
+  std::vector<std::pair<size_t, size_t>> expected_pairs(
+      {std::make_pair(size_t(0), size_t(2)),
+       std::make_pair(size_t(1), size_t(3))});
+  REQUIRE(resolver.GetTouchingPairs() == expected_pairs);
+  REQUIRE(store.GetVelocity(0) == glm::vec2(-1, 0));
+  REQUIRE(store.GetVelocity(2) == glm::vec2(1, 0));
+  REQUIRE(store.GetVelocity(1) == glm::vec2(1, 0));
+  REQUIRE(store.GetVelocity(3) == glm::vec2(0, 0));
+}
+
+TEST_CASE("Parallel resolver splits pairs into conflict-free colors") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  float radius = 5.0f;
+  float mass = 1.0f;
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  idealgas::CollisionPhysics physics(top_left_corner, bottom_right_corner);
+  idealgas::UniformGrid grid;
+  idealgas::ParallelCollisionResolver resolver;
+
+  SECTION("A particle in two collisions meets them in serial order") {
+    store.Add(glm::vec2(20, 20), glm::vec2(1, 0), color, radius, mass);
+    store.Add(glm::vec2(28, 20), glm::vec2(0, 0), color, radius, mass);
+    store.Add(glm::vec2(36, 20), glm::vec2(-1, 0), color, radius, mass);
+    store.Add(glm::vec2(80, 80), glm::vec2(1, 0), color, radius, mass);
+    store.Add(glm::vec2(88, 80), glm::vec2(-1, 0), color, radius, mass);
+    idealgas::ParticleStore serial_store = store;
+
+    grid.Rebuild(store, top_left_corner, bottom_right_corner);
+    size_t num_collisions = resolver.ResolveCollisions(&store, grid, physics);
+    physics.UpdateCollidedParticleVelocities(&serial_store, 0, 1);
+    physics.UpdateCollidedParticleVelocities(&serial_store, 1, 2);
+    physics.UpdateCollidedParticleVelocities(&serial_store, 3, 4);
+
+    REQUIRE(num_collisions == 3);
+    REQUIRE(resolver.GetNumColors() == 2);
+    for (size_t slot = 0; slot < store.Size(); ++slot) {
+      REQUIRE(store.GetVelocity(slot) == serial_store.GetVelocity(slot));
+    }
+  }
+
+  SECTION("No touching pairs need no colors") {
+    store.Add(glm::vec2(20, 20), glm::vec2(1, 0), color, radius, mass);
+    store.Add(glm::vec2(80, 80), glm::vec2(0, 0), color, radius, mass);
+
+    grid.Rebuild(store, top_left_corner, bottom_right_corner);
+    resolver.ResolveCollisions(&store, grid, physics);
+
+    REQUIRE(resolver.GetNumColors() == 0);
+  }
+}
+
+TEST_CASE("Crowded collisions are bit-identical on any number of threads") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(150, 150);
+  idealgas::CollisionPhysics physics(top_left_corner, bottom_right_corner);
+
+  // Packed tightly enough for several colors with hundreds of pairs each
+  srand(11);
+  idealgas::ParticleStore serial_store;
+  for (size_t idx = 0; idx < 4000; ++idx) {
+    serial_store.Add(
+        glm::vec2(rand() % 150, rand() % 150),
+        glm::vec2(rand() % 7 - 3.0f, rand() % 7 - 3.0f), ci::Color("orange"),
+        idx % 3 == 0 ? 3.0f : 1.5f, idx % 3 == 0 ? 4.0f : 1.0f);
+  }
+  idealgas::ParticleStore store = serial_store;
+
+  idealgas::UniformGrid grid;
+  grid.Rebuild(serial_store, top_left_corner, bottom_right_corner);
+  idealgas::ParallelCollisionResolver serial_resolver;
+  size_t serial_collisions =
+      serial_resolver.ResolveCollisions(&serial_store, grid, physics);
+
+  size_t num_threads = GENERATE(1, 8, 64);
+  idealgas::WorkStealingPool pool(num_threads);
+  idealgas::ParallelCollisionResolver resolver(&pool);
+
+  REQUIRE(resolver.ResolveCollisions(&store, grid, physics) ==
+          serial_collisions);
+  REQUIRE(resolver.GetNumColors() > 1);
+  for (size_t slot = 0; slot < store.Size(); ++slot) {
+    REQUIRE(store.GetVelocity(slot) == serial_store.GetVelocity(slot));
+  }
+}
+
+TEST_CASE("Parallel collisions match the serial collisions exactly") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(200, 200);
+
+  srand(42);
+  idealgas::GasContainer serial_container(std::vector<idealgas::Particle*>(),
+                                          600, top_left_corner,
+                                          bottom_right_corner, 4, 1,
+                                          ci::Color("orange"));
+  idealgas::GasContainer parallel_container(serial_container);
+
+  SECTION("Thread count defaults to one and is copied") {
+    REQUIRE(serial_container.GetNumThreads() == 1);
+    parallel_container.SetNumThreads(4);
+    idealgas::GasContainer copied_container(parallel_container);
+    REQUIRE(copied_container.GetNumThreads() == 4);
+  }
+
+  SECTION("Every thread count gives the serial velocities and positions") {
+    size_t num_threads = GENERATE(2, 3, 8, 64);
+    parallel_container.SetNumThreads(num_threads);
+
+    for (size_t frame = 0; frame < 50; ++frame) {
+      serial_container.AdvanceOneFrame();
+      parallel_container.AdvanceOneFrame();
+    }
+
+    const idealgas::ParticleStore& serial_store =
+        serial_container.GetParticleStore();
+    const idealgas::ParticleStore& parallel_store =
+        parallel_container.GetParticleStore();
+    REQUIRE(parallel_store.Size() == serial_store.Size());
+    for (size_t slot = 0; slot < serial_store.Size(); ++slot) {
+      REQUIRE(parallel_store.GetPosition(slot) ==
+              serial_store.GetPosition(slot));
+      REQUIRE(parallel_store.GetVelocity(slot) ==
+              serial_store.GetVelocity(slot));
+    }
+  }
+}
@@ -0,0 +1,54 @@
+#include "components/particle_ids.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Particle ids follow their particles between slots") {
+  idealgas::ParticleIds ids;
+  ids.Add();
+  ids.Add();
+  ids.Add();
+  ids.Add();
+
+  SECTION("New particles get consecutive ids in their own slots") {
+    REQUIRE(ids.Size() == 4);
+    REQUIRE(ids.GetId(2) == 2);
+    REQUIRE(ids.GetSlot(3) == 3);
+  }
+
+  SECTION("Removing a slot moves the last particle's id into it") {
+    ids.Remove(1);
+
+    REQUIRE(ids.Size() == 3);
+    REQUIRE(ids.GetId(1) == 3);
+    REQUIRE(ids.GetSlot(3) == 1);
+    REQUIRE(ids.GetSlot(1) == idealgas::ParticleIds::kNoSlot);
+  }
+
+  SECTION("Removed ids are handed to the next particle added") {
+    ids.Remove(0);
+    ids.Remove(2);
+
+    REQUIRE(ids.Add() == 2);
+    REQUIRE(ids.GetSlot(2) == 2);
+    REQUIRE(ids.Add() == 0);
+    REQUIRE(ids.Add() == 4);
+  }
+
+  SECTION("Reordering moves each id to its particle's new slot") {
+    ids.Reorder(std::vector<size_t>({2, 0, 3, 1}));
+
+    REQUIRE(ids.GetId(0) == 2);
+    REQUIRE(ids.GetSlot(0) == 1);
+    REQUIRE(ids.GetSlot(1) == 3);
+    REQUIRE(ids.GetSlot(2) == 0);
+    REQUIRE(ids.GetSlot(3) == 2);
+  }
+
+  SECTION("Clearing frees every id") {
+    ids.Clear();
+
+    REQUIRE(ids.Size() == 0);
+    REQUIRE(ids.GetSlot(0) == idealgas::ParticleIds::kNoSlot);
+    REQUIRE(ids.Add() == 0);
+  }
+}
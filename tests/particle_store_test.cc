@@ -0,0 +1,168 @@
+#include "components/particle_store.h"
+
+#include <catch2/catch.hpp>
+
+#include "cinder/gl/gl.h"
+#include "components/particle_range.h"
+#include "components/particle_view.h"
+
+TEST_CASE("Particle store keeps particles in contiguous arrays") {
+  const ci::Color color("orange");
+  idealgas::ParticleStore store;
+
+  SECTION("Store starts empty") {
+    REQUIRE(store.IsEmpty());
+    REQUIRE(store.Size() == 0);
+  }
+
+  SECTION("Adding particles fills consecutive slots") {
+    size_t slot1 = store.Add(glm::vec2(10, 20), glm::vec2(1, 2), color, 3, 4);
+    size_t slot2 = store.Add(glm::vec2(30, 40), glm::vec2(5, 6), color, 7, 8);
+
+    REQUIRE(slot1 == 0);
+    REQUIRE(slot2 == 1);
+    REQUIRE(store.Size() == 2);
+    REQUIRE(store.GetXPositions()[1] == 30.0f);
+    REQUIRE(store.GetYPositions()[1] == 40.0f);
+    REQUIRE(store.GetXVelocities()[0] == 1.0f);
+    REQUIRE(store.GetYVelocities()[0] == 2.0f);
+    REQUIRE(store.GetRadii()[1] == 7.0f);
+    REQUIRE(store.GetMass(0) == 4.0f);
+    REQUIRE(store.GetColor(0) == color);
+  }
+
+  SECTION("Writes through the arrays are visible through the getters") {
+    store.Add(glm::vec2(10, 20), glm::vec2(1, 2), color, 3, 4);
+    store.GetXVelocities()[0] = 3;
+    store.SetPosition(0, glm::vec2(5, 5));
+
+    REQUIRE(store.GetVelocity(0) == glm::vec2(3, 2));
+    REQUIRE(store.GetPosition(0) == glm::vec2(5, 5));
+    REQUIRE(store.GetSpeed(0) == Approx(std::sqrt(13.0f)));
+  }
+
+  SECTION("Removing a particle fills its slot with the last particle") {
+    store.Add(glm::vec2(10, 20), glm::vec2(1, 2), color, 3, 4);
+    store.Add(glm::vec2(30, 40), glm::vec2(5, 6), color, 7, 8);
+    store.Remove(0);
+
+    REQUIRE(store.Size() == 1);
+    REQUIRE(store.GetPosition(0) == glm::vec2(30, 40));
+    REQUIRE(store.GetVelocity(0) == glm::vec2(5, 6));
+    REQUIRE(store.GetRadius(0) == 7.0f);
+    REQUIRE(store.GetMass(0) == 8.0f);
+  }
+
+  SECTION("Clearing removes every particle") {
+    store.Add(glm::vec2(10, 20), glm::vec2(1, 2), color, 3, 4);
+    store.Clear();
+
+    REQUIRE(store.IsEmpty());
+  }
+
+  SECTION("Gathering copies another store's particles in a new order") {
+    store.Add(glm::vec2(10, 20), glm::vec2(1, 2), color, 3, 4);
+    store.Add(glm::vec2(30, 40), glm::vec2(5, 6), ci::Color("blue"), 7, 8);
+    store.Add(glm::vec2(50, 60), glm::vec2(9, 10), color, 3, 4);
+    idealgas::ParticleStore gathered_store;
+    gathered_store.Add(glm::vec2(0, 0), glm::vec2(0, 0), color, 1, 1);
+
+    gathered_store.GatherFrom(store, std::vector<size_t>({1, 2, 0}));
+
+    REQUIRE(gathered_store.Size() == 3);
+    REQUIRE(gathered_store.GetPosition(0) == glm::vec2(30, 40));
+    REQUIRE(gathered_store.GetVelocity(1) == glm::vec2(9, 10));
+    REQUIRE(gathered_store.GetRadius(0) == 7.0f);
+    REQUIRE(gathered_store.GetColor(0) == ci::Color("blue"));
+    REQUIRE(gathered_store.GetSpecies(2) == store.GetSpecies(0));
+    REQUIRE(gathered_store.Capacity() >= store.Capacity());
+  }
+}
+
+TEST_CASE("Particle views read and write through to the store") {
+  const ci::Color color("orange");
+  idealgas::ParticleStore store;
+  store.Add(glm::vec2(10, 20), glm::vec2(1, 2), color, 3, 4);
+  store.Add(glm::vec2(30, 40), glm::vec2(-1, -2), color, 5, 6);
+
+  idealgas::ParticleView view(&store, 1);
+
+  SECTION("View reports the slot's attributes") {
+    REQUIRE(view.GetPosition() == glm::vec2(30, 40));
+    REQUIRE(view.GetVelocity() == glm::vec2(-1, -2));
+    REQUIRE(view.GetRadius() == 5.0f);
+    REQUIRE(view.GetMass() == 6.0f);
+    REQUIRE(view.GetColor() == color);
+    REQUIRE(view.GetSlot() == 1);
+  }
+
+  SECTION("View updates move the particle in the store") {
+    view.UpdatePosition();
+    view.SetVelocity(glm::vec2(4, 4));
+    view.UpdateVelocity(glm::vec2(1, 1), true);
+
+    REQUIRE(store.GetPosition(1) == glm::vec2(29, 38));
+    REQUIRE(store.GetVelocity(1) == glm::vec2(5, 5));
+    REQUIRE(store.GetPosition(0) == glm::vec2(10, 20));
+  }
+
+  SECTION("Copying a view refers to the same slot") {
+    idealgas::ParticleView copy = view;
+    copy.SetVelocity(glm::vec2(0, 0));
+
+    REQUIRE(view.GetVelocity() == glm::vec2(0, 0));
+  }
+
+  SECTION("A view holds nothing but the store and the slot") {
+    REQUIRE(sizeof(idealgas::ParticleView) ==
+            sizeof(idealgas::ParticleStore*) + sizeof(size_t));
+  }
+}
+
+TEST_CASE("Ranges still hand out Particle pointers to older callers") {
+  const ci::Color color("orange");
+  idealgas::ParticleStore store;
+  store.Add(glm::vec2(10, 20), glm::vec2(1, 2), color, 3, 4);
+  store.Add(glm::vec2(30, 40), glm::vec2(-1, -2), color, 5, 6);
+  std::vector<idealgas::ParticleView> views(
+      {idealgas::ParticleView(&store, 0), idealgas::ParticleView(&store, 1)});
+  idealgas::ParticleRange range(views.data(), views.size());
+
+  SECTION("Particle pointers read the store's particles") {
+    std::vector<float> masses;
+    for (idealgas::Particle* particle : range) {
+      masses.push_back(particle->GetMass());
+    }
+
+    REQUIRE(masses == std::vector<float>({4, 6}));
+  }
+
+  SECTION("Changes through Particle pointers reach the store") {
+    for (idealgas::Particle* particle : range) {
+      particle->UpdatePosition();
+      particle->SetVelocity(glm::vec2(0, 0));
+    }
+
+    REQUIRE(store.GetPosition(0) == glm::vec2(11, 22));
+    REQUIRE(store.GetPosition(1) == glm::vec2(29, 38));
+    REQUIRE(store.GetVelocity(1) == glm::vec2(0, 0));
+  }
+
+  SECTION("Leaving a loop early still writes the last change back") {
+    for (idealgas::Particle* particle : range) {
+      particle->SetVelocity(glm::vec2(7, 7));
+      break;
+    }
+
+    REQUIRE(store.GetVelocity(0) == glm::vec2(7, 7));
+    REQUIRE(store.GetVelocity(1) == glm::vec2(-1, -2));
+  }
+
+  SECTION("View pointers still go straight to the store") {
+    for (idealgas::ParticleView* particle : range) {
+      particle->SetVelocity(glm::vec2(0, 0));
+    }
+
+    REQUIRE(store.GetVelocity(0) == glm::vec2(0, 0));
+  }
+}
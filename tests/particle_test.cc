@@ -2,6 +2,8 @@
 
 #include <catch2/catch.hpp>
 
+#include "cinder/gl/gl.h"
+
 TEST_CASE("Particle moves properly according to the velocity") {
   const glm::vec2 position(10, 10);
   const ci::Color color("red");
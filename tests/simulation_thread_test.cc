@@ -0,0 +1,93 @@
+#include "display/simulation_thread.h"
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <thread>
+
+#include "cinder/gl/gl.h"
+
+namespace {
+
+void WaitForSteps(const idealgas::SimulationThread& simulation,
+                  size_t num_steps) {
+  while (simulation.GetNumStepsTaken() < num_steps) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Simulation thread steps the container on its own") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(200, 200);
+
+  srand(7);
+  idealgas::GasContainer container(std::vector<idealgas::Particle*>(), 100,
+                                   top_left_corner, bottom_right_corner, 3, 1,
+                                   ci::Color("orange"));
+  idealgas::SimulationThread simulation(container, 0);
+
+  SECTION("Snapshot starts as the initial particles") {
+    const idealgas::ParticleStore& snapshot = simulation.AcquireSnapshot();
+
+    REQUIRE(simulation.GetSnapshotStep() == 0);
+    REQUIRE(snapshot.Size() == 100);
+    REQUIRE(snapshot.GetPosition(42) ==
+            container.GetParticleStore().GetPosition(42));
+  }
+
+  SECTION("Snapshots match stepping the container directly") {
+    simulation.Start();
+    WaitForSteps(simulation, 20);
+    simulation.Stop();
+
+    const idealgas::ParticleStore& snapshot = simulation.AcquireSnapshot();
+    REQUIRE(simulation.GetSnapshotStep() == simulation.GetNumStepsTaken());
+
+    for (size_t step = 0; step < simulation.GetSnapshotStep(); ++step) {
+      container.AdvanceOneFrame();
+    }
+    for (size_t slot = 0; slot < snapshot.Size(); ++slot) {
+      REQUIRE(snapshot.GetPosition(slot) ==
+              container.GetParticleStore().GetPosition(slot));
+      REQUIRE(snapshot.GetVelocity(slot) ==
+              container.GetParticleStore().GetVelocity(slot));
+    }
+  }
+
+  SECTION("A held snapshot doesn't change while the simulation runs") {
+    simulation.Start();
+    WaitForSteps(simulation, 5);
+    const idealgas::ParticleStore& snapshot = simulation.AcquireSnapshot();
+    size_t snapshot_step = simulation.GetSnapshotStep();
+    glm::vec2 position = snapshot.GetPosition(0);
+
+    WaitForSteps(simulation, snapshot_step + 10);
+
+    REQUIRE(simulation.GetSnapshot().GetPosition(0) == position);
+    REQUIRE(simulation.GetSnapshotStep() == snapshot_step);
+    REQUIRE(simulation.AcquireSnapshot().Size() == 100);
+    REQUIRE(simulation.GetSnapshotStep() > snapshot_step);
+  }
+
+  SECTION("Queued changes are applied between steps") {
+    simulation.Start();
+    simulation.Post(idealgas::SimulationCommand::AddParticle(idealgas::Particle(
+        glm::vec2(100, 100), glm::vec2(0, 0), ci::Color("blue"), 3, 5)));
+    size_t queued_step = simulation.GetNumStepsTaken();
+    WaitForSteps(simulation, queued_step + 3);
+    simulation.Stop();
+
+    REQUIRE(simulation.AcquireSnapshot().Size() == 101);
+  }
+
+  SECTION("Target rate limits how fast the simulation steps") {
+    simulation.SetTargetRate(20);
+    simulation.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    simulation.Stop();
+
+    REQUIRE(simulation.GetNumStepsTaken() >= 1);
+    REQUIRE(simulation.GetNumStepsTaken() <= 6);
+  }
+}
@@ -0,0 +1,52 @@
+#include "components/slot_index.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Slot index keeps the slots of each bucket") {
+  idealgas::SlotIndex index;
+  index.Add(0);
+  index.Add(1);
+  index.Add(0);
+  index.Add(0);
+
+  SECTION("Slots are listed in the bucket they were added to") {
+    REQUIRE(index.Size() == 4);
+    REQUIRE(index.GetSlots(0) == std::vector<size_t>({0, 2, 3}));
+    REQUIRE(index.GetSlots(1) == std::vector<size_t>({1}));
+  }
+
+  SECTION("Buckets nothing was added to are empty") {
+    REQUIRE(index.GetSlots(5).empty());
+  }
+
+  SECTION("Removing a slot renumbers the last slot into it") {
+    index.Remove(1);
+
+    REQUIRE(index.Size() == 3);
+    REQUIRE(index.GetSlots(0) == std::vector<size_t>({0, 2, 1}));
+    REQUIRE(index.GetSlots(1).empty());
+  }
+
+  SECTION("Removing the last slot leaves the others alone") {
+    index.Remove(3);
+
+    REQUIRE(index.GetSlots(0) == std::vector<size_t>({0, 2}));
+    REQUIRE(index.GetSlots(1) == std::vector<size_t>({1}));
+  }
+
+  SECTION("Removing from the front of a bucket moves its last entry there") {
+    index.Remove(0);
+
+    REQUIRE(index.GetSlots(0) == std::vector<size_t>({0, 2}));
+    REQUIRE(index.GetSlots(1) == std::vector<size_t>({1}));
+  }
+
+  SECTION("Clearing empties every bucket") {
+    index.Clear();
+
+    REQUIRE(index.Size() == 0);
+    REQUIRE(index.GetSlots(0).empty());
+    REQUIRE(index.Add(1) == 0);
+    REQUIRE(index.GetSlots(1) == std::vector<size_t>({0}));
+  }
+}
@@ -0,0 +1,72 @@
+#include "components/species_speed_bins.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Species speed bins count every species in one pass") {
+  glm::vec2 position(10, 10);
+  idealgas::Color red(1, 0, 0);
+  idealgas::Color blue(0, 0, 1);
+  idealgas::Color green(0, 1, 0);
+  float radius = 10.0f;
+  float mass = 1.0f;
+
+  idealgas::ParticleStore store;
+  store.Add(position, glm::vec2(3, 4), red, radius, mass);
+  store.Add(position, glm::vec2(1, 0), blue, radius, mass);
+  store.Add(position, glm::vec2(0, 2), red, radius, mass);
+  store.Add(position, glm::vec2(0, 9), green, radius, mass);
+
+  idealgas::SpeciesSpeedBins species_bins;
+  size_t red_species = species_bins.Register(red, 1);
+  size_t blue_species = species_bins.Register(blue, 2);
+
+  SECTION("Registering hands out indices in order") {
+    REQUIRE(red_species == 0);
+    REQUIRE(blue_species == 1);
+    REQUIRE(species_bins.GetNumSpecies() == 2);
+  }
+
+  SECTION("Each species is binned and unregistered colors are skipped") {
+    species_bins.Update(store);
+
+    REQUIRE(species_bins.GetSpeedBins(red_species).GetBins() ==
+            std::vector<size_t>({0, 0, 1, 0, 0, 1}));
+    REQUIRE(species_bins.GetSpeedBins(blue_species).GetBins() ==
+            std::vector<size_t>({1}));
+    REQUIRE(species_bins.GetMaxSpeed(red_species) == 5.0f);
+    REQUIRE(species_bins.GetMaxSpeed(blue_species) == 1.0f);
+  }
+
+  SECTION("Bins match binning each species on its own") {
+    species_bins.Update(store);
+
+    idealgas::SpeedBins red_bins(1);
+    idealgas::SpeedBins blue_bins(2);
+    REQUIRE(species_bins.GetSpeedBins(red_species).GetBins() ==
+            red_bins.Update(store, red));
+    REQUIRE(species_bins.GetSpeedBins(blue_species).GetBins() ==
+            blue_bins.Update(store, blue));
+  }
+
+  SECTION("Updating again starts from empty bins") {
+    species_bins.Update(store);
+    store.SetVelocity(0, glm::vec2(0, 0));
+    store.SetVelocity(2, glm::vec2(0, 0));
+    species_bins.Update(store);
+
+    REQUIRE(species_bins.GetSpeedBins(red_species).GetBins() ==
+            std::vector<size_t>({2}));
+    REQUIRE(species_bins.GetMaxSpeed(red_species) == 0.0f);
+  }
+
+  SECTION("Bins have room for any speed the total energy allows") {
+    species_bins.Update(store);
+    size_t green_species = species_bins.Register(green, 1);
+    species_bins.Update(store);
+
+    // Mass times squared speed sums to 111, so nothing passes sqrt(111)
+    REQUIRE(species_bins.GetSpeedBins(red_species).GetBins().capacity() >= 11);
+    REQUIRE(species_bins.GetSpeedBins(green_species).GetBins().capacity() >=
+            11);
+  }
+}
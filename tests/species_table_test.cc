@@ -0,0 +1,128 @@
+#include "components/species_table.h"
+
+#include <catch2/catch.hpp>
+#include <limits>
+#include <stdexcept>
+
+#include "cinder/gl/gl.h"
+#include "components/particle_store.h"
+#include "display/gas_container.h"
+
+TEST_CASE("Species table keeps attributes once per species") {
+  const ci::Color orange("orange");
+  const ci::Color blue("blue");
+  idealgas::SpeciesTable species_table;
+
+  SECTION("Matching attributes share a species") {
+    idealgas::SpeciesId first = species_table.FindOrAdd(orange, 3, 4);
+    idealgas::SpeciesId second = species_table.FindOrAdd(orange, 3, 4);
+
+    REQUIRE(first == second);
+    REQUIRE(species_table.Size() == 1);
+  }
+
+  SECTION("Any differing attribute makes a new species") {
+    species_table.FindOrAdd(orange, 3, 4);
+    species_table.FindOrAdd(blue, 3, 4);
+    species_table.FindOrAdd(orange, 5, 4);
+    idealgas::SpeciesId heavy = species_table.FindOrAdd(orange, 3, 6);
+
+    REQUIRE(heavy == 3);
+    REQUIRE(species_table.Size() == 4);
+    REQUIRE(species_table.GetColor(heavy) == orange);
+    REQUIRE(species_table.GetRadius(heavy) == 3.0f);
+    REQUIRE(species_table.GetMass(heavy) == 6.0f);
+  }
+
+  SECTION("Pair mass factors match the elastic collision equations") {
+    idealgas::SpeciesId light = species_table.FindOrAdd(orange, 3, 1);
+    idealgas::SpeciesId heavy = species_table.FindOrAdd(blue, 3, 3);
+
+    REQUIRE(species_table.GetMassFactor(light, heavy) == 1.5f);
+    REQUIRE(species_table.GetMassFactor(heavy, light) == 0.5f);
+    REQUIRE(species_table.GetMassFactor(light, light) == 1.0f);
+    REQUIRE(species_table.GetMassFactor(heavy, heavy) ==
+            idealgas::SpeciesTable::CalculateMassFactor(3, 3));
+  }
+
+  SECTION("Species are refused once every id is taken") {
+    size_t num_ids =
+        size_t(std::numeric_limits<idealgas::SpeciesId>::max()) + 1;
+    idealgas::SpeciesId last_species = 0;
+    for (size_t species = 0; species < num_ids; ++species) {
+      last_species = species_table.FindOrAdd(orange, float(species), 1);
+    }
+
+    REQUIRE(last_species == num_ids - 1);
+    REQUIRE_THROWS_AS(species_table.FindOrAdd(blue, 3, 1), std::length_error);
+    REQUIRE(species_table.FindOrAdd(orange, 7, 1) == 7);
+    REQUIRE(species_table.Size() == num_ids);
+  }
+}
+
+TEST_CASE("Particles are filtered by species id") {
+  const ci::Color orange("orange");
+  const ci::Color blue("blue");
+  idealgas::Particle small_orange(glm::vec2(20, 20), glm::vec2(1, 0), orange,
+                                  3, 1);
+  idealgas::Particle large_orange(glm::vec2(50, 50), glm::vec2(1, 0), orange,
+                                  6, 8);
+  idealgas::Particle small_blue(glm::vec2(80, 80), glm::vec2(1, 0), blue, 3,
+                                1);
+  idealgas::GasContainer container(
+      {&small_orange, &large_orange, &small_blue, &small_orange}, 0,
+      glm::vec2(0, 0), glm::vec2(100, 100), 3, 1, orange);
+  const idealgas::ParticleStore& store = container.GetParticleStore();
+
+  SECTION("Particles only store their species id") {
+    REQUIRE(store.GetSpeciesTable().Size() == 3);
+    REQUIRE(store.GetSpecies(0) == store.GetSpecies(3));
+    REQUIRE(store.GetMass(1) == 8.0f);
+    REQUIRE(store.GetColor(2) == blue);
+  }
+
+  SECTION("Filtering by species only returns that species") {
+    idealgas::ParticleRange particles =
+        container.GetParticlesBySpecies(store.GetSpecies(0));
+
+    REQUIRE(particles.size() == 2);
+    REQUIRE(particles[0]->GetPosition() == glm::vec2(20, 20));
+    REQUIRE(particles[1]->GetRadius() == 3.0f);
+  }
+
+  SECTION("Filtering by color spans every species of that color") {
+    REQUIRE(container.GetParticlesByColor(orange).size() == 3);
+    REQUIRE(container.GetParticlesByColor(blue).size() == 1);
+  }
+
+  SECTION("Filters follow particles as they are removed") {
+    container.RemoveParticle(0);
+
+    idealgas::ParticleRange particles =
+        container.GetParticlesBySpecies(store.GetSpecies(0));
+    REQUIRE(particles.size() == 1);
+    REQUIRE(particles[0]->GetPosition() == glm::vec2(20, 20));
+    REQUIRE(container.GetParticlesByColor(orange).size() == 2);
+    REQUIRE(container.GetParticlesByColor(blue).size() == 1);
+  }
+
+  SECTION("Filters follow particles as they are added and cleared") {
+    container.AddParticleToContainer(small_blue);
+    REQUIRE(container.GetParticlesByColor(blue).size() == 2);
+
+    container.ClearParticles();
+    REQUIRE(container.GetParticlesByColor(orange).empty());
+    REQUIRE(container.GetParticlesBySpecies(0).empty());
+  }
+
+  SECTION("Filters are views into the container's particles") {
+    idealgas::ParticleRange particles = container.GetParticlesByColor(blue);
+
+    REQUIRE(particles[0] == container.GetParticles()[2]);
+  }
+
+  SECTION("Unknown species and colors give an empty range") {
+    REQUIRE(container.GetParticlesBySpecies(10).empty());
+    REQUIRE(container.GetParticlesByColor(ci::Color("green")).empty());
+  }
+}
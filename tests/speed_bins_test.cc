@@ -0,0 +1,45 @@
+#include "components/speed_bins.h"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Speed bins count particles by speed") {
+  glm::vec2 position(10, 10);
+  idealgas::Color color(1, 0, 0);
+  idealgas::Color other_color(0, 0, 1);
+  float radius = 10.0f;
+  float mass = 1.0f;
+
+  SECTION("New bins start with one empty bin") {
+    idealgas::SpeedBins speed_bins(2);
+
+    REQUIRE(speed_bins.GetBins() == std::vector<size_t>({0}));
+    REQUIRE(speed_bins.GetBinWidth() == 2.0f);
+  }
+
+  SECTION("Bin width scales the bin each particle lands in") {
+    idealgas::SpeedBins speed_bins(2);
+    idealgas::ParticleStore store;
+    store.Add(position, glm::vec2(1, 0), color, radius, mass);
+    store.Add(position, glm::vec2(0, 5), color, radius, mass);
+    store.Add(position, glm::vec2(0, 4), other_color, radius, mass);
+
+    speed_bins.Update(store, color);
+
+    REQUIRE(speed_bins.GetBins() == std::vector<size_t>({1, 0, 1}));
+    REQUIRE(speed_bins.GetNumBins() == 3);
+    REQUIRE(speed_bins.CalculateMostParticlesInSingleBin() == 1);
+  }
+
+  SECTION("Bins shrink when the fastest particle slows down") {
+    idealgas::SpeedBins speed_bins(1);
+    idealgas::ParticleStore store;
+    store.Add(position, glm::vec2(6, 0), color, radius, mass);
+
+    speed_bins.Update(store, color);
+    REQUIRE(speed_bins.GetNumBins() == 7);
+
+    store.SetVelocity(0, glm::vec2(1, 0));
+    speed_bins.Update(store, color);
+    REQUIRE(speed_bins.GetBins() == std::vector<size_t>({0, 1}));
+  }
+}
@@ -0,0 +1,130 @@
+#include "physics/sweep_and_prune.h"
+
+#include <catch2/catch.hpp>
+#include <limits>
+
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+TEST_CASE("Sweep and prune pairs up overlapping intervals") {
+  glm::vec2 velocity(0, 0);
+  float mass = 1.0f;
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  idealgas::SweepAndPrune sweep_and_prune;
+  std::vector<size_t> candidates;
+
+  store.Add(glm::vec2(50, 20), velocity, color, 9, mass);
+  store.Add(glm::vec2(10, 20), velocity, color, 3, mass);
+  // Overlaps the large particle along x and y
+  store.Add(glm::vec2(40, 25), velocity, color, 3, mass);
+  // Overlaps the large particle along x only
+  store.Add(glm::vec2(55, 60), velocity, color, 3, mass);
+  // Too far right of the small particle at x = 10 to overlap it
+  store.Add(glm::vec2(17, 20), velocity, color, 3, mass);
+  sweep_and_prune.Update(store);
+
+  SECTION("Only pairs overlapping along both axes are candidates") {
+    sweep_and_prune.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({2}));
+    sweep_and_prune.GatherNeighbourCandidates(1, &candidates);
+    REQUIRE(candidates.empty());
+    REQUIRE(sweep_and_prune.GetNumPairs() == 1);
+  }
+
+  SECTION("Pairs are listed under the earlier particle in ascending order") {
+    store.SetPosition(4, glm::vec2(44, 22));
+    sweep_and_prune.Update(store);
+
+    sweep_and_prune.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({2, 4}));
+    sweep_and_prune.GatherNeighbourCandidates(2, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({4}));
+  }
+
+  SECTION("Small moves only need a few swaps to restore the order") {
+    store.SetPosition(1, glm::vec2(12, 20));
+    sweep_and_prune.Update(store);
+    REQUIRE(sweep_and_prune.GetNumSwaps() == 0);
+
+    // Passes the left edges of the particles at x = 17 and x = 40
+    store.SetPosition(1, glm::vec2(42, 20));
+    sweep_and_prune.Update(store);
+    REQUIRE(sweep_and_prune.GetNumSwaps() == 2);
+  }
+
+  SECTION("Particles at NaN positions are skipped without upsetting the "
+          "order") {
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    store.SetPosition(1, glm::vec2(nan, 20));
+    store.SetPosition(3, glm::vec2(nan, nan));
+    idealgas::SweepAndPrune fresh_sweep_and_prune;
+    fresh_sweep_and_prune.Update(store);
+    sweep_and_prune.Update(store);
+
+    for (idealgas::SweepAndPrune* sweep : {&fresh_sweep_and_prune,
+                                           &sweep_and_prune}) {
+      sweep->GatherNeighbourCandidates(0, &candidates);
+      REQUIRE(candidates == std::vector<size_t>({2}));
+      sweep->GatherNeighbourCandidates(4, &candidates);
+      REQUIRE(candidates.empty());
+    }
+  }
+
+  SECTION("A different number of particles sorts from scratch") {
+    store.Add(glm::vec2(48, 22), velocity, color, 3, mass);
+    sweep_and_prune.Update(store);
+
+    REQUIRE(sweep_and_prune.GetNumSwaps() == 0);
+    sweep_and_prune.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({2, 5}));
+  }
+}
+
+TEST_CASE("Sweep and prune resolves the same collisions as the grid") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(300, 300);
+  std::vector<idealgas::Particle> particles;
+  srand(5);
+  // The app's three species, so the grid's cells are sized for the largest
+  const float kRadii[] = {3, 6, 9};
+  for (size_t idx = 0; idx < 600; ++idx) {
+    float radius = kRadii[idx % 3];
+    glm::vec2 position(rand() % 300, rand() % 300);
+    glm::vec2 velocity(float(rand() % 7) - 3, float(rand() % 7) - 3);
+    particles.push_back(idealgas::Particle(position, velocity,
+                                           ci::Color("white"), radius,
+                                           radius + 2));
+  }
+  std::vector<idealgas::Particle*> initial_particles;
+  for (idealgas::Particle& particle : particles) {
+    initial_particles.push_back(&particle);
+  }
+
+  idealgas::GasContainer grid_container(initial_particles, 0, top_left_corner,
+                                        bottom_right_corner, 3, 1,
+                                        ci::Color("white"));
+  idealgas::GasContainer sweep_container(grid_container);
+  sweep_container.SetBroadPhase(idealgas::BroadPhase::kSweepAndPrune);
+  size_t num_threads = GENERATE(1, 3);
+  sweep_container.SetNumThreads(num_threads);
+
+  for (size_t frame = 0; frame < 50; ++frame) {
+    if (frame == 25) {
+      grid_container.RemoveParticle(7);
+      sweep_container.RemoveParticle(7);
+    }
+    grid_container.AdvanceOneFrame();
+    sweep_container.AdvanceOneFrame();
+  }
+
+  const idealgas::ParticleStore& grid_store =
+      grid_container.GetParticleStore();
+  const idealgas::ParticleStore& sweep_store =
+      sweep_container.GetParticleStore();
+  REQUIRE(sweep_store.Size() == grid_store.Size());
+  for (size_t slot = 0; slot < grid_store.Size(); ++slot) {
+    REQUIRE(sweep_store.GetPosition(slot) == grid_store.GetPosition(slot));
+    REQUIRE(sweep_store.GetVelocity(slot) == grid_store.GetVelocity(slot));
+  }
+}
@@ -0,0 +1,233 @@
+#include "components/trace_recorder.h"
+
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "allocation_counter.h"
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+namespace {
+
+size_t CountOccurrences(const std::string& text, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t position = text.find(pattern); position != std::string::npos;
+       position = text.find(pattern, position + pattern.size())) {
+    ++count;
+  }
+
+  return count;
+}
+
+}  // namespace
+
+TEST_CASE("Trace recorder keeps events from a bounded window of frames") {
+  idealgas::TraceRecorder recorder;
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+  SECTION("Nothing is recorded before Start") {
+    recorder.Record("ignored", now, now);
+    REQUIRE_FALSE(recorder.IsRecording());
+    REQUIRE(recorder.GetNumEvents() == 0);
+  }
+
+  SECTION("Recording stops by itself once the window is over") {
+    recorder.Start(2);
+    recorder.Record("first", now, now);
+    recorder.MarkFrame();
+    REQUIRE(recorder.IsRecording());
+    recorder.Record("second", now, now);
+    recorder.MarkFrame();
+    REQUIRE_FALSE(recorder.IsRecording());
+    recorder.Record("too late", now, now);
+
+    REQUIRE(recorder.GetNumEvents() == 2);
+  }
+
+  SECTION("Stop ends the window early") {
+    recorder.Start(100);
+    recorder.Record("kept", now, now);
+    recorder.Stop();
+    recorder.Record("dropped", now, now);
+
+    REQUIRE(recorder.GetNumEvents() == 1);
+  }
+
+  SECTION("Starting again throws away the last window") {
+    recorder.Start(1);
+    recorder.Record("old", now, now);
+    recorder.Start(1);
+    recorder.Record("new", now, now);
+
+    std::ostringstream json;
+    recorder.WriteJson(json);
+    REQUIRE(recorder.GetNumEvents() == 1);
+    REQUIRE(json.str().find("\"old\"") == std::string::npos);
+    REQUIRE(json.str().find("\"new\"") != std::string::npos);
+  }
+
+  SECTION("A full buffer drops events instead of growing") {
+    recorder.Start(1);
+    for (size_t event = 0;
+         event < idealgas::TraceRecorder::kMaxEventsPerThread + 5; ++event) {
+      recorder.Record("event", now, now);
+    }
+
+    REQUIRE(recorder.GetNumEvents() ==
+            idealgas::TraceRecorder::kMaxEventsPerThread);
+    REQUIRE(recorder.GetNumDroppedEvents() == 5);
+  }
+
+  SECTION("Scoped events are only recorded while recording") {
+    { idealgas::TraceRecorder::ScopedEvent event(&recorder, "before"); }
+    recorder.Start(1);
+    { idealgas::TraceRecorder::ScopedEvent event(&recorder, "during"); }
+
+    REQUIRE(recorder.GetNumEvents() == 1);
+  }
+}
+
+TEST_CASE("Trace recorder hands each thread a preallocated buffer") {
+  idealgas::TraceRecorder recorder;
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+  SECTION("Recording into a claimed buffer doesn't allocate") {
+    recorder.Start(1);
+    recorder.Record("first", now, now);
+
+    idealgas::AllocationCounter counter;
+    for (size_t event = 0; event < 100; ++event) {
+      recorder.Record("event", now, now);
+    }
+    recorder.Start(1);
+    recorder.Record("next window", now, now);
+
+    REQUIRE(counter.GetNumAllocations() == 0);
+    REQUIRE(recorder.GetNumEvents() == 1);
+  }
+
+  SECTION("Events from a thread without a buffer are counted as dropped") {
+    recorder.Start(1);
+    std::thread worker([&recorder, now]() {
+      recorder.Record("unnamed", now, now);
+    });
+    worker.join();
+
+    REQUIRE(recorder.GetNumEvents() == 0);
+    REQUIRE(recorder.GetNumDroppedEvents() == 1);
+  }
+
+  SECTION("Threads that have exited give their slots to later threads") {
+    for (size_t thread = 0;
+         thread < idealgas::TraceRecorder::kMaxThreads + 10; ++thread) {
+      recorder.Start(1);
+      std::thread worker([&recorder, now]() {
+        recorder.NameThisThread("worker");
+        recorder.Record("on worker", now, now);
+      });
+      worker.join();
+
+      REQUIRE(recorder.GetNumEvents() == 1);
+      REQUIRE(recorder.GetNumDroppedEvents() == 0);
+    }
+  }
+
+  SECTION("A slot is kept until its events leave the window") {
+    recorder.Start(1);
+    std::thread first_worker([&recorder, now]() {
+      recorder.NameThisThread("first");
+      recorder.Record("on first", now, now);
+    });
+    first_worker.join();
+    std::thread second_worker([&recorder, now]() {
+      recorder.NameThisThread("second");
+      recorder.Record("on second", now, now);
+    });
+    second_worker.join();
+
+    std::ostringstream json;
+    recorder.WriteJson(json);
+    REQUIRE(recorder.GetNumEvents() == 2);
+    REQUIRE(json.str().find("\"on first\"") != std::string::npos);
+  }
+}
+
+TEST_CASE("Trace recorder writes Chrome trace-event JSON") {
+  idealgas::TraceRecorder recorder;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point end =
+      start + std::chrono::microseconds(250);
+
+  SECTION("Events are complete events with a duration in microseconds") {
+    recorder.Start(1);
+    recorder.Record("step \"one\"", start, end);
+
+    std::ostringstream json;
+    recorder.WriteJson(json);
+    std::string text = json.str();
+    REQUIRE(text.find("{\"traceEvents\":[") == 0);
+    REQUIRE(text.find("\"name\":\"step \\\"one\\\"\"") != std::string::npos);
+    REQUIRE(text.find("\"ph\":\"X\"") != std::string::npos);
+    REQUIRE(text.find("\"dur\":250.000") != std::string::npos);
+  }
+
+  SECTION("Each thread gets its own track and name") {
+    recorder.Start(1);
+    recorder.NameThisThread("main");
+    recorder.Record("on main", start, end);
+    std::thread worker([&recorder, start, end]() {
+      recorder.NameThisThread("worker");
+      recorder.Record("on worker", start, end);
+    });
+    worker.join();
+
+    std::ostringstream json;
+    recorder.WriteJson(json);
+    std::string text = json.str();
+    REQUIRE(recorder.GetNumEvents() == 2);
+    REQUIRE(CountOccurrences(text, "\"thread_name\"") == 2);
+    REQUIRE(text.find("\"name\":\"on main\",\"cat\":\"idealgas\",\"ph\":\"X\"")
+            != std::string::npos);
+    REQUIRE(text.find("\"tid\":0") != std::string::npos);
+    REQUIRE(text.find("\"tid\":1") != std::string::npos);
+  }
+
+  SECTION("An empty window still writes a valid trace") {
+    recorder.Start(1);
+
+    std::ostringstream json;
+    recorder.WriteJson(json);
+    REQUIRE(json.str() ==
+            "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ms\"}\n");
+  }
+}
+
+#ifdef IDEALGAS_PROFILING
+TEST_CASE("Container frames are traced through the shared recorder") {
+  idealgas::TraceRecorder& recorder = idealgas::TraceRecorder::GetInstance();
+  std::vector<idealgas::Particle*> particles;
+  idealgas::Particle particle(glm::vec2(20, 20), glm::vec2(1, 0),
+                              ci::Color("white"), 1, 1);
+  particles.push_back(&particle);
+  idealgas::GasContainer container(particles, 0, glm::vec2(0, 0),
+                                   glm::vec2(100, 100), 1, 1,
+                                   ci::Color("white"));
+
+  SECTION("Every phase of every frame in the window is recorded") {
+    recorder.Start(2);
+    for (size_t frame = 0; frame < 5; ++frame) {
+      container.AdvanceOneFrame();
+    }
+
+    std::ostringstream json;
+    recorder.WriteJson(json);
+    std::string text = json.str();
+    REQUIRE_FALSE(recorder.IsRecording());
+    REQUIRE(CountOccurrences(text, "\"advance frame\"") == 2);
+    REQUIRE(CountOccurrences(text, "\"position update\"") == 2);
+  }
+}
+#endif
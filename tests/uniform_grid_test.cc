@@ -0,0 +1,182 @@
+#include "physics/uniform_grid.h"
+
+#include <catch2/catch.hpp>
+#include <limits>
+
+#include "cinder/gl/gl.h"
+
+TEST_CASE("Uniform grid sizes its cells from the largest particle") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  glm::vec2 velocity(0, 0);
+  float mass = 1.0f;
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+
+  store.Add(glm::vec2(10, 10), velocity, color, 2, mass);
+  store.Add(glm::vec2(50, 50), velocity, color, 10, mass);
+
+  idealgas::UniformGrid grid;
+  grid.Rebuild(store, top_left_corner, bottom_right_corner);
+
+  REQUIRE(grid.GetCellSize() >= 20.0f);
+  REQUIRE(grid.GetNumColumns() * grid.GetCellSize() >= 100.0f);
+  REQUIRE(grid.GetNumRows() * grid.GetCellSize() >= 100.0f);
+}
+
+TEST_CASE("Uniform grid gathers neighbouring particles") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  glm::vec2 velocity(0, 0);
+  float radius = 5.0f;
+  float mass = 1.0f;
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  std::vector<size_t> candidates;
+
+  SECTION("Particles in the same cell are candidates") {
+    store.Add(glm::vec2(20, 20), velocity, color, radius, mass);
+    store.Add(glm::vec2(22, 22), velocity, color, radius, mass);
+
+    idealgas::UniformGrid grid;
+    grid.Rebuild(store, top_left_corner, bottom_right_corner);
+    grid.GatherNeighbourCandidates(0, &candidates);
+
+    REQUIRE(candidates == std::vector<size_t>({1}));
+  }
+
+  SECTION("Touching particles across a cell border are candidates") {
+    store.Add(glm::vec2(9, 50), velocity, color, radius, mass);
+    store.Add(glm::vec2(18, 50), velocity, color, radius, mass);
+
+    idealgas::UniformGrid grid;
+    grid.Rebuild(store, top_left_corner, bottom_right_corner);
+    grid.GatherNeighbourCandidates(0, &candidates);
+
+    REQUIRE(candidates == std::vector<size_t>({1}));
+  }
+
+  SECTION("Far apart particles are not candidates") {
+    store.Add(glm::vec2(10, 10), velocity, color, radius, mass);
+    store.Add(glm::vec2(90, 90), velocity, color, radius, mass);
+
+    idealgas::UniformGrid grid;
+    grid.Rebuild(store, top_left_corner, bottom_right_corner);
+    grid.GatherNeighbourCandidates(0, &candidates);
+
+    REQUIRE(candidates.empty());
+  }
+
+  SECTION("Only later particles are returned in ascending order") {
+    store.Add(glm::vec2(50, 50), velocity, color, radius, mass);
+    store.Add(glm::vec2(55, 45), velocity, color, radius, mass);
+    store.Add(glm::vec2(45, 55), velocity, color, radius, mass);
+    store.Add(glm::vec2(50, 52), velocity, color, radius, mass);
+
+    idealgas::UniformGrid grid;
+    grid.Rebuild(store, top_left_corner, bottom_right_corner);
+
+    grid.GatherNeighbourCandidates(1, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({2, 3}));
+
+    grid.GatherNeighbourCandidates(3, &candidates);
+    REQUIRE(candidates.empty());
+  }
+
+  SECTION("Particles outside the container are kept in the border cells") {
+    store.Add(glm::vec2(-3, 50), velocity, color, radius, mass);
+    store.Add(glm::vec2(4, 50), velocity, color, radius, mass);
+
+    idealgas::UniformGrid grid;
+    grid.Rebuild(store, top_left_corner, bottom_right_corner);
+    grid.GatherNeighbourCandidates(0, &candidates);
+
+    REQUIRE(candidates == std::vector<size_t>({1}));
+  }
+
+  SECTION("Runaway and NaN positions are clamped into the edge cells") {
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    store.Add(glm::vec2(1e30f, -1e30f), velocity, color, radius, mass);
+    store.Add(glm::vec2(nan, nan), velocity, color, radius, mass);
+    store.Add(glm::vec2(95, 5), velocity, color, radius, mass);
+    store.Add(glm::vec2(5, 5), velocity, color, radius, mass);
+
+    idealgas::UniformGrid grid;
+    grid.Rebuild(store, top_left_corner, bottom_right_corner);
+    grid.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({2}));
+
+    grid.GatherNeighbourCandidates(1, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({3}));
+  }
+}
+
+TEST_CASE("Uniform grid bins the same cells on any number of threads") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(300, 300);
+  glm::vec2 velocity(0, 0);
+  idealgas::ParticleStore store;
+  std::vector<size_t> serial_candidates;
+  std::vector<size_t> candidates;
+
+  // Enough particles for the rebuild to be split into several parts, with a
+  // crowded corner so the parts' runs of cells hold very different numbers
+  srand(7);
+  for (size_t idx = 0; idx < 10000; ++idx) {
+    float radius = idx % 5 == 0 ? 4.0f : 2.0f;
+    int spread = idx % 3 == 0 ? 20 : 320;
+    store.Add(glm::vec2(rand() % spread - 10, rand() % spread - 10), velocity,
+              ci::Color("orange"), radius, 1);
+  }
+
+  idealgas::UniformGrid serial_grid;
+  serial_grid.Rebuild(store, top_left_corner, bottom_right_corner);
+
+  size_t num_threads = GENERATE(2, 3, 8);
+  idealgas::WorkStealingPool pool(num_threads);
+  idealgas::UniformGrid grid;
+  grid.SetTaskPool(&pool);
+
+  // Rebuilding twice checks that the counts from the last rebuild are cleared
+  grid.Rebuild(store, top_left_corner, bottom_right_corner);
+  grid.Rebuild(store, top_left_corner, bottom_right_corner);
+
+  REQUIRE(grid.GetCellSize() == serial_grid.GetCellSize());
+  for (size_t idx = 0; idx < store.Size(); ++idx) {
+    serial_grid.GatherNeighbourCandidates(idx, &serial_candidates);
+    grid.GatherNeighbourCandidates(idx, &candidates);
+    REQUIRE(candidates == serial_candidates);
+  }
+}
+
+TEST_CASE("Uniform grid bins one crowded cell the same on several threads") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(300, 300);
+  glm::vec2 velocity(0, 0);
+  idealgas::ParticleStore store;
+  std::vector<size_t> serial_candidates;
+  std::vector<size_t> candidates;
+
+  // Every run of cells but one is left nearly empty
+  srand(11);
+  for (size_t idx = 0; idx < 5000; ++idx) {
+    glm::vec2 position = idx % 100 == 0
+                             ? glm::vec2(rand() % 300, rand() % 300)
+                             : glm::vec2(150 + rand() % 3, 150 + rand() % 3);
+    store.Add(position, velocity, ci::Color("orange"), 2, 1);
+  }
+
+  idealgas::UniformGrid serial_grid;
+  serial_grid.Rebuild(store, top_left_corner, bottom_right_corner);
+
+  idealgas::WorkStealingPool pool(4);
+  idealgas::UniformGrid grid;
+  grid.SetTaskPool(&pool);
+  grid.Rebuild(store, top_left_corner, bottom_right_corner);
+
+  for (size_t idx = 0; idx < store.Size(); idx += 7) {
+    serial_grid.GatherNeighbourCandidates(idx, &serial_candidates);
+    grid.GatherNeighbourCandidates(idx, &candidates);
+    REQUIRE(candidates == serial_candidates);
+  }
+}
@@ -0,0 +1,163 @@
+#include "physics/verlet_neighbour_list.h"
+
+#include <catch2/catch.hpp>
+
+#include "cinder/gl/gl.h"
+#include "display/gas_container.h"
+
+TEST_CASE("Verlet lists keep the later particles within the skin") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  glm::vec2 velocity(0, 0);
+  float radius = 5.0f;
+  float mass = 1.0f;
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  idealgas::VerletNeighbourList neighbour_list(4);
+  std::vector<size_t> candidates;
+
+  store.Add(glm::vec2(20, 20), velocity, color, radius, mass);
+  store.Add(glm::vec2(80, 80), velocity, color, radius, mass);
+  // 13 apart, inside the radii plus skin of 14
+  store.Add(glm::vec2(33, 20), velocity, color, radius, mass);
+  // 15 apart, outside the skin
+  store.Add(glm::vec2(20, 35), velocity, color, radius, mass);
+
+  REQUIRE(neighbour_list.Update(store, top_left_corner, bottom_right_corner));
+
+  SECTION("Only pairs within the radii plus the skin are listed") {
+    neighbour_list.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({2}));
+    REQUIRE(neighbour_list.GetNumNeighbours(1) == 0);
+  }
+
+  SECTION("Pairs are only listed under the earlier particle") {
+    REQUIRE(neighbour_list.GetNumNeighbours(2) == 0);
+    REQUIRE(neighbour_list.GetNeighbours(0)[0] == 2);
+  }
+
+  SECTION("Moving less than half the skin keeps the lists") {
+    store.SetPosition(0, glm::vec2(21.5f, 21.0f));
+
+    REQUIRE_FALSE(
+        neighbour_list.Update(store, top_left_corner, bottom_right_corner));
+    REQUIRE(neighbour_list.GetNumRebuilds() == 1);
+  }
+
+  SECTION("Moving more than half the skin rebuilds the lists") {
+    store.SetPosition(3, glm::vec2(20, 32));
+
+    REQUIRE(neighbour_list.Update(store, top_left_corner, bottom_right_corner));
+    neighbour_list.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({2, 3}));
+  }
+
+  SECTION("Invalidating or changing the skin rebuilds the lists") {
+    neighbour_list.Invalidate();
+    REQUIRE(neighbour_list.Update(store, top_left_corner, bottom_right_corner));
+
+    neighbour_list.SetSkin(6);
+    REQUIRE(neighbour_list.Update(store, top_left_corner, bottom_right_corner));
+    neighbour_list.GatherNeighbourCandidates(0, &candidates);
+    REQUIRE(candidates == std::vector<size_t>({2, 3}));
+    REQUIRE(neighbour_list.GetNumRebuilds() == 3);
+  }
+
+  SECTION("A different number of particles rebuilds the lists") {
+    store.Add(glm::vec2(50, 50), velocity, color, radius, mass);
+
+    REQUIRE(neighbour_list.Update(store, top_left_corner, bottom_right_corner));
+    REQUIRE(neighbour_list.GetNumNeighbours(4) == 0);
+  }
+}
+
+TEST_CASE("Verlet lists without a skin keep pairs that exactly touch") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  glm::vec2 velocity(0, 0);
+  ci::Color color("orange");
+  idealgas::ParticleStore store;
+  idealgas::VerletNeighbourList neighbour_list(0);
+  idealgas::CollisionPhysics physics(top_left_corner, bottom_right_corner);
+  std::vector<size_t> candidates;
+
+  // The radii sum to the distance between the centers, which the collision
+  // test's square root rounds to touching but squaring both sides does not
+  store.Add(glm::vec2(56.652f, 50.756f), velocity, color, 4.01f, 1);
+  store.Add(glm::vec2(49.2061996f, 53.1131516f), velocity, color, 3.8f, 1);
+  neighbour_list.Update(store, top_left_corner, bottom_right_corner);
+
+  REQUIRE(physics.AreParticlesTouching(store, 0, 1));
+  neighbour_list.GatherNeighbourCandidates(0, &candidates);
+  REQUIRE(candidates == std::vector<size_t>({1}));
+}
+
+TEST_CASE("Verlet lists resolve the same collisions as the grid") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(200, 200);
+
+  srand(11);
+  idealgas::GasContainer grid_container(std::vector<idealgas::Particle*>(),
+                                        600, top_left_corner,
+                                        bottom_right_corner, 4, 1,
+                                        ci::Color("orange"));
+  idealgas::GasContainer verlet_container(grid_container);
+  verlet_container.SetBroadPhase(idealgas::BroadPhase::kVerletList);
+
+  SECTION("The broad phase and skin are kept on copies") {
+    verlet_container.SetNeighbourSkin(3);
+    idealgas::GasContainer copied_container(verlet_container);
+
+    REQUIRE(grid_container.GetBroadPhase() ==
+            idealgas::BroadPhase::kAutomatic);
+    REQUIRE(copied_container.GetBroadPhase() ==
+            idealgas::BroadPhase::kVerletList);
+    REQUIRE(copied_container.GetNeighbourSkin() == 3.0f);
+  }
+
+  SECTION("Every skin and thread count gives the grid's particles") {
+    float skin = GENERATE(0.0f, 2.0f, 8.0f);
+    size_t num_threads = GENERATE(1, 3);
+    verlet_container.SetNeighbourSkin(skin);
+    verlet_container.SetNumThreads(num_threads);
+
+    for (size_t frame = 0; frame < 50; ++frame) {
+      grid_container.AdvanceOneFrame();
+      verlet_container.AdvanceOneFrame();
+    }
+
+    const idealgas::ParticleStore& grid_store =
+        grid_container.GetParticleStore();
+    const idealgas::ParticleStore& verlet_store =
+        verlet_container.GetParticleStore();
+    REQUIRE(verlet_store.Size() == grid_store.Size());
+    for (size_t slot = 0; slot < grid_store.Size(); ++slot) {
+      REQUIRE(verlet_store.GetPosition(slot) == grid_store.GetPosition(slot));
+      REQUIRE(verlet_store.GetVelocity(slot) == grid_store.GetVelocity(slot));
+    }
+  }
+
+  SECTION("Adding and removing particles keeps the lists in step") {
+    idealgas::Particle particle(glm::vec2(100, 100), glm::vec2(1, 1),
+                                ci::Color("blue"), 4, 1);
+    for (size_t frame = 0; frame < 30; ++frame) {
+      if (frame % 10 == 5) {
+        grid_container.RemoveParticle(frame);
+        verlet_container.RemoveParticle(frame);
+        grid_container.AddParticleToContainer(particle);
+        verlet_container.AddParticleToContainer(particle);
+      }
+      grid_container.AdvanceOneFrame();
+      verlet_container.AdvanceOneFrame();
+    }
+
+    const idealgas::ParticleStore& grid_store =
+        grid_container.GetParticleStore();
+    const idealgas::ParticleStore& verlet_store =
+        verlet_container.GetParticleStore();
+    for (size_t slot = 0; slot < grid_store.Size(); ++slot) {
+      REQUIRE(verlet_store.GetPosition(slot) == grid_store.GetPosition(slot));
+      REQUIRE(verlet_store.GetVelocity(slot) == grid_store.GetVelocity(slot));
+    }
+  }
+}
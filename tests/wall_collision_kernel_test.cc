@@ -0,0 +1,75 @@
+#include "physics/wall_collision_kernel.h"
+
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <vector>
+
+#include "cinder/gl/gl.h"
+#include "physics/collision_physics.h"
+
+namespace {
+
+float RandomFloat(float min, float max) {
+  return float(rand()) / float(RAND_MAX) * (max - min) + min;
+}
+
+}  // namespace
+
+TEST_CASE("Wall kernel matches the per-particle wall checks") {
+  glm::vec2 top_left_corner(0, 0);
+  glm::vec2 bottom_right_corner(100, 100);
+  idealgas::CollisionPhysics physics(top_left_corner, bottom_right_corner);
+
+  // Odd sizes leave a tail for the scalar path after the vector lanes
+  size_t count = GENERATE(0, 1, 3, 4, 7, 8, 13, 64, 1001);
+  srand(unsigned(count));
+
+  std::vector<float> positions;
+  std::vector<float> velocities;
+  std::vector<float> radii;
+  for (size_t idx = 0; idx < count; ++idx) {
+    positions.push_back(RandomFloat(-10, 110));
+    radii.push_back(RandomFloat(1, 10));
+    // Include exact zeros and exact wall contacts
+    velocities.push_back(idx % 5 == 0 ? 0 : RandomFloat(-5, 5));
+    if (idx % 7 == 0) {
+      positions[idx] = radii[idx];
+    }
+  }
+
+  std::vector<float> expected_velocities;
+  size_t expected_reflections = 0;
+  for (size_t idx = 0; idx < count; ++idx) {
+    bool is_colliding = physics.IsParticleCollidingWithLeftWall(
+                            positions[idx], velocities[idx], radii[idx]) ||
+                        physics.IsParticleCollidingWithRightWall(
+                            positions[idx], velocities[idx], radii[idx]);
+    expected_velocities.push_back(is_colliding ? -velocities[idx]
+                                               : velocities[idx]);
+    expected_reflections += is_colliding;
+  }
+
+  SECTION("Every instruction set gives identical velocities") {
+    idealgas::WallCollisionKernel::InstructionSet instruction_set = GENERATE(
+        idealgas::WallCollisionKernel::InstructionSet::kScalar,
+        idealgas::WallCollisionKernel::InstructionSet::kSse,
+        idealgas::WallCollisionKernel::InstructionSet::kAvx2);
+    idealgas::WallCollisionKernel kernel(instruction_set);
+
+    std::vector<float> reflected_velocities = velocities;
+    size_t num_reflected = kernel.Reflect(
+        positions.data(), reflected_velocities.data(), radii.data(), count,
+        top_left_corner.x, bottom_right_corner.x);
+
+    REQUIRE(reflected_velocities == expected_velocities);
+    REQUIRE(num_reflected == expected_reflections);
+  }
+}
+
+TEST_CASE("Wall kernel falls back to an instruction set the CPU has") {
+  idealgas::WallCollisionKernel kernel(
+      idealgas::WallCollisionKernel::InstructionSet::kAvx2);
+
+  REQUIRE(kernel.GetInstructionSet() <=
+          idealgas::WallCollisionKernel::DetectInstructionSet());
+}
@@ -0,0 +1,113 @@
+#include "components/work_stealing_pool.h"
+
+#include <catch2/catch.hpp>
+#include <chrono>
+
+TEST_CASE("Work-stealing pool runs every chunk of a loop once") {
+  size_t num_threads = GENERATE(1, 2, 4);
+  idealgas::WorkStealingPool pool(num_threads);
+
+  SECTION("Every iteration is visited exactly once") {
+    std::vector<std::atomic<size_t>> visits(1000);
+    for (std::atomic<size_t>& visit : visits) {
+      visit = 0;
+    }
+
+    pool.ParallelFor(visits.size(), 7,
+                     [&](size_t begin, size_t end, size_t thread) {
+                       REQUIRE(thread < num_threads);
+                       for (size_t idx = begin; idx < end; ++idx) {
+                         ++visits[idx];
+                       }
+                     });
+
+    for (std::atomic<size_t>& visit : visits) {
+      REQUIRE(visit == 1);
+    }
+  }
+
+  SECTION("Chunks are at most the grain size and start on its multiples") {
+    std::atomic<size_t> num_chunks(0);
+    std::atomic<size_t> num_bad_chunks(0);
+    pool.ParallelFor(103, 10, [&](size_t begin, size_t end, size_t) {
+      ++num_chunks;
+      if (begin % 10 != 0 || end <= begin || end - begin > 10 || end > 103) {
+        ++num_bad_chunks;
+      }
+    });
+
+    REQUIRE(num_chunks == 11);
+    REQUIRE(num_bad_chunks == 0);
+  }
+
+  SECTION("An empty loop runs no chunks") {
+    size_t num_chunks = 0;
+    pool.ParallelFor(0, 4, [&](size_t, size_t, size_t) { ++num_chunks; });
+
+    REQUIRE(num_chunks == 0);
+  }
+
+  SECTION("The same threads run loop after loop") {
+    std::atomic<size_t> total(0);
+    for (size_t loop = 0; loop < 500; ++loop) {
+      pool.ParallelFor(64, 1, [&](size_t begin, size_t end, size_t) {
+        total += end - begin;
+      });
+    }
+
+    REQUIRE(total == 500 * 64);
+    REQUIRE(pool.GetNumThreads() == num_threads);
+  }
+
+  SECTION("Tasks are each run once") {
+    std::vector<std::atomic<size_t>> runs(37);
+    for (std::atomic<size_t>& run : runs) {
+      run = 0;
+    }
+
+    pool.RunTasks(runs.size(), [&](size_t index) { ++runs[index]; });
+
+    for (std::atomic<size_t>& run : runs) {
+      REQUIRE(run == 1);
+    }
+  }
+}
+
+TEST_CASE("Work-stealing pool balances uneven loops") {
+  SECTION("Idle threads steal chunks from a thread left with slow ones") {
+    idealgas::WorkStealingPool pool(4);
+    std::atomic<size_t> num_chunks(0);
+
+    // The first thread's share is the only slow one
+    pool.ParallelFor(64, 1, [&](size_t begin, size_t, size_t) {
+      if (begin < 16) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+      ++num_chunks;
+    });
+
+    REQUIRE(num_chunks == 64);
+    REQUIRE(pool.GetNumSteals() > 0);
+  }
+
+  SECTION("Changing the thread count keeps the pool usable") {
+    idealgas::WorkStealingPool pool(2);
+    pool.SetNumThreads(5);
+    pool.SetNumThreads(0);
+    std::atomic<size_t> total(0);
+    pool.ParallelFor(100, 3, [&](size_t begin, size_t end, size_t) {
+      total += end - begin;
+    });
+
+    REQUIRE(pool.GetNumThreads() == 1);
+    REQUIRE(total == 100);
+  }
+
+  SECTION("Grain sizes give each thread several chunks above the minimum") {
+    idealgas::WorkStealingPool pool(4);
+
+    REQUIRE(pool.CalculateGrainSize(3200, 1) == 100);
+    REQUIRE(pool.CalculateGrainSize(3200, 500) == 500);
+    REQUIRE(pool.CalculateGrainSize(0, 0) == 1);
+  }
+}
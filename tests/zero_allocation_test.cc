@@ -0,0 +1,128 @@
+#include <catch2/catch.hpp>
+
+#include "allocation_counter.h"
+#include "cinder/gl/gl.h"
+#include "components/frame_profiler.h"
+#include "components/species_speed_bins.h"
+#include "display/command_queue.h"
+#include "display/gas_container.h"
+
+namespace {
+
+const size_t kWarmUpFrames = 20;
+const size_t kCountedFrames = 200;
+
+/**
+ * Steps a container through enough frames for every buffer it keeps to reach
+ * its steady size
+ */
+void WarmUp(idealgas::GasContainer* container) {
+  for (size_t frame = 0; frame < kWarmUpFrames; ++frame) {
+    container->AdvanceOneFrame();
+  }
+}
+
+}  // namespace
+
+TEST_CASE("A warmed up frame makes no heap allocations") {
+  std::vector<idealgas::Particle*> particles;
+  idealgas::GasContainer container(particles, 300, glm::vec2(0, 0),
+                                   glm::vec2(300, 300), 3, 1,
+                                   ci::Color("white"));
+
+  SECTION("Fixed step frames") {
+    WarmUp(&container);
+
+    idealgas::AllocationCounter counter;
+    for (size_t frame = 0; frame < kCountedFrames; ++frame) {
+      container.AdvanceOneFrame();
+    }
+    REQUIRE(counter.GetNumAllocations() == 0);
+  }
+
+  SECTION("Fixed step frames that sort the particles every few frames") {
+    container.SetReorderInterval(5);
+    WarmUp(&container);
+
+    idealgas::AllocationCounter counter;
+    for (size_t frame = 0; frame < kCountedFrames; ++frame) {
+      container.AdvanceOneFrame();
+    }
+    REQUIRE(counter.GetNumAllocations() == 0);
+  }
+
+  SECTION("Event-driven frames") {
+    container.SetSteppingMode(idealgas::SteppingMode::kEventDriven);
+    WarmUp(&container);
+
+    idealgas::AllocationCounter counter;
+    for (size_t frame = 0; frame < kCountedFrames; ++frame) {
+      container.AdvanceOneFrame();
+    }
+    REQUIRE(counter.GetNumAllocations() == 0);
+  }
+
+  SECTION("Publishing, binning and profiling each frame on the UI side") {
+    idealgas::ParticleStore snapshot;
+    idealgas::SpeciesSpeedBins species_bins;
+    species_bins.Register(ci::Color("white"), 1);
+    idealgas::FrameProfiler profiler;
+    idealgas::CommandQueue commands(16);
+    // Leaves the speeds alone, so only the passing of the command is counted
+    idealgas::SimulationCommand command =
+        idealgas::SimulationCommand::ModifySpeed(glm::vec2(0, 0), true);
+
+    // Same order of work as the simulation thread and the app's update
+    auto run_frame = [&]() {
+      commands.TryPush(command);
+      commands.DrainInto(&container);
+      container.AdvanceOneFrame();
+      snapshot = container.GetParticleStore();
+      profiler.BeginFrame();
+      profiler.AddFrame(container.GetProfiler().GetLastFrame());
+      species_bins.Update(snapshot);
+      profiler.EndFrame();
+    };
+    for (size_t frame = 0; frame < kWarmUpFrames; ++frame) {
+      run_frame();
+    }
+
+    idealgas::AllocationCounter counter;
+    for (size_t frame = 0; frame < kCountedFrames; ++frame) {
+      run_frame();
+    }
+    REQUIRE(counter.GetNumAllocations() == 0);
+  }
+}
+
+TEST_CASE("A warmed up frame spread over several threads makes no heap "
+          "allocations") {
+  // Enough particles that the grid and the wall checks are split into parts
+  // as well as the collision resolver
+  std::vector<idealgas::Particle*> particles;
+  idealgas::GasContainer container(particles, 8192, glm::vec2(0, 0),
+                                   glm::vec2(1000, 1000), 2, 1,
+                                   ci::Color("white"));
+  container.SetNumThreads(4);
+
+  SECTION("Fixed step frames") {
+    WarmUp(&container);
+
+    idealgas::AllocationCounter counter;
+    for (size_t frame = 0; frame < kCountedFrames; ++frame) {
+      container.AdvanceOneFrame();
+    }
+    REQUIRE(counter.GetNumAllocations() == 0);
+  }
+
+  SECTION("Fixed step frames that sort the particles every few frames") {
+    container.SetReorderInterval(5);
+    WarmUp(&container);
+
+    idealgas::AllocationCounter counter;
+    for (size_t frame = 0; frame < kCountedFrames; ++frame) {
+      container.AdvanceOneFrame();
+    }
+    REQUIRE(counter.GetNumAllocations() == 0);
+  }
+}